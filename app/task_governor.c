@@ -0,0 +1,143 @@
+#include <limits.h>
+
+#include "task_governor.h"
+#include "clocks.h"
+#include "initcalls.h"
+#include "scheduler.h"
+#include "fmt.h"
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// Entry of the decision log
+typedef struct {
+    uint32_t time_ms;        // Uptime of the decision
+    uint32_t from_khz;       // Frequency before the decision
+    uint32_t to_khz;         // Frequency after the decision
+    int utilization;         // Utilization of the window (permille)
+    int64_t min_slack;       // Minimum deadline slack of the window (us)
+} governor_decision_t;
+
+// Supported system clock frequencies, lowest first
+static const uint32_t frequency_table[] = { 48000, 64000, 96000, 125000 };
+#define FREQUENCY_COUNT ((int)(sizeof(frequency_table) / sizeof(frequency_table[0])))
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static bool auto_mode = true;                      // Governor enabled, otherwise fixed frequency
+static int level = FREQUENCY_COUNT - 1;             // Index of the current frequency
+static int64_t residency[FREQUENCY_COUNT];          // Time spent at each frequency (us)
+static absolute_time_t last_run;                    // Start of the current window
+static int64_t last_busy_time = 0;                  // Busy time at the start of the window
+static int last_utilization = 0;                    // Utilization of the last window (permille)
+static int64_t last_min_slack = INT64_MAX;          // Minimum slack of the last window
+static governor_decision_t decision_log[GOVERNOR_LOG_SIZE]; // Ring buffer of decisions
+static int decision_count = 0;                      // Total number of decisions
+
+// Changes frequency level and logs the decision
+static void change_level(int new_level, absolute_time_t now) {
+    uint32_t from_khz = frequency_table[level];
+    if (!clocks_set_sys_khz(frequency_table[new_level])) {
+        return; // Not achievable, keep the current level
+    }
+
+    governor_decision_t *d = &decision_log[decision_count % GOVERNOR_LOG_SIZE];
+    d->time_ms = (uint32_t)(to_us_since_boot(now) / 1000);
+    d->from_khz = from_khz;
+    d->to_khz = frequency_table[new_level];
+    d->utilization = last_utilization;
+    d->min_slack = last_min_slack;
+    decision_count++;
+
+    level = new_level;
+}
+
+// Task function: evaluates the load of the last window and steps the clock
+// Steps up on high utilization, low slack or deadline misses. Steps down only when
+// the utilization predicted at the lower frequency stays well below the up threshold,
+// which avoids oscillating between two levels.
+void task_governor(void) {
+    absolute_time_t now = get_absolute_time();
+    int64_t window = absolute_time_diff_us(last_run, now);
+    if (window <= 0) return;
+
+    int64_t busy_time = scheduler_get_busy_time();
+    last_utilization = (int)(((busy_time - last_busy_time) * 1000) / window);
+    last_min_slack = scheduler_take_min_slack();
+    residency[level] += window;
+    last_busy_time = busy_time;
+    last_run = now;
+
+    if (!auto_mode) return;
+
+    if ((last_utilization > GOVERNOR_UP_PERMILLE || last_min_slack < GOVERNOR_SLACK_GUARD_US) && level < FREQUENCY_COUNT - 1) {
+        change_level(level + 1, now);
+    } else if (last_utilization < GOVERNOR_DOWN_PERMILLE && last_min_slack > 4 * GOVERNOR_SLACK_GUARD_US && level > 0) {
+        int predicted = (int)((int64_t)last_utilization * frequency_table[level] / frequency_table[level - 1]);
+        if (predicted < (GOVERNOR_UP_PERMILLE * 8) / 10) {
+            change_level(level - 1, now);
+        }
+    }
+}
+
+// Lets the governor choose the frequency
+void governor_set_auto(void) {
+    auto_mode = true;
+}
+
+// Fixes the system clock to a frequency of the table
+bool governor_set_fixed(uint32_t khz) {
+    for (int i = 0; i < FREQUENCY_COUNT; i++) {
+        if (frequency_table[i] == khz) {
+            auto_mode = false;
+            change_level(i, get_absolute_time());
+            return level == i;
+        }
+    }
+    return false;
+}
+
+// Prints mode, per-frequency residency and the decision log
+void governor_print_report(void) {
+    int64_t total = 0;
+    for (int i = 0; i < FREQUENCY_COUNT; i++) total += residency[i];
+
+    fmt_printf("\n--- Clock Governor ---\n");
+    fmt_printf("Mode: %s, system clock: %lu kHz\n", auto_mode ? "AUTO" : "FIXED", (unsigned long)clocks_get_sys_khz());
+    if (last_min_slack == INT64_MAX) {
+        fmt_printf("Last window: utilization %d permille, min slack n/a\n\n", last_utilization);
+    } else {
+        fmt_printf("Last window: utilization %d permille, min slack %lld us\n\n", last_utilization, (long long)last_min_slack);
+    }
+
+    fmt_printf("%-10s %-14s %-10s\n", "kHz", "Residency(us)", "Share%");
+    for (int i = 0; i < FREQUENCY_COUNT; i++) {
+        fmt_printf("%-10lu %-14lld %-10.2f%s\n", (unsigned long)frequency_table[i], (long long)residency[i],
+                   total > 0 ? ((double)residency[i] / (double)total) * 100.0 : 0.0, i == level ? " *" : "");
+    }
+
+    fmt_printf("\n%-10s %-10s %-10s %-10s %-10s\n", "Time(ms)", "From", "To", "Util", "MinSlack");
+    int first = decision_count > GOVERNOR_LOG_SIZE ? decision_count - GOVERNOR_LOG_SIZE : 0;
+    for (int n = first; n < decision_count; n++) {
+        const governor_decision_t *d = &decision_log[n % GOVERNOR_LOG_SIZE];
+        fmt_printf("%-10lu %-10lu %-10lu %-10d %-10lld\n", (unsigned long)d->time_ms, (unsigned long)d->from_khz,
+                   (unsigned long)d->to_khz, d->utilization, (long long)(d->min_slack == INT64_MAX ? -1 : d->min_slack));
+    }
+    fmt_printf("\n");
+}
+
+// Initializes the governor and registers it with the scheduler
+void task_governor_init(void) {
+    uint32_t khz = clocks_get_sys_khz();
+    for (int i = 0; i < FREQUENCY_COUNT; i++) {
+        if (frequency_table[i] == khz) level = i;
+    }
+    last_run = get_absolute_time();
+
+    if (scheduler_add_task("clkgov", task_governor, 0, GOVERNOR_INTERVAL_US, TASK_RUNNING, 0) != SCHED_ERR_OK) {
+        fmt_printf("[GOVERNOR][ERROR] Failed to add governor task.\n");
+    }
+}
+REGISTER_INITCALL_LEVEL(task_governor_init, INITCALL_APP, clocks_init);
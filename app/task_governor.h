@@ -0,0 +1,32 @@
+#ifndef TASK_GOVERNOR_H
+#define TASK_GOVERNOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define GOVERNOR_INTERVAL_US      100000 // Evaluation window of the governor
+#define GOVERNOR_UP_PERMILLE      600    // Step up above this utilization
+#define GOVERNOR_DOWN_PERMILLE    250    // Step down below this utilization
+#define GOVERNOR_SLACK_GUARD_US   200    // Step up when the minimum slack falls below this value
+#define GOVERNOR_LOG_SIZE         16     // Number of decisions kept in the log
+
+// -----------------------------------------------------------------------------
+// Governor API
+// -----------------------------------------------------------------------------
+
+// Task function: evaluates the load and steps the system clock
+void task_governor(void);
+
+// Lets the governor choose the frequency
+void governor_set_auto(void);
+
+// Fixes the system clock to a frequency of the table. Returns false if not supported.
+bool governor_set_fixed(uint32_t khz);
+
+// Prints mode, per-frequency residency and the decision log
+void governor_print_report(void);
+
+#endif // TASK_GOVERNOR_H
@@ -1,4 +1,3 @@
-#include <stdio.h>
 #include "task_led.h"
 #include "driver_led.h"
 #include "initcalls.h"
@@ -6,6 +5,8 @@
 #include "debug.h"
 
 #include "hardware_cfg.h"
+#include "clocks.h"
+#include "fmt.h"
 
 // Static instances for LED drivers
 static DriverLed leds[2];
@@ -27,15 +28,22 @@ void task_led(void) {
     DEBUG_LOG_TASK(0, "LED task executed.");
 }
 
+// Keeps the LED PWM frequency constant across system clock changes
+static void task_led_clock_changed(uint32_t sys_hz) {
+    leds[0].update_clock(&leds[0], sys_hz);
+    leds[1].update_clock(&leds[1], sys_hz);
+}
+
 // Initializes the LED task and registers it with the scheduler
 void task_led_init(void) {
     // Initialize LED drivers with hardware configurations
     initialize_driver_led(&leds[0], hw_config->led_pin); // Pin 25 for LED 1
     initialize_driver_led(&leds[1], hw_config->extra_gpio1); // Pin 26 for LED 2
+    clocks_register_listener(task_led_clock_changed);
 
     // Add task to scheduler: name, function, priority, interval, state, and memory usage
     if (scheduler_add_task("led01", task_led, 0, (1 * 1000 * 1000), TASK_RUNNING, sizeof(task_led_static_mem_t)) != SCHED_ERR_OK) {
-        printf("[LED TASK][ERROR] Failed to add Blink task.\n");
+        fmt_printf("[LED TASK][ERROR] Failed to add Blink task.\n");
     }
 }
 
@@ -0,0 +1,387 @@
+#include <string.h>
+#include <stddef.h>
+
+#include "hardware/watchdog.h"
+
+#include "task_recorder.h"
+#include "flash.h"
+#include "initcalls.h"
+#include "irq_account.h"
+#include "supervisor.h"
+#include "fmt.h"
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+#define SLOTS_PER_SECTOR (FLASH_SECTOR_SIZE / RECORDER_SLOT_SIZE)
+#define SLOT_COUNT       (FLASH_RECORDER_SECTORS * SLOTS_PER_SECTOR)
+#define PAGES_PER_SLOT   (RECORDER_SLOT_SIZE / FLASH_PAGE_SIZE)
+#define LAP_US           ((int64_t)SLOT_COUNT * RECORDER_SNAPSHOT_US) // Time to fill the whole ring
+
+_Static_assert(sizeof(recorder_snapshot_t) <= RECORDER_SLOT_SIZE, "snapshot larger than a slot");
+_Static_assert(RECORDER_EVENTS >= 8, "too many tasks for a snapshot slot");
+_Static_assert(RECORDER_SLOT_SIZE % FLASH_PAGE_SIZE == 0 && FLASH_SECTOR_SIZE % RECORDER_SLOT_SIZE == 0,
+               "slots must be whole pages and divide a sector");
+
+// Progress of the current snapshot
+typedef enum {
+    RECORDER_IDLE,    // Waiting for the next snapshot, erasing the sector ahead in idle windows
+    RECORDER_ERASE,   // Snapshot captured, no erased slot left: the sector ahead must be erased first
+    RECORDER_PROGRAM  // Programming the slot, one page per run
+} recorder_phase_t;
+
+// Slot content, padded to whole pages
+typedef union {
+    recorder_snapshot_t snapshot;
+    uint8_t bytes[RECORDER_SLOT_SIZE];
+} recorder_slot_t;
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static recorder_slot_t buffer;                 // Snapshot being written
+static recorder_slot_t postmortem;             // Last snapshot of the previous boot
+static bool postmortem_valid = false;
+static recorder_phase_t phase = RECORDER_IDLE;
+static int next_slot = 0;                      // Slot of the next snapshot
+static int latest_slot = -1;                   // Slot of the last complete snapshot
+static int erased_slots = 0;                   // Erased slots from the next one on, ending at a sector boundary
+static int page = 0;                           // Next page of the slot to program
+static uint32_t sequence = 0;                  // Sequence number of the next snapshot
+static uint16_t boot = 0;                      // Number of this boot
+static absolute_time_t last_snapshot;          // Time of the last capture
+static absolute_time_t waiting_since;          // Start of the wait for an idle window
+static bool snapshot_requested = false;
+static uint32_t forced_operations = 0;         // Flash operations done without an idle window
+static bool forced_erase_done = false;
+static absolute_time_t last_forced_erase;      // Erases without an idle window run once per ring lap
+static uint32_t skipped_snapshots = 0;         // Snapshots dropped because no erased slot was left
+static bool skipping = false;                  // Snapshots are being skipped, reported once
+
+// -----------------------------------------------------------------------------
+// Slot Handling
+// -----------------------------------------------------------------------------
+
+// CRC-32 (IEEE 802.3), bitwise: slots are only checked at boot and by POSTMORTEM LIST
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+    }
+    return crc;
+}
+
+static uint32_t slot_offset(int slot) {
+    return FLASH_RECORDER_OFFSET + (uint32_t)slot * RECORDER_SLOT_SIZE;
+}
+
+static uint32_t sector_offset(int sector) {
+    return FLASH_RECORDER_OFFSET + (uint32_t)sector * FLASH_SECTOR_SIZE;
+}
+
+static const recorder_slot_t *slot_map(int slot) {
+    return (const recorder_slot_t *)flash_region_map(slot_offset(slot));
+}
+
+// The crc field is counted as zero
+static uint32_t slot_crc(const recorder_slot_t *slot) {
+    static const uint8_t zero[sizeof(uint32_t)] = {0};
+    size_t crc_at = offsetof(recorder_header_t, crc);
+    size_t after = crc_at + sizeof(uint32_t);
+    uint32_t crc = crc32_update(0xFFFFFFFFu, slot->bytes, crc_at);
+    crc = crc32_update(crc, zero, sizeof(zero));
+    crc = crc32_update(crc, &slot->bytes[after], sizeof(slot->bytes) - after);
+    return ~crc;
+}
+
+static bool slot_is_valid(const recorder_slot_t *slot) {
+    return slot->snapshot.header.magic == RECORDER_MAGIC && slot->snapshot.header.crc == slot_crc(slot);
+}
+
+static bool slot_is_erased(const recorder_slot_t *slot) {
+    for (size_t i = 0; i < sizeof(slot->bytes); i++) {
+        if (slot->bytes[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+static bool sector_is_erased(int sector) {
+    for (int i = 0; i < SLOTS_PER_SECTOR; i++) {
+        if (!slot_is_erased(slot_map(sector * SLOTS_PER_SECTOR + i))) return false;
+    }
+    return true;
+}
+
+// Moves the next slot to the start of the following sector if it cannot be programmed
+static void skip_used_slot(void) {
+    if (!slot_is_erased(slot_map(next_slot))) {
+        next_slot = (next_slot / SLOTS_PER_SECTOR + 1) % FLASH_RECORDER_SECTORS * SLOTS_PER_SECTOR;
+    }
+}
+
+// Counts the erased slots ahead of the write pointer: the rest of its sector, then whole sectors
+// The sector of the next slot is counted once, so the sector ahead never wraps onto it.
+static void count_erased_slots(void) {
+    if (!slot_is_erased(slot_map(next_slot))) {
+        erased_slots = 0; // skip_used_slot() left the next slot at a sector start
+        return;
+    }
+    int sector = next_slot / SLOTS_PER_SECTOR;
+    erased_slots = SLOTS_PER_SECTOR - next_slot % SLOTS_PER_SECTOR;
+    for (int i = 1; i < FLASH_RECORDER_SECTORS && sector_is_erased((sector + i) % FLASH_RECORDER_SECTORS); i++) {
+        erased_slots += SLOTS_PER_SECTOR;
+    }
+}
+
+// Erases the sector the write pointer enters after the erased slots, the oldest of the ring
+static void erase_sector_ahead(void) {
+    flash_region_erase(sector_offset((next_slot + erased_slots) / SLOTS_PER_SECTOR % FLASH_RECORDER_SECTORS),
+                       FLASH_SECTOR_SIZE);
+    erased_slots += SLOTS_PER_SECTOR;
+    skipping = false;
+}
+
+// Fills the buffer with the current statistics and the latest trace events
+static void capture_snapshot(void) {
+    memset(&buffer, 0, sizeof(buffer));
+    recorder_header_t *h = &buffer.snapshot.header;
+    uint64_t uptime = time_us_64();
+
+    h->magic = RECORDER_MAGIC;
+    h->sequence = sequence++;
+    h->boot = boot;
+    h->uptime_ms = (uint32_t)(uptime / 1000);
+    h->time_us = (uint32_t)uptime;
+    h->cpu_permille = uptime ? (uint16_t)((uint64_t)scheduler_get_busy_time() * 1000 / uptime) : 0;
+    h->irq_permille = uptime ? (uint16_t)(irq_account_total_time() * 1000 / uptime) : 0;
+    h->algorithm = (uint8_t)scheduler_get_active_algorithm();
+    h->healthy = supervisor_is_healthy();
+    h->task_count = (uint16_t)scheduler_get_task_count();
+
+    for (int i = 0; i < h->task_count; i++) {
+        const task_t *t = scheduler_get_task(i);
+        recorder_task_t *r = &buffer.snapshot.tasks[i];
+        strncpy(r->name, t->name, RECORDER_NAME_LENGTH);
+        r->exec_count = (uint32_t)t->exec_count;
+        r->avg_exec_us = t->exec_count > 0 ? (uint32_t)(t->total_exec_time / t->exec_count) : 0;
+        r->max_exec_us = (uint32_t)t->max_exec_time;
+        r->max_jitter_us = (uint32_t)t->max_jitter;
+        r->deadline_misses = t->deadline_misses > UINT16_MAX ? UINT16_MAX : (uint16_t)t->deadline_misses;
+        r->state = (uint8_t)t->state;
+    }
+
+    h->event_count = (uint16_t)trace_copy_tail(buffer.snapshot.events, RECORDER_EVENTS);
+    h->crc = slot_crc(&buffer);
+}
+
+// Returns true if a flash operation of the given duration may run now
+// It runs when no task is due before it ends, or when it has waited too long.
+static bool flash_window_open(int64_t duration_us, absolute_time_t now) {
+    if (scheduler_get_idle_window() >= duration_us) return true;
+    if (absolute_time_diff_us(waiting_since, now) < RECORDER_MAX_DEFER_US) return false;
+    forced_operations++;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Recorder Task
+// -----------------------------------------------------------------------------
+
+void task_recorder(void) {
+    absolute_time_t now = get_absolute_time();
+
+    switch (phase) {
+        case RECORDER_IDLE:
+            if (!snapshot_requested && absolute_time_diff_us(last_snapshot, now) < RECORDER_SNAPSHOT_US) {
+                // The last erased sector is in use: erase the next one while no task is due
+                if (erased_slots <= SLOTS_PER_SECTOR && scheduler_get_idle_window() >= RECORDER_ERASE_US) {
+                    erase_sector_ahead();
+                }
+                return;
+            }
+            snapshot_requested = false;
+            last_snapshot = now;
+            if (erased_slots == 0) {
+                // No idle window was long enough: one erase per ring lap may stop the tasks,
+                // the snapshots in between are skipped
+                int64_t since_forced = absolute_time_diff_us(last_forced_erase, now);
+                if (forced_erase_done && since_forced < LAP_US) {
+                    if (!skipping) {
+                        fmt_printf("[RECORDER][ERROR] No idle window to erase a sector, snapshots skipped for %lu s.\n",
+                                   (unsigned long)((LAP_US - since_forced) / 1000000));
+                    }
+                    skipping = true;
+                    skipped_snapshots++;
+                    return;
+                }
+                forced_erase_done = true;
+                last_forced_erase = now;
+            }
+            capture_snapshot();
+            page = 0;
+            waiting_since = now;
+            phase = erased_slots == 0 ? RECORDER_ERASE : RECORDER_PROGRAM;
+            break;
+
+        case RECORDER_ERASE:
+            if (!flash_window_open(RECORDER_ERASE_US, now)) return;
+            erase_sector_ahead();
+            waiting_since = get_absolute_time();
+            phase = RECORDER_PROGRAM;
+            break;
+
+        case RECORDER_PROGRAM:
+            if (!flash_window_open(RECORDER_PROGRAM_US, now)) return;
+            flash_region_program(slot_offset(next_slot) + page * FLASH_PAGE_SIZE,
+                                 &buffer.bytes[page * FLASH_PAGE_SIZE], FLASH_PAGE_SIZE);
+            waiting_since = get_absolute_time();
+            if (++page == PAGES_PER_SLOT) {
+                latest_slot = next_slot;
+                next_slot = (next_slot + 1) % SLOT_COUNT;
+                erased_slots--;
+                phase = RECORDER_IDLE;
+            }
+            break;
+    }
+}
+
+void recorder_request_snapshot(void) {
+    snapshot_requested = true;
+}
+
+void recorder_erase_begin(recorder_erase_t *progress) {
+    progress->sector = 0;
+    progress->erased = 0;
+}
+
+// Erases the next used sector but the one holding the last complete snapshot
+// A snapshot being written is dropped, its sector may be the erased one.
+bool recorder_erase_step(recorder_erase_t *progress) {
+    int keep = latest_slot >= 0 ? latest_slot / SLOTS_PER_SECTOR : -1;
+    while (progress->sector < FLASH_RECORDER_SECTORS) {
+        int sector = progress->sector++;
+        if (sector == keep || sector_is_erased(sector)) continue;
+        flash_region_erase(sector_offset(sector), FLASH_SECTOR_SIZE);
+        progress->erased++;
+        phase = RECORDER_IDLE;
+        skip_used_slot();
+        count_erased_slots();
+        skipping = false;
+        return true;
+    }
+    fmt_printf("[SYSTEM] %d recorder sectors erased.\n", progress->erased);
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+// Reports
+// -----------------------------------------------------------------------------
+
+static void print_snapshot(const recorder_snapshot_t *s) {
+    const recorder_header_t *h = &s->header;
+    fmt_printf("Boot %u, snapshot %lu at uptime %lu ms\n", h->boot, (unsigned long)h->sequence, (unsigned long)h->uptime_ms);
+    fmt_printf("Algorithm: %s, supervisor: %s\n", scheduler_algorithm_to_string((sched_algorithm_t)h->algorithm),
+               h->healthy ? "HEALTHY" : "FAULT");
+    fmt_printf("CPU Usage: %u.%u%%, IRQ Usage: %u.%u%%\n\n", h->cpu_permille / 10, h->cpu_permille % 10,
+               h->irq_permille / 10, h->irq_permille % 10);
+
+    fmt_printf("%-5s %-10s %-10s %-10s %-10s %-10s %-10s %-10s\n",
+               "PID", "Name", "State", "ExecCount", "AvgTime", "MaxTime", "MaxJitter", "Misses");
+    for (int i = 0; i < h->task_count && i < MAX_TASKS; i++) {
+        const recorder_task_t *t = &s->tasks[i];
+        fmt_printf("%-5d %-10.8s %-10s %-10lu %-10lu %-10lu %-10lu %-10u\n", i, t->name,
+                   t->state == TASK_RUNNING ? "RUNNING" : "PAUSED", (unsigned long)t->exec_count,
+                   (unsigned long)t->avg_exec_us, (unsigned long)t->max_exec_us, (unsigned long)t->max_jitter_us,
+                   t->deadline_misses);
+    }
+
+    fmt_printf("\nLast %u events (time relative to the snapshot):\n", h->event_count);
+    for (int i = 0; i < h->event_count && i < (int)RECORDER_EVENTS; i++) {
+        const trace_record_t *r = &s->events[i];
+        fmt_printf("%+10ld us %-10s id %-3u arg %u\n", (long)(int32_t)(r->time - h->time_us),
+                   trace_type_to_string(r->type), r->id, r->arg);
+    }
+}
+
+void recorder_print_postmortem(void) {
+    fmt_printf("\n--- Postmortem ---\n");
+    if (watchdog_caused_reboot()) {
+        const supervisor_record_t *record = supervisor_get_last_reset();
+        if (record->valid) {
+            fmt_printf("Reset: watchdog, task %d %s (measured %lu us, limit %lu us)\n", record->task_index,
+                       supervisor_fault_to_string(record->fault), (unsigned long)record->measured_us,
+                       (unsigned long)record->limit_us);
+        } else {
+            fmt_printf("Reset: watchdog\n");
+        }
+    } else {
+        fmt_printf("Reset: power-on or external\n");
+    }
+
+    if (!postmortem_valid) {
+        fmt_printf("No snapshot of a previous boot.\n\n");
+        return;
+    }
+    print_snapshot(&postmortem.snapshot);
+    fmt_printf("\n");
+}
+
+void recorder_print_list(void) {
+    fmt_printf("\n--- Flight Recorder ---\n");
+    fmt_printf("Boot %u, next slot %d of %d, %d erased ahead, %s, %lu forced flash operations, %lu snapshots skipped\n",
+               boot, next_slot, SLOT_COUNT, erased_slots, phase == RECORDER_IDLE ? "idle" : "writing",
+               (unsigned long)forced_operations, (unsigned long)skipped_snapshots);
+    if (skipping) {
+        fmt_printf("No idle window to erase a sector, snapshots are skipped until the next forced erase.\n");
+    }
+    fmt_printf("%-5s %-10s %-6s %-12s %-8s %-8s\n", "Slot", "Sequence", "Boot", "Uptime(ms)", "CPU%", "IRQ%");
+    for (int i = 0; i < SLOT_COUNT; i++) {
+        const recorder_slot_t *slot = slot_map(i);
+        if (!slot_is_valid(slot)) continue;
+        const recorder_header_t *h = &slot->snapshot.header;
+        fmt_printf("%-5d %-10lu %-6u %-12lu %u.%-6u %u.%u\n", i, (unsigned long)h->sequence, h->boot,
+                   (unsigned long)h->uptime_ms, h->cpu_permille / 10, h->cpu_permille % 10,
+                   h->irq_permille / 10, h->irq_permille % 10);
+    }
+    fmt_printf("\n");
+}
+
+// -----------------------------------------------------------------------------
+// Initialization
+// -----------------------------------------------------------------------------
+
+// Finds the latest snapshot, keeps it for POSTMORTEM and continues the ring after it
+// Reading and checking the whole ring is the slowest step of the boot, so it runs on
+// core1 while core0 goes on with the other initcalls.
+static void recorder_scan(void) {
+    int latest = -1;
+    for (int i = 0; i < SLOT_COUNT; i++) {
+        const recorder_slot_t *slot = slot_map(i);
+        if (!slot_is_valid(slot)) continue;
+        if (latest < 0 || (int32_t)(slot->snapshot.header.sequence - slot_map(latest)->snapshot.header.sequence) > 0) {
+            latest = i;
+        }
+    }
+
+    if (latest >= 0) {
+        latest_slot = latest;
+        postmortem = *slot_map(latest);
+        postmortem_valid = true;
+        sequence = postmortem.snapshot.header.sequence + 1;
+        boot = postmortem.snapshot.header.boot + 1;
+        next_slot = (latest + 1) % SLOT_COUNT;
+    }
+
+    // A slot interrupted by the reset cannot be programmed again: start from the next sector
+    skip_used_slot();
+    count_erased_slots();
+}
+REGISTER_INITCALL_CORE1(recorder_scan, INITCALL_CORE);
+
+void task_recorder_init(void) {
+    last_snapshot = get_absolute_time();
+    if (scheduler_add_task("recorder", task_recorder, 0, RECORDER_STEP_US, TASK_RUNNING, sizeof(buffer) + sizeof(postmortem)) != SCHED_ERR_OK) {
+        fmt_printf("[RECORDER][ERROR] Failed to add recorder task.\n");
+    }
+}
+REGISTER_INITCALL_LEVEL(task_recorder_init, INITCALL_APP, recorder_scan);
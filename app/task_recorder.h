@@ -0,0 +1,97 @@
+#ifndef TASK_RECORDER_H
+#define TASK_RECORDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "scheduler.h"
+#include "trace.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define RECORDER_STEP_US        10000    // Interval of the recorder task, one flash operation per run
+#define RECORDER_SNAPSHOT_US    10000000 // Interval between snapshots
+#define RECORDER_SLOT_SIZE      1024     // Flash bytes per snapshot, multiple of FLASH_PAGE_SIZE
+#define RECORDER_ERASE_US       50000    // Typical sector erase, interrupts and XIP are stopped meanwhile
+#define RECORDER_PROGRAM_US     1000     // Worst-case page program
+#define RECORDER_MAX_DEFER_US   5000000  // A flash operation waits at most this long for an idle window
+#define RECORDER_MAGIC          0x46524543 // "FREC"
+#define RECORDER_NAME_LENGTH    8
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// Snapshot header, the CRC covers the whole slot with this field zeroed
+typedef struct {
+    uint32_t magic;         // RECORDER_MAGIC
+    uint32_t sequence;      // Snapshot number, continues across boots
+    uint32_t crc;           // CRC-32 of the slot
+    uint16_t boot;          // Boot number
+    uint16_t task_count;    // Task records that follow
+    uint32_t uptime_ms;     // Uptime at the snapshot
+    uint32_t time_us;       // Low 32 bits of the timer at the snapshot, reference of the event times
+    uint16_t cpu_permille;  // Time spent in tasks since boot
+    uint16_t irq_permille;  // Time spent in interrupt handlers since boot
+    uint16_t event_count;   // Trace records that follow the tasks
+    uint8_t algorithm;      // Active scheduling algorithm
+    uint8_t healthy;        // Supervisor state
+} recorder_header_t;
+
+// Compact statistics of one task
+typedef struct {
+    char name[RECORDER_NAME_LENGTH];
+    uint32_t exec_count;
+    uint32_t avg_exec_us;
+    uint32_t max_exec_us;
+    uint32_t max_jitter_us;
+    uint16_t deadline_misses; // Saturating
+    uint8_t state;
+    uint8_t reserved;
+} recorder_task_t;
+
+#define RECORDER_EVENTS ((RECORDER_SLOT_SIZE - sizeof(recorder_header_t) - MAX_TASKS * sizeof(recorder_task_t)) / sizeof(trace_record_t))
+
+// One flash slot
+typedef struct {
+    recorder_header_t header;
+    recorder_task_t tasks[MAX_TASKS];
+    trace_record_t events[RECORDER_EVENTS];
+} recorder_snapshot_t;
+
+// Progress of an erase of the ring done in steps
+typedef struct {
+    int sector; // Next sector to check
+    int erased; // Sectors erased so far
+} recorder_erase_t;
+
+// -----------------------------------------------------------------------------
+// Recorder API
+// -----------------------------------------------------------------------------
+// A snapshot is captured in RAM every RECORDER_SNAPSHOT_US, then written to a
+// ring of flash sectors one page per task run, only while the scheduler reports
+// an idle window long enough for the page. While the last erased sector fills,
+// the oldest sector ahead of it is erased in an idle window of RECORDER_ERASE_US.
+// If none comes before the ring catches up, one erase per ring lap runs anyway
+// and the other snapshots of that lap are skipped and reported. Slots are written
+// in sequence through all sectors, so erases are spread evenly.
+
+// Task function: captures snapshots and advances the flash writes
+void task_recorder(void);
+
+// Requests a snapshot on the next run of the recorder
+void recorder_request_snapshot(void);
+
+// Erases the ring but the sector of the last snapshot, one sector per step
+// Each step stops interrupts and XIP for about 50 ms. The last step prints the count.
+void recorder_erase_begin(recorder_erase_t *progress);
+bool recorder_erase_step(recorder_erase_t *progress);
+
+// Prints the last snapshot of the previous boot and the reset cause
+void recorder_print_postmortem(void);
+
+// Prints the snapshots held in flash
+void recorder_print_list(void);
+
+#endif // TASK_RECORDER_H
@@ -1,13 +1,26 @@
 #include <stdio.h>
+#include <string.h>
 
 #include "hardware/uart.h"
-#include "hardware/irq.h"
 #include "hardware/gpio.h"
+#include "pico/stdio.h"
+#include "pico/stdio_uart.h"
+#include "pico/time.h"
 
+#include "task_terminal.h"
 #include "hardware_cfg.h"
+#include "clocks.h"
+#include "uart_rx.h"
+#include "uart_tx.h"
+#include "usb_cdc.h"
 #include "initcalls.h"
+#include "scheduler.h"
 #include "terminal.h"
 #include "terminal/cmd.h"
+#include "terminal/rpc.h"
+#include "terminal/top.h"
+#include "metrics.h"
+#include "fmt.h"
 
 #define DATA_BITS 8
 #define STOP_BITS 1
@@ -15,47 +28,353 @@
 
 #define UART_RX_BUFFER_SIZE 128
 
-static char uart_rx_buffer[UART_RX_BUFFER_SIZE];
-static size_t uart_rx_index = 0;
-static terminal_context_t terminal_context; // Global terminal context
+// Terminal task timing
+#define TERMINAL_IDLE_US    10000 // Interval while all lines are idle
+#define TERMINAL_ACTIVE_US  2000  // Interval while characters arrive
+#define TERMINAL_LINE_IDLE_US 50000 // Time without characters after which a line is idle
+#define TERMINAL_BUDGET_US  200   // Time spent assembling lines per run, commands excluded
 
-// UART interrupt handler: Handles incoming UART data
-void uart_irq_handler() {
-    while (uart_is_readable(uart0)) {
-        char c = uart_getc(uart0);
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+typedef struct {
+    const terminal_link_t *link;
+    terminal_context_t context;       // Login state, history and commands of the session
+    rpc_session_t rpc;                // Binary protocol state
+    char line[UART_RX_BUFFER_SIZE];   // Line being typed
+    size_t line_length;
+    bool binary_mode;                 // Frames of the binary protocol are arriving
+    uint64_t last_rx_us;              // Time of the last received character
+    terminal_report_step_t report;    // Report in progress, NULL if none
+    void *report_state;
+} terminal_session_t;
 
-        // Echo received character for debugging
-        uart_putc(uart0, c);
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static terminal_session_t sessions[TERMINAL_MAX_SESSIONS];
+static int session_count = 0;
+static int next_session = 0;                 // First session served by the next run
+static terminal_session_t *output_session;   // Session whose command is running, receives the output
+static bool line_active = false;             // Task running at TERMINAL_ACTIVE_US
+static int terminal_task = -1;
+static metric_t metric_line_overflows = { .name = "terminal_line_overflows_total", .help = "Lines dropped by a full line buffer", .type = METRIC_COUNTER };
 
-        if (c == '\n' || c == '\r') { // End of command
-            uart_rx_buffer[uart_rx_index] = '\0'; // Null-terminate the string
-            terminal_execute_command(&terminal_context, uart_rx_buffer); // Process the command
-            uart_rx_index = 0; // Reset the buffer index
-        } else if (uart_rx_index < UART_RX_BUFFER_SIZE - 1) {
-            uart_rx_buffer[uart_rx_index++] = c; // Add character to buffer
+// -----------------------------------------------------------------------------
+// Links
+// -----------------------------------------------------------------------------
+
+static int uart0_getc(bool *overrun) {
+    return uart_rx_getc(uart0, overrun);
+}
+
+static void uart0_write(const uint8_t *data, size_t length) {
+    uart_tx_write(uart0, (const char *)data, length);
+}
+
+static size_t uart0_space(void) {
+    return uart_tx_space(uart0);
+}
+
+static int uart1_getc(bool *overrun) {
+    return uart_rx_getc(uart1, overrun);
+}
+
+static void uart1_write(const uint8_t *data, size_t length) {
+    uart_tx_write(uart1, (const char *)data, length);
+}
+
+static size_t uart1_space(void) {
+    return uart_tx_space(uart1);
+}
+
+static int usb_getc(bool *overrun) {
+    return usb_cdc_getc();
+}
+
+static void usb_write(const uint8_t *data, size_t length) {
+    usb_cdc_write((const char *)data, length);
+}
+
+// Without a host the queue never drains: a report runs to its end and its output
+// is dropped like any other
+static size_t usb_space(void) {
+    return usb_cdc_connected() ? usb_cdc_tx_space() : USB_CDC_TX_BUFFER_SIZE;
+}
+
+static const terminal_link_t uart0_link = { "UART0", uart0_getc, uart0_write, uart0_space, NULL };
+static const terminal_link_t uart1_link = { "UART1", uart1_getc, uart1_write, uart1_space, NULL };
+static const terminal_link_t usb_link = { "USB", usb_getc, usb_write, usb_space, usb_cdc_poll };
+
+// printf goes to the session running a command, otherwise to the console
+static void stdio_terminal_out_chars(const char *buf, int length) {
+    terminal_session_t *s = output_session ? output_session : &sessions[0];
+    s->link->write((const uint8_t *)buf, (size_t)length);
+}
+
+#if PICO_STDIO_ENABLE_CRLF_SUPPORT && PICO_STDIO_DEFAULT_CRLF
+#define TERMINAL_CRLF true
+#else
+#define TERMINAL_CRLF false
+#endif
+
+// fmt_printf takes the same route, expanding newlines like the stdio driver
+// Callable from interrupt handlers: the link writes never wait there.
+static void terminal_fmt_output(const char *data, size_t length) {
+    terminal_session_t *s = output_session ? output_session : &sessions[0];
+    const char *end = data + length;
+    while (data < end) {
+        const char *newline = memchr(data, '\n', (size_t)(end - data));
+        if (newline == NULL || !TERMINAL_CRLF) {
+            s->link->write((const uint8_t *)data, (size_t)(end - data));
+            return;
+        }
+        if (newline > data && newline[-1] == '\r') {
+            s->link->write((const uint8_t *)data, (size_t)(newline + 1 - data));
         } else {
-            printf("[SYSTEM][ERROR] UART0 buffer full.\n");
-            uart_rx_index = 0; // Reset the buffer index
+            s->link->write((const uint8_t *)data, (size_t)(newline - data));
+            s->link->write((const uint8_t *)"\r\n", 2);
+        }
+        data = newline + 1;
+    }
+}
+
+static stdio_driver_t stdio_terminal = {
+    .out_chars = stdio_terminal_out_chars,
+#if PICO_STDIO_ENABLE_CRLF_SUPPORT
+    .crlf_enabled = PICO_STDIO_DEFAULT_CRLF,
+#endif
+};
+
+// -----------------------------------------------------------------------------
+// Terminal Task
+// -----------------------------------------------------------------------------
+
+// Adds one character to the line, returns true when a command was executed
+static bool terminal_process_char(terminal_session_t *s, char c) {
+    if (c == '\t') { // Command name completion, the appended characters are echoed
+        size_t added = terminal_complete(&s->context, s->line, s->line_length, UART_RX_BUFFER_SIZE);
+        s->link->write((const uint8_t *)s->line + s->line_length, added);
+        s->line_length += added;
+        return false;
+    }
+
+    // Echo received character for debugging
+    s->link->write((const uint8_t *)&c, 1);
+
+    if (c == '\n' || c == '\r') { // End of command
+        s->line[s->line_length] = '\0'; // Null-terminate the string
+        s->line_length = 0; // Reset the buffer index
+        terminal_run_commands(&s->context, s->line); // Process the command
+        // A report started by the command shows the prompt when it ends
+        if (s->report == NULL && terminal_is_authenticated(&s->context)) terminal_show_prompt(&s->context);
+        return true;
+    } else if (s->line_length < UART_RX_BUFFER_SIZE - 1) {
+        s->line[s->line_length++] = c; // Add character to buffer
+    } else {
+        fmt_printf("[SYSTEM][ERROR] %s buffer full.\n", s->link->name);
+        metric_inc(&metric_line_overflows);
+        s->line_length = 0; // Reset the buffer index
+    }
+    return false;
+}
+
+// Consumes the input of one session until the budget ends or a command ran
+// Returns true when the task should stop for this run.
+static bool terminal_serve(terminal_session_t *s, uint64_t start) {
+    bool stop = false;
+    int c;
+    bool overrun = false;
+
+    output_session = s;
+    while (!stop && (c = s->link->getc(&overrun)) >= 0) {
+        s->last_rx_us = time_us_64();
+        if (overrun) { // The partial line is unreliable
+            s->line_length = 0;
+            overrun = false;
+        }
+
+        // Text never contains the frame delimiter: its arrival switches the link to binary frames
+        if (c == RPC_DELIMITER || s->binary_mode) {
+            s->binary_mode = true;
+            rpc_feed(&s->rpc, (uint8_t)c);
+        } else if (top_is_running_on(&s->context)) { // Any key leaves the live view
+            top_stop();
+            terminal_show_prompt(&s->context);
+            stop = true;
+        } else if (terminal_process_char(s, (char)c)) {
+            stop = true;
+        }
+        if (time_us_64() - start >= TERMINAL_BUDGET_US) stop = true;
+    }
+    output_session = NULL;
+    return stop;
+}
+
+// Runs the steps of a report while the link has room for one, for at least one
+// step and then up to TERMINAL_BUDGET_US
+static void terminal_run_report(terminal_session_t *s) {
+    uint64_t start = time_us_64();
+    output_session = s;
+    while (s->report && s->link->space() >= TERMINAL_REPORT_CHUNK) {
+        if (!s->report(s->report_state)) {
+            s->report = NULL;
+            if (terminal_is_authenticated(&s->context)) terminal_show_prompt(&s->context);
         }
+        if (time_us_64() - start >= TERMINAL_BUDGET_US) break;
     }
+    output_session = NULL;
 }
 
-// Initializes UART and terminal functionalities
+// Terminal task: assembles lines and executes at most one command per run
+// Characters are consumed for at most TERMINAL_BUDGET_US; the rest waits for the next run.
+// Sessions take turns being served first, so a busy link cannot starve the others.
+// The task runs faster while characters arrive or a report runs, and slows down
+// once all lines are idle.
+void task_terminal(void) {
+    uint64_t start = time_us_64();
+
+    for (int i = 0; i < session_count; i++) {
+        terminal_session_t *s = &sessions[(next_session + i) % session_count];
+        if (s->report) continue; // Input waits for the end of the report
+        if (terminal_serve(s, start)) break;
+    }
+    next_session = (next_session + 1) % session_count;
+
+    for (int i = 0; i < session_count; i++) {
+        if (sessions[i].report) terminal_run_report(&sessions[i]);
+    }
+
+    // Idle-line detection on the arrival time, the UART receive timeout never fires with the FIFO drained
+    uint64_t now = time_us_64();
+    bool active = false;
+    for (int i = 0; i < session_count; i++) {
+        terminal_session_t *s = &sessions[i];
+        if (s->link->poll) s->link->poll();
+        if (now - s->last_rx_us < TERMINAL_LINE_IDLE_US || s->report) {
+            active = true;
+        } else if (s->binary_mode) { // An idle line ends binary mode, typed text is accepted again
+            s->binary_mode = false;
+            rpc_session_reset(&s->rpc);
+        }
+    }
+    if (active != line_active) {
+        line_active = active;
+        scheduler_set_task_interval(terminal_task, active ? TERMINAL_ACTIVE_US : TERMINAL_IDLE_US);
+    }
+}
+
+void terminal_print_sessions(void) {
+    uint64_t now = time_us_64();
+    fmt_printf("\n--- Sessions ---\n");
+    fmt_printf("%-4s %-6s %-8s %-7s %-10s\n", "ID", "Link", "Login", "Mode", "Idle(ms)");
+    for (int i = 0; i < session_count; i++) {
+        const terminal_session_t *s = &sessions[i];
+        fmt_printf("%-4d %-6s %-8s %-7s %-10lu%s\n", i, s->link->name, terminal_is_authenticated((terminal_context_t *)&s->context) ? "yes" : "no",
+                   s->binary_mode ? "BINARY" : top_is_running_on(&s->context) ? "TOP" : s->report ? "REPORT" : "TEXT", (unsigned long)((now - s->last_rx_us) / 1000), s == output_session ? " (this)" : "");
+    }
+    fmt_printf("\n");
+}
+
+bool terminal_start_report(terminal_context_t *context, terminal_report_step_t step, void *state) {
+    terminal_session_t *owner = NULL;
+    for (int i = 0; i < session_count; i++) {
+        if (sessions[i].report == step) return false;
+        if (&sessions[i].context == context) owner = &sessions[i];
+    }
+    if (owner == NULL) return false;
+    owner->report = step;
+    owner->report_state = state;
+    return true;
+}
+
+bool terminal_write(const terminal_context_t *context, const char *data, size_t length) {
+    for (int i = 0; i < session_count; i++) {
+        if (&sessions[i].context == context) {
+            sessions[i].link->write((const uint8_t *)data, length);
+            return true;
+        }
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+// Initialization
+// -----------------------------------------------------------------------------
+
+static void session_add(const terminal_link_t *link) {
+    terminal_session_t *s = &sessions[session_count++];
+    s->link = link;
+    terminal_init(&s->context);
+    rpc_session_init(&s->rpc, &s->context, link->write);
+    s->context.link = &s->rpc;
+}
+
+// Reports a UART whose divisors cannot reach the configured baud rate
+// The SDK silently picks the nearest rate; at 48 MHz clk_peri the ceiling is 3 Mbaud.
+static bool terminal_check_baud(const char *name, int baud, uint actual) {
+    uint32_t error = actual > (uint)baud ? actual - (uint)baud : (uint)baud - actual;
+    if ((uint64_t)error * 100 > (uint64_t)baud * TERMINAL_BAUD_TOLERANCE_PCT) {
+        fmt_printf("[TERMINAL][ERROR] %s runs at %u baud instead of %d.\n", name, actual, baud);
+        return false;
+    }
+    return true;
+}
+
+// Configures a UART with DMA reception and buffered transmission
+// A UART whose baud rate is not reachable is disabled, since a host expecting the
+// configured rate would only read garbage. The console stays up at the nearest rate
+// so the error report has a way out.
+static bool terminal_uart_init(uart_inst_t *uart, const char *name, int baud, int tx_pin, int rx_pin, int rts_pin, int cts_pin) {
+    if (!terminal_check_baud(name, baud, uart_init(uart, baud)) && uart != uart0) {
+        uart_deinit(uart);
+        return false;
+    }
+    gpio_set_function(tx_pin, GPIO_FUNC_UART);
+    gpio_set_function(rx_pin, GPIO_FUNC_UART);
+    if (rts_pin >= 0) gpio_set_function(rts_pin, GPIO_FUNC_UART);
+    if (cts_pin >= 0) gpio_set_function(cts_pin, GPIO_FUNC_UART);
+    uart_set_format(uart, DATA_BITS, STOP_BITS, PARITY);
+    uart_set_hw_flow(uart, true, true);
+    uart_tx_init(uart);
+    uart_rx_init(uart);
+    return true;
+}
+
+// Recomputes the UART baud rate divisors after a clock change
+static void terminal_clock_changed(uint32_t sys_hz) {
+    (void)sys_hz; // clk_peri is independent of clk_sys, only its own change matters
+    terminal_check_baud(uart0_link.name, hw_config->uart0_baud, uart_set_baudrate(uart0, hw_config->uart0_baud));
+    if (uart_is_enabled(uart1)) {
+        terminal_check_baud(uart1_link.name, hw_config->uart1_baud, uart_set_baudrate(uart1, hw_config->uart1_baud));
+    }
+}
+
+// Initializes the links and their terminal sessions
 void init_task_terminal() {
-    // Configure UART pins and settings
-    uart_init(uart0, hw_config->uart0_baud);
-    gpio_set_function(hw_config->uart0_tx_pin, GPIO_FUNC_UART);
-    gpio_set_function(hw_config->uart0_rx_pin, GPIO_FUNC_UART);
-    uart_set_format(uart0, DATA_BITS, STOP_BITS, PARITY);
-    uart_set_hw_flow(uart0, true, true);
-
-    // Enable UART interrupts
-    uart_set_irq_enables(uart0, true, false);
-    irq_set_exclusive_handler(UART0_IRQ, uart_irq_handler);
-    irq_set_enabled(UART0_IRQ, true);
-
-    // Initialize terminal context and register commands
-    terminal_init(&terminal_context);
-    init_commands(&terminal_context);
-}
-REGISTER_INITCALL(init_task_terminal);
+    terminal_uart_init(uart0, uart0_link.name, hw_config->uart0_baud, hw_config->uart0_tx_pin, hw_config->uart0_rx_pin,
+                       hw_config->uart0_rts_pin, hw_config->uart0_cts_pin);
+    session_add(&uart0_link); // First session: the console
+
+    if (hw_config->uart1_tx_pin >= 0 && hw_config->uart1_rx_pin >= 0 &&
+        terminal_uart_init(uart1, uart1_link.name, hw_config->uart1_baud, hw_config->uart1_tx_pin, hw_config->uart1_rx_pin,
+                           hw_config->uart1_rts_pin, hw_config->uart1_cts_pin)) {
+        session_add(&uart1_link);
+    }
+
+    usb_cdc_init();
+    session_add(&usb_link);
+    clocks_register_listener(terminal_clock_changed);
+    metrics_register(&metric_line_overflows);
+
+    // printf now queues on the link of the session instead of waiting for the UART0 FIFO
+    stdio_set_driver_enabled(&stdio_uart, false);
+    stdio_set_driver_enabled(&stdio_terminal, true);
+    fmt_set_output(terminal_fmt_output);
+
+    if (scheduler_add_task("terminal", task_terminal, 2, TERMINAL_IDLE_US, TASK_RUNNING, sizeof(sessions)) != SCHED_ERR_OK) {
+        fmt_printf("[TERMINAL][ERROR] Failed to add terminal task.\n");
+    }
+    terminal_task = scheduler_find_task("terminal");
+}
+REGISTER_INITCALL_LEVEL(init_task_terminal, INITCALL_DRIVER);
@@ -0,0 +1,61 @@
+#ifndef TASK_TERMINAL_H
+#define TASK_TERMINAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "terminal.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define TERMINAL_MAX_SESSIONS 3 // UART0, UART1, USB CDC
+#define TERMINAL_BAUD_TOLERANCE_PCT 2 // Largest baud rate error a UART link accepts
+#define TERMINAL_REPORT_CHUNK 1024 // Free output buffer a report step needs, larger than any step prints
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// Byte stream a terminal session runs on
+typedef struct {
+    const char *name;
+    int (*getc)(bool *overrun);                       // Next received byte or -1, sets *overrun when input was lost
+    void (*write)(const uint8_t *data, size_t length); // Queues output, waits for the link only under TX BLOCK
+    size_t (*space)(void);                            // Free bytes of the output buffer
+    void (*poll)(void);                               // Called every run, e.g. to move queued output (may be NULL)
+} terminal_link_t;
+
+// Prints the next piece of a report: a line, a metric or a benchmark case
+// Returns false once the report is complete.
+typedef bool (*terminal_report_step_t)(void *state);
+
+// -----------------------------------------------------------------------------
+// Terminal Task API
+// -----------------------------------------------------------------------------
+// Each link has its own session: login state, history, line buffer, binary
+// protocol state and output. printf output of a command goes to the session
+// that issued it; output outside commands goes to the UART0 console.
+//
+// By default output never waits for a link: what does not fit in its buffer is dropped.
+// Reports larger than the buffer (TRACE DUMP, PROF DUMP, METRICS, BENCH) run
+// as steps instead, as many per terminal run as the link has room for
+// (TERMINAL_REPORT_CHUNK each), so they arrive whole without stalling the
+// other tasks. The session's input waits until its report is complete.
+
+// Task function: serves the input of all sessions
+void task_terminal(void);
+
+// Prints the sessions and their state
+void terminal_print_sessions(void);
+
+// Starts a report on the session owning a context, the prompt follows its end
+// Returns false when no session owns the context or the step already runs on a session.
+bool terminal_start_report(terminal_context_t *context, terminal_report_step_t step, void *state);
+
+// Queues output on the link of the session owning a terminal context, outside its commands
+// Returns false when no session owns the context.
+bool terminal_write(const terminal_context_t *context, const char *data, size_t length);
+
+#endif // TASK_TERMINAL_H
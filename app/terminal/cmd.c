@@ -1,34 +1,66 @@
-#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include "hardware/watchdog.h"
 #include "terminal/cmd.h"
 
 #include "scheduler.h"
+#include "scheduler_auto.h"
 #include "debug.h"
 #include "config.h"
 #include "flash.h"
+#include "supervisor.h"
+#include "task_governor.h"
+#include "task_recorder.h"
+#include "clocks.h"
+#include "bench.h"
+#include "trace.h"
+#include "profiler.h"
+#include "gpio_trace.h"
+#include "metrics.h"
+#include "xip_cache.h"
+#include "uart_tx.h"
+#include "task_terminal.h"
+#include "terminal/stream.h"
+#include "terminal/top.h"
+#include "initcalls.h"
+#include "hardware_cfg.h"
+#include "fmt.h"
+
+// Words shared by several commands
+static const char *const on_off[] = { "EN", "DI", NULL };
+
+static const terminal_form_t help_forms[] = {
+    FORM(ARG_STRING_OPTIONAL("command")),
+};
+
+// Lists all available commands, or the usage of one (HELP [command])
+void cmd_help(terminal_context_t *context, const terminal_args_t *args) {
+    if (args->values[0].s) {
+        const terminal_command_t *c = terminal_find_command(args->values[0].s);
+        if (c) {
+            terminal_print_usage(c);
+        } else {
+            terminal_print_message("[SYSTEM][ERROR] Unknown command.\n", COLOR_RED, context);
+        }
+        return;
+    }
 
-// Define password for login
-#define PWD "1234"
-
-// Lists all available commands
-void cmd_help(terminal_context_t *context, size_t argc, char **argv) {
     terminal_print_message("[SYSTEM] Available commands:\n", COLOR_BLUE, context);
-    for (size_t i = 0; i < context->command_count; i++) {
+    for (size_t i = 0; i < terminal_get_command_count(); i++) {
+        const terminal_command_t *c = terminal_get_command(i);
         char help_message[CMD_BUFFER_SIZE];
-        snprintf(help_message, CMD_BUFFER_SIZE, " - %s: %s\n", context->command_table[i].command, context->command_table[i].description);
+        fmt_snprintf(help_message, CMD_BUFFER_SIZE, " - %s: %s\n", c->command, c->description);
         terminal_print_message(help_message, COLOR_BLUE, context);
     }
 }
 
+static const terminal_form_t login_forms[] = {
+    FORM(ARG_STRING("password")),
+};
+
 // Authenticates user if the correct password is provided
-void cmd_login(terminal_context_t *context, size_t argc, char **argv) {
-    if (argc < 2) {
-        terminal_print_message("[SYSTEM] Please provide a password.\n", COLOR_RED, context);
-        return;
-    }
-    if (strcmp(argv[1], PWD) == 0) {
+void cmd_login(terminal_context_t *context, const terminal_args_t *args) {
+    if (strcmp(args->values[0].s, PWD) == 0) {
         terminal_set_authenticated(context, 1);
     } else {
         terminal_print_message("[SYSTEM][ERROR] Incorrect password.\n", COLOR_RED, context);
@@ -36,188 +68,562 @@ void cmd_login(terminal_context_t *context, size_t argc, char **argv) {
 }
 
 // Logs out the current user
-void cmd_logout(terminal_context_t *context, size_t argc, char **argv) {
+void cmd_logout(terminal_context_t *context, const terminal_args_t *args) {
     terminal_set_authenticated(context, 0);
 }
 
 // Displays command history
-void cmd_history(terminal_context_t *context, size_t argc, char **argv) {
+void cmd_history(terminal_context_t *context, const terminal_args_t *args) {
     terminal_show_history(context);
 }
 
 // Initiates a system reboot
-void cmd_reboot(terminal_context_t *context, size_t argc, char **argv) {
+void cmd_reboot(terminal_context_t *context, const terminal_args_t *args) {
     terminal_print_message("[SYSTEM] Rebooting...\n", COLOR_GREEN, context);
+    uart_tx_flush(100000);
+    supervisor_clear(); // The terminal task is marked as dispatched, not a fault
     watchdog_reboot(0, 0, 0);
 }
 
-// Manages tasks: list, update priority, pause, or resume
-void cmd_tasks(terminal_context_t *context, size_t argc, char **argv) {
-    if (argc < 2) {
-        terminal_print_message("[SYSTEM][ERROR] Specify subcommand (PRIO, HOLD, RUN).\n", COLOR_RED, context);
-        return;
-    }
-
-    if (strcmp(argv[1], "PS") == 0) {
-        scheduler_print_task_list();
-    } else if (strcmp(argv[1], "PRIO") == 0) {
-        if (argc < 4) {
-            terminal_print_message("[SYSTEM][ERROR] Specify task ID and new priority.\n", COLOR_RED, context);
-            return;
-        }
-        int task_id = atoi(argv[2]);
-        int priority = atoi(argv[3]);
-        if (scheduler_set_task_priority(task_id, priority) == SCHED_ERR_OK) {
+enum { TASK_PS, TASK_PRIO, TASK_HOLD, TASK_RUN, TASK_WDT };
+static const terminal_form_t task_forms[] = {
+    [TASK_PS] = FORM(ARG_KEYWORD("PS")),
+    [TASK_PRIO] = FORM(ARG_KEYWORD("PRIO"), ARG_TASK("task"), ARG_INT("priority", 0, INT32_MAX)),
+    [TASK_HOLD] = FORM(ARG_KEYWORD("HOLD"), ARG_TASK("task")),
+    [TASK_RUN] = FORM(ARG_KEYWORD("RUN"), ARG_TASK("task")),
+    [TASK_WDT] = FORM(ARG_KEYWORD("WDT"), ARG_TASK("task"), ARG_INT("max_exec_us", 0, INT32_MAX), ARG_INT("max_gap_us", 0, INT32_MAX)),
+};
+
+// Manages tasks: list, update priority, pause, resume or supervise
+void cmd_tasks(terminal_context_t *context, const terminal_args_t *args) {
+    int task_id = args->values[1].i;
+
+    switch (args->form) {
+        case TASK_PS:
+            scheduler_print_task_list();
+            break;
+        case TASK_PRIO:
+            scheduler_set_task_priority(task_id, args->values[2].i);
             terminal_print_message("[SYSTEM] Priority updated.\n", COLOR_GREEN, context);
-        } else {
-            terminal_print_message("[SYSTEM][ERROR] Invalid task ID.\n", COLOR_RED, context);
-        }
-    } else if (strcmp(argv[1], "HOLD") == 0) {
-        if (argc < 3) {
-            terminal_print_message("[SYSTEM][ERROR] Specify task ID.\n", COLOR_RED, context);
-            return;
-        }
-        int task_id = atoi(argv[2]);
-        if (scheduler_pause_task(task_id) == SCHED_ERR_OK) {
+            break;
+        case TASK_HOLD:
+            scheduler_pause_task(task_id);
             terminal_print_message("[SYSTEM] Task paused.\n", COLOR_GREEN, context);
-        } else {
-            terminal_print_message("[SYSTEM][ERROR] Invalid task ID.\n", COLOR_RED, context);
+            break;
+        case TASK_RUN:
+            scheduler_resume_task(task_id);
+            terminal_print_message("[SYSTEM] Task resumed.\n", COLOR_GREEN, context);
+            break;
+        case TASK_WDT:
+            if (scheduler_set_task_supervision(task_id, args->values[2].i, args->values[3].i) == SCHED_ERR_OK) {
+                terminal_print_message("[SYSTEM] Supervision updated.\n", COLOR_GREEN, context);
+            } else {
+                terminal_print_message("[SYSTEM][ERROR] Invalid limits.\n", COLOR_RED, context);
+            }
+            break;
+    }
+}
+
+// Shows the supervision limits and the fault that caused the last reset
+void cmd_watchdog(terminal_context_t *context, const terminal_args_t *args) {
+    char buffer[CMD_BUFFER_SIZE];
+    const supervisor_record_t *record = supervisor_get_last_reset();
+
+    if (record->valid) {
+        const task_t *task = scheduler_get_task(record->task_index);
+        fmt_snprintf(buffer, sizeof(buffer), "[SUPERVISOR] Last reset: task %d (%s) %s, measured %lu us, limit %lu us\n",
+                     record->task_index, task ? task->name : "?", supervisor_fault_to_string(record->fault),
+                     (unsigned long)record->measured_us, (unsigned long)record->limit_us);
+        terminal_print_message(buffer, COLOR_RED, context);
+    } else {
+        terminal_print_message("[SUPERVISOR] Last reset was not caused by the supervisor.\n", COLOR_GREEN, context);
+    }
+
+    fmt_snprintf(buffer, sizeof(buffer), "[SUPERVISOR] State: %s, timeout %d ms\n",
+                 supervisor_is_healthy() ? "HEALTHY" : "FAULT, waiting for reset", SUPERVISOR_WATCHDOG_TIMEOUT_MS);
+    terminal_print_message(buffer, supervisor_is_healthy() ? COLOR_GREEN : COLOR_RED, context);
+
+    for (int i = 0; i < scheduler_get_task_count(); i++) {
+        const task_t *task = scheduler_get_task(i);
+        if (task->max_exec_budget == 0 && task->max_release_gap == 0) continue;
+        fmt_snprintf(buffer, sizeof(buffer), " %d: %-10s max exec %lld us, max gap %lld us\n",
+                     i, task->name, (long long)task->max_exec_budget, (long long)task->max_release_gap);
+        terminal_print_message(buffer, COLOR_BLUE, context);
+    }
+}
+
+enum { CLK_REPORT, CLK_AUTO, CLK_FIX };
+static const terminal_form_t clock_forms[] = {
+    [CLK_REPORT] = FORM_NONE,
+    [CLK_AUTO] = FORM(ARG_KEYWORD("AUTO")),
+    [CLK_FIX] = FORM(ARG_KEYWORD("FIX"), ARG_INT("kHz", 1, INT32_MAX)),
+};
+
+// Shows the clock governor report or changes its mode (CLK AUTO, CLK FIX <kHz>)
+void cmd_clock(terminal_context_t *context, const terminal_args_t *args) {
+    if (args->form == CLK_REPORT) {
+        governor_print_report();
+    } else if (args->form == CLK_AUTO) {
+        governor_set_auto();
+        terminal_print_message("[SYSTEM] Clock governor enabled.\n", COLOR_GREEN, context);
+    } else if (governor_set_fixed((uint32_t)args->values[1].i)) {
+        terminal_print_message("[SYSTEM] System clock fixed.\n", COLOR_GREEN, context);
+    } else {
+        terminal_print_message("[SYSTEM][ERROR] Unsupported frequency (48000, 64000, 96000, 125000 kHz).\n", COLOR_RED, context);
+    }
+}
+
+// Long outputs run as terminal reports, a line, metric, benchmark case or sector erase per step
+// Each kind has one state, so it runs on one session at a time.
+static bench_run_t bench_report;
+static trace_dump_t trace_report;
+static profiler_dump_t profiler_report;
+static metrics_export_t metrics_report;
+static recorder_erase_t erase_report;
+
+static bool bench_report_step(void *state) {
+    return bench_run_step(state);
+}
+
+static bool trace_report_step(void *state) {
+    return trace_dump_step(state);
+}
+
+static bool profiler_report_step(void *state) {
+    return profiler_dump_step(state);
+}
+
+static bool metrics_report_step(void *state) {
+    return metrics_export_step(state);
+}
+
+static bool erase_report_step(void *state) {
+    return recorder_erase_step(state);
+}
+
+static bool start_report(terminal_context_t *context, terminal_report_step_t step, void *state) {
+    if (terminal_start_report(context, step, state)) return true;
+    terminal_print_message("[SYSTEM][ERROR] This report is already running on a session.\n", COLOR_RED, context);
+    return false;
+}
+
+static const char *const bench_groups[] = { "SCHED", "TERM", "CONFIG", "FMT", NULL };
+static const terminal_form_t bench_forms[] = {
+    FORM(ARG_ENUM_OPTIONAL("group", bench_groups, -1)),
+};
+
+// Runs the microbenchmarks and prints CSV rows (BENCH [SCHED|TERM|CONFIG|FMT])
+// One case per terminal run: the terminal task is busy for about 40 ms at a time.
+void cmd_bench(terminal_context_t *context, const terminal_args_t *args) {
+    static const unsigned groups[] = { BENCH_GROUP_SCHED, BENCH_GROUP_TERMINAL, BENCH_GROUP_CONFIG, BENCH_GROUP_FORMAT };
+    if (!start_report(context, bench_report_step, &bench_report)) return;
+    bench_set_cpu_hz(clocks_get_sys_khz() * 1000u);
+    bench_run_begin(&bench_report, args->values[0].i < 0 ? BENCH_GROUP_ALL : groups[args->values[0].i]);
+}
+
+enum { TRACE_STATUS, TRACE_START, TRACE_STOP, TRACE_DUMP, TRACE_MARK };
+static const terminal_form_t trace_forms[] = {
+    [TRACE_STATUS] = FORM_NONE,
+    [TRACE_START] = FORM(ARG_KEYWORD("START")),
+    [TRACE_STOP] = FORM(ARG_KEYWORD("STOP")),
+    [TRACE_DUMP] = FORM(ARG_KEYWORD("DUMP")),
+    [TRACE_MARK] = FORM(ARG_KEYWORD("MARK"), ARG_INT("id", 0, UINT8_MAX), ARG_INT_OPTIONAL("arg", 0, UINT16_MAX, 0)),
+};
+
+// Controls the event trace (TRACE, TRACE START, TRACE STOP, TRACE DUMP, TRACE MARK <id> [arg])
+void cmd_trace(terminal_context_t *context, const terminal_args_t *args) {
+    switch (args->form) {
+        case TRACE_STATUS:
+            fmt_printf("[SYSTEM] Trace %s, %lu of %d records\n", trace_running ? "running" : "stopped",
+                       (unsigned long)trace_get_count(), TRACE_BUFFER_SIZE);
+            break;
+        case TRACE_START:
+            trace_start();
+            terminal_print_message("[SYSTEM] Trace started.\n", COLOR_GREEN, context);
+            break;
+        case TRACE_STOP:
+            trace_stop();
+            terminal_print_message("[SYSTEM] Trace stopped.\n", COLOR_BLUE, context);
+            break;
+        case TRACE_DUMP:
+            if (start_report(context, trace_report_step, &trace_report)) trace_dump_begin(&trace_report);
+            break;
+        case TRACE_MARK:
+            trace_marker((uint8_t)args->values[1].i, (uint16_t)args->values[2].i);
+            break;
+    }
+}
+
+enum { PROF_SUMMARY, PROF_START, PROF_STOP, PROF_DUMP };
+static const terminal_form_t profiler_forms[] = {
+    [PROF_SUMMARY] = FORM_NONE,
+    [PROF_START] = FORM(ARG_KEYWORD("START"), ARG_INT_OPTIONAL("hz", 1, PROFILER_MAX_HZ, PROFILER_DEFAULT_HZ)),
+    [PROF_STOP] = FORM(ARG_KEYWORD("STOP")),
+    [PROF_DUMP] = FORM(ARG_KEYWORD("DUMP")),
+};
+
+// Controls the sampling profiler (PROF, PROF START [hz], PROF STOP, PROF DUMP)
+void cmd_profiler(terminal_context_t *context, const terminal_args_t *args) {
+    switch (args->form) {
+        case PROF_SUMMARY:
+            profiler_print_summary();
+            break;
+        case PROF_START:
+            if (profiler_start((uint32_t)args->values[1].i)) {
+                terminal_print_message("[SYSTEM] Profiler started.\n", COLOR_GREEN, context);
+            } else {
+                terminal_print_message("[SYSTEM][ERROR] No free hardware alarm.\n", COLOR_RED, context);
+            }
+            break;
+        case PROF_STOP:
+            profiler_stop();
+            terminal_print_message("[SYSTEM] Profiler stopped.\n", COLOR_BLUE, context);
+            break;
+        case PROF_DUMP:
+            if (start_report(context, profiler_report_step, &profiler_report)) profiler_dump_begin(&profiler_report);
+            break;
+    }
+}
+
+static const char *const pin_modes[] = { "PULSE", "ID", NULL };
+enum { PIN_STATUS, PIN_MODE, PIN_BASE, PIN_TASK };
+static const terminal_form_t pin_forms[] = {
+    [PIN_STATUS] = FORM_NONE,
+    [PIN_MODE] = FORM(ARG_KEYWORD("MODE"), ARG_ENUM("mode", pin_modes)),
+    [PIN_BASE] = FORM(ARG_KEYWORD("BASE"), ARG_INT("gpio", 0, GPIO_TRACE_NUM_GPIOS - 1), ARG_INT_OPTIONAL("count", 1, GPIO_TRACE_MAX_PINS, 1)),
+    [PIN_TASK] = FORM(ARG_TASK_OR_ALL("task"), ARG_ENUM("state", on_off)),
+};
+
+// Drives task timing onto GPIOs for a logic analyzer
+// (PIN, PIN <id|ALL> EN|DI, PIN MODE PULSE|ID, PIN BASE <gpio> [count])
+void cmd_pin(terminal_context_t *context, const terminal_args_t *args) {
+    if (args->form == PIN_STATUS) {
+        gpio_trace_print_status();
+    } else if (args->form == PIN_MODE) {
+        gpio_trace_set_mode(args->values[1].i == 0 ? GPIO_TRACE_PULSE : GPIO_TRACE_ID);
+    } else if (args->form == PIN_BASE) {
+        int busy = gpio_trace_busy_pin(args->values[1].i, args->values[2].i);
+        if (busy == -2) {
+            char buffer[64];
+            fmt_snprintf(buffer, sizeof(buffer), "[SYSTEM][ERROR] Trace pins must lie within GPIO 0-%d.\n", GPIO_TRACE_NUM_GPIOS - 1);
+            terminal_print_message(buffer, COLOR_RED, context);
+        } else if (busy >= 0) {
+            char buffer[64];
+            fmt_snprintf(buffer, sizeof(buffer), "[SYSTEM][ERROR] GPIO %d is used by another driver.\n", busy);
+            terminal_print_message(buffer, COLOR_RED, context);
+        } else if (!gpio_trace_set_pins(args->values[1].i, args->values[2].i)) {
+            terminal_print_message("[SYSTEM][ERROR] Invalid trace pins.\n", COLOR_RED, context);
         }
-    } else if (strcmp(argv[1], "RUN") == 0) {
-        if (argc < 3) {
-            terminal_print_message("[SYSTEM][ERROR] Specify task ID.\n", COLOR_RED, context);
+    } else {
+        bool enable = args->values[1].i == 0;
+        // The board reserves a free GPIO as the default trace pin
+        if (enable && !gpio_trace_has_pins() && (hw_config->trace_pin < 0 || !gpio_trace_set_pins(hw_config->trace_pin, 1))) {
+            terminal_print_message("[SYSTEM][ERROR] No trace pin, use PIN BASE <gpio> [count].\n", COLOR_RED, context);
             return;
         }
-        int task_id = atoi(argv[2]);
-        if (scheduler_resume_task(task_id) == SCHED_ERR_OK) {
-            terminal_print_message("[SYSTEM] Task resumed.\n", COLOR_GREEN, context);
+        if (args->values[0].i == TERMINAL_ALL_TASKS) {
+            for (int i = 0; i < scheduler_get_task_count(); i++) gpio_trace_enable_task(i, enable);
         } else {
-            terminal_print_message("[SYSTEM][ERROR] Invalid task ID.\n", COLOR_RED, context);
+            gpio_trace_enable_task(args->values[0].i, enable);
         }
+    }
+}
+
+enum { POSTMORTEM_LAST, POSTMORTEM_LIST, POSTMORTEM_SNAP, POSTMORTEM_ERASE };
+static const terminal_form_t postmortem_forms[] = {
+    [POSTMORTEM_LAST] = FORM_NONE,
+    [POSTMORTEM_LIST] = FORM(ARG_KEYWORD("LIST")),
+    [POSTMORTEM_SNAP] = FORM(ARG_KEYWORD("SNAP")),
+    [POSTMORTEM_ERASE] = FORM(ARG_KEYWORD("ERASE")),
+};
+
+// Shows the flight recorder data of the previous boot (POSTMORTEM, POSTMORTEM LIST, POSTMORTEM SNAP, POSTMORTEM ERASE)
+void cmd_postmortem(terminal_context_t *context, const terminal_args_t *args) {
+    if (args->form == POSTMORTEM_LAST) {
+        recorder_print_postmortem();
+    } else if (args->form == POSTMORTEM_LIST) {
+        recorder_print_list();
+    } else if (args->form == POSTMORTEM_SNAP) {
+        recorder_request_snapshot();
+        terminal_print_message("[SYSTEM] Snapshot requested.\n", COLOR_GREEN, context);
     } else {
-        terminal_print_message("[SYSTEM][ERROR] Unknown subcommand.\n", COLOR_RED, context);
+        // Stalls every task for about 50 ms per sector, hence one sector per terminal run
+        if (start_report(context, erase_report_step, &erase_report)) recorder_erase_begin(&erase_report);
     }
 }
 
-// Enables or disables VT100 features
-void cmd_vt100(terminal_context_t *context, size_t argc, char **argv) {
-    if (argc < 2) {
-        terminal_print_message("[SYSTEM][ERROR] Specify state (EN or DI).\n", COLOR_RED, context);
+enum { XIP_REPORT, XIP_RESET, XIP_FLUSH };
+static const terminal_form_t xip_forms[] = {
+    [XIP_REPORT] = FORM_NONE,
+    [XIP_RESET] = FORM(ARG_KEYWORD("RESET")),
+    [XIP_FLUSH] = FORM(ARG_KEYWORD("FLUSH")),
+};
+
+// Shows the XIP cache counters (XIP, XIP RESET, XIP FLUSH)
+void cmd_xip(terminal_context_t *context, const terminal_args_t *args) {
+    if (args->form == XIP_REPORT) {
+        xip_cache_print_report();
+    } else if (args->form == XIP_RESET) {
+        xip_cache_reset_counters();
+        terminal_print_message("[SYSTEM] XIP counters cleared.\n", COLOR_GREEN, context);
+    } else {
+        xip_cache_flush();
+        terminal_print_message("[SYSTEM] XIP cache flushed.\n", COLOR_GREEN, context);
+    }
+}
+
+static const char *const metrics_formats[] = { "JSON", "PROM", NULL };
+static const terminal_form_t metrics_forms[] = {
+    FORM(ARG_ENUM_OPTIONAL("format", metrics_formats, 0)),
+};
+
+// Exports all registered metrics (METRICS [JSON|PROM])
+void cmd_metrics(terminal_context_t *context, const terminal_args_t *args) {
+    if (start_report(context, metrics_report_step, &metrics_report)) {
+        metrics_export_begin(&metrics_report, args->values[0].i == 0 ? METRICS_FORMAT_JSON : METRICS_FORMAT_PROMETHEUS);
+    }
+}
+
+// Lists the terminal sessions
+void cmd_who(terminal_context_t *context, const terminal_args_t *args) {
+    terminal_print_sessions();
+}
+
+enum { TX_STATUS, TX_DROP, TX_BLOCK, TX_OVERWRITE };
+static const terminal_form_t tx_forms[] = {
+    [TX_STATUS] = FORM_NONE,
+    [TX_DROP] = FORM(ARG_KEYWORD("DROP")),
+    [TX_BLOCK] = FORM(ARG_KEYWORD("BLOCK"), ARG_INT_OPTIONAL("us", 1, INT32_MAX, UART_TX_DEFAULT_TIMEOUT_US)),
+    [TX_OVERWRITE] = FORM(ARG_KEYWORD("OVERWRITE")),
+};
+
+// Shows or sets the UART output buffering of all sessions (TX, TX DROP, TX BLOCK [us], TX OVERWRITE)
+void cmd_tx(terminal_context_t *context, const terminal_args_t *args) {
+    switch (args->form) {
+        case TX_STATUS:
+            uart_tx_print_status();
+            return;
+        case TX_DROP:
+            uart_tx_set_policy(UART_TX_DROP, 0);
+            break;
+        case TX_BLOCK:
+            uart_tx_set_policy(UART_TX_BLOCK, (uint32_t)args->values[1].i);
+            break;
+        case TX_OVERWRITE:
+            uart_tx_set_policy(UART_TX_OVERWRITE, 0);
+            break;
+    }
+    terminal_print_message("[SYSTEM] TX policy updated.\n", COLOR_GREEN, context);
+}
+
+enum { STREAM_STATUS, STREAM_STOP, STREAM_START };
+static const terminal_form_t stream_forms[] = {
+    [STREAM_STATUS] = FORM_NONE,
+    [STREAM_STOP] = FORM(ARG_KEYWORD("STOP")),
+    [STREAM_START] = FORM(ARG_INT("hz", 1, STREAM_MAX_HZ), ARG_STRING("ALL|task,task..."), ARG_STRING_OPTIONAL("metric,...")),
+};
+
+// Converts a comma-separated list of task IDs or names to a mask, false on an unknown task
+static bool parse_stream_tasks(const char *list, uint32_t *mask) {
+    static const terminal_arg_t task_arg = ARG_TASK("task");
+    char buffer[CMD_BUFFER_SIZE];
+    char *saveptr;
+    terminal_value_t value;
+
+    *mask = 0;
+    if (strcmp(list, "ALL") == 0) {
+        int count = scheduler_get_task_count() < STREAM_MAX_TASKS ? scheduler_get_task_count() : STREAM_MAX_TASKS;
+        *mask = (1u << count) - 1;
+        return true;
+    }
+    strncpy(buffer, list, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+    for (char *word = strtok_r(buffer, ",", &saveptr); word; word = strtok_r(NULL, ",", &saveptr)) {
+        if (!terminal_convert_arg(&task_arg, word, &value) || value.i >= 32) return false;
+        *mask |= 1u << value.i;
+    }
+    return *mask != 0;
+}
+
+// Streams binary statistics records (STREAM <hz> <ALL|task,task...> [metric,...], STREAM STOP)
+void cmd_stream(terminal_context_t *context, const terminal_args_t *args) {
+    if (args->form == STREAM_STATUS) {
+        stream_print_status();
+        return;
+    }
+    if (args->form == STREAM_STOP) {
+        stream_stop();
+        terminal_print_message("[SYSTEM] Stream stopped.\n", COLOR_GREEN, context);
+        return;
+    }
+    if (!context->link) {
+        terminal_print_message("[SYSTEM][ERROR] This session cannot carry the binary stream.\n", COLOR_RED, context);
         return;
     }
 
-    if (strcmp(argv[1], "EN") == 0) {
+    uint32_t mask;
+    stream_error_t result = STREAM_ERR_TASKS;
+    if (parse_stream_tasks(args->values[1].s, &mask)) {
+        result = stream_start((rpc_session_t *)context->link, (uint32_t)args->values[0].i, mask, args->values[2].s);
+    }
+
+    switch (result) {
+        case STREAM_OK:
+            terminal_print_message("[SYSTEM] Stream started.\n", COLOR_GREEN, context);
+            break;
+        case STREAM_ERR_RATE:
+            terminal_print_message("[SYSTEM][ERROR] Invalid rate.\n", COLOR_RED, context);
+            break;
+        case STREAM_ERR_TASKS:
+            terminal_print_message("[SYSTEM][ERROR] Invalid task list.\n", COLOR_RED, context);
+            break;
+        case STREAM_ERR_METRIC:
+            terminal_print_message("[SYSTEM][ERROR] Unknown metric, or not a plain counter or gauge.\n", COLOR_RED, context);
+            break;
+    }
+}
+
+// Shows the level, core and duration of each initcall of this boot
+void cmd_boot(terminal_context_t *context, const terminal_args_t *args) {
+    initcalls_print_report();
+}
+
+static const terminal_form_t vt100_forms[] = {
+    FORM(ARG_ENUM("state", on_off)),
+};
+
+// Enables or disables VT100 features
+void cmd_vt100(terminal_context_t *context, const terminal_args_t *args) {
+    if (args->values[0].i == 0) {
         context->enable_vt100_features = 1;
         terminal_print_message("[SYSTEM] VT100 enabled.\n", COLOR_GREEN, context);
-    } else if (strcmp(argv[1], "DI") == 0) {
+    } else {
         context->enable_vt100_features = 0;
         terminal_print_message("[SYSTEM] VT100 disabled.\n", COLOR_BLUE, context);
-    } else {
-        terminal_print_message("[SYSTEM][ERROR] Invalid state. Use EN to enable or DI to disable.\n", COLOR_RED, context);
     }
 }
 
-// Lists active tasks
-void cmd_ps(terminal_context_t *context, size_t argc, char **argv) {
-    scheduler_print_task_list();
+enum { PS_LIST, PS_ALG, PS_RESET, PS_CYC };
+static const terminal_form_t ps_forms[] = {
+    [PS_LIST] = FORM_NONE,
+    [PS_ALG] = FORM(ARG_KEYWORD("ALG")),
+    [PS_RESET] = FORM(ARG_KEYWORD("RESET")),
+    [PS_CYC] = FORM(ARG_KEYWORD("CYC"), ARG_ENUM_OPTIONAL("state", on_off, -1)),
+};
+
+// Lists active tasks, compares algorithms (PS ALG), clears statistics (PS RESET)
+// or controls cycle-resolution timing (PS CYC shows histograms, PS CYC EN/DI)
+void cmd_ps(terminal_context_t *context, const terminal_args_t *args) {
+    switch (args->form) {
+        case PS_LIST:
+            scheduler_print_task_list();
+            break;
+        case PS_ALG:
+            scheduler_print_epoch_comparison();
+            break;
+        case PS_RESET:
+            scheduler_reset_statistics();
+            terminal_print_message("[SYSTEM] Statistics cleared.\n", COLOR_GREEN, context);
+            break;
+        case PS_CYC:
+            if (args->values[1].i < 0) {
+                scheduler_print_cycle_histograms();
+            } else if (args->values[1].i == 0) {
+                scheduler_set_cycle_timing(true);
+                terminal_print_message("[SYSTEM] Cycle timing enabled.\n", COLOR_GREEN, context);
+            } else {
+                scheduler_set_cycle_timing(false);
+                terminal_print_message("[SYSTEM] Cycle timing disabled.\n", COLOR_BLUE, context);
+            }
+            break;
+    }
 }
 
-// Sets the scheduler algorithm
-void cmd_set_scheduler(terminal_context_t *context, size_t argc, char **argv) {
-    if (argc < 2) {
-        terminal_print_message("[SYSTEM][ERROR] Specify algorithm: PRIORITY, ROUND_ROBIN, EARLIEST_DEADLINE_FIRST, LEAST_EXECUTED, LONGEST_WAITING.\n", COLOR_RED, context);
+enum { TOP_BY_RATE, TOP_BY_SORT };
+static const char *const top_sorts[] = { "CPU", "JITTER", "MISSES", NULL };
+static const terminal_form_t top_forms[] = {
+    [TOP_BY_RATE] = FORM(ARG_INT("hz", 1, TOP_MAX_HZ), ARG_ENUM_OPTIONAL("sort", top_sorts, TOP_SORT_CPU)),
+    [TOP_BY_SORT] = FORM(ARG_ENUM_OPTIONAL("sort", top_sorts, TOP_SORT_CPU), ARG_INT_OPTIONAL("hz", 1, TOP_MAX_HZ, TOP_DEFAULT_HZ)),
+};
+
+// Live task view redrawn in place until a key is pressed (TOP [hz] [CPU|JITTER|MISSES])
+void cmd_top(terminal_context_t *context, const terminal_args_t *args) {
+    if (!context->enable_vt100_features) {
+        terminal_print_message("[SYSTEM][ERROR] TOP needs a VT100 terminal, enable it with VT100 EN.\n", COLOR_RED, context);
         return;
     }
+    int hz = args->form == TOP_BY_RATE ? args->values[0].i : args->values[1].i;
+    int sort = args->form == TOP_BY_RATE ? args->values[1].i : args->values[0].i;
+    top_start(context, (uint32_t)hz, (top_sort_t)sort);
+}
 
-    sched_algorithm_t algorithm;
-
-    if (strcmp(argv[1], "PRIORITY") == 0) {
-        algorithm = SCHED_ALGO_PRIORITY;
-    } else if (strcmp(argv[1], "ROUND_ROBIN") == 0) {
-        algorithm = SCHED_ALGO_ROUND_ROBIN;
-    } else if (strcmp(argv[1], "EARLIEST_DEADLINE_FIRST") == 0) {
-        algorithm = SCHED_ALGO_EARLIEST_DEADLINE_FIRST;
-    } else if (strcmp(argv[1], "LEAST_EXECUTED") == 0) {
-        algorithm = SCHED_ALGO_LEAST_EXECUTED;
-    } else if (strcmp(argv[1], "LONGEST_WAITING") == 0) {
-        algorithm = SCHED_ALGO_LONGEST_WAITING;
-    } else {
-        terminal_print_message("[SYSTEM][ERROR] Invalid algorithm. Use HELP to see options.\n", COLOR_RED, context);
+// Lists task chains with end-to-end latency statistics
+void cmd_chain(terminal_context_t *context, const terminal_args_t *args) {
+    if (scheduler_get_chain_count() == 0) {
+        terminal_print_message("[SYSTEM] No task chains defined.\n", COLOR_BLUE, context);
         return;
     }
-
-    scheduler_set_algorithm(algorithm);
-    terminal_print_message("[SYSTEM] Scheduler algorithm updated.\n", COLOR_GREEN, context);
+    scheduler_print_chain_list();
 }
 
-// Enables or disables debug for a specific task
-void cmd_debug_task(terminal_context_t *context, size_t argc, char **argv) {
-    if (argc < 3) {
-        terminal_print_message("[SYSTEM][ERROR] Specify task ID and state (EN or DI).\n", COLOR_RED, context);
+// Indexed by sched_algorithm_t
+static const char *const algorithms[] = {
+    "PRIORITY", "ROUND_ROBIN", "EARLIEST_DEADLINE_FIRST", "LEAST_EXECUTED", "LONGEST_WAITING", "AUTO", NULL
+};
+enum { ALG_SET, ALG_LOG };
+static const terminal_form_t scheduler_forms[] = {
+    [ALG_SET] = FORM(ARG_ENUM("algorithm", algorithms)),
+    [ALG_LOG] = FORM(ARG_KEYWORD("LOG")),
+};
+
+// Sets the scheduler algorithm, or shows the AUTO decisions (ALG LOG)
+void cmd_set_scheduler(terminal_context_t *context, const terminal_args_t *args) {
+    if (args->form == ALG_LOG) {
+        scheduler_auto_print_log();
         return;
     }
+    scheduler_set_algorithm((sched_algorithm_t)args->values[0].i);
+    terminal_print_message("[SYSTEM] Scheduler algorithm updated.\n", COLOR_GREEN, context);
+}
 
-    int task_id = atoi(argv[1]);
-    if (strcmp(argv[2], "EN") == 0) {
-        debug_enable_task(task_id);
-    } else if (strcmp(argv[2], "DI") == 0) {
-        debug_disable_task(task_id);
+static const terminal_form_t debug_forms[] = {
+    FORM(ARG_TASK("task"), ARG_ENUM("state", on_off)),
+};
+
+// Enables or disables debug for a specific task
+void cmd_debug_task(terminal_context_t *context, const terminal_args_t *args) {
+    if (args->values[1].i == 0) {
+        debug_enable_task(args->values[0].i);
     } else {
-        terminal_print_message("[SYSTEM][ERROR] Invalid state. Use EN to enable or DI to disable.\n", COLOR_RED, context);
+        debug_disable_task(args->values[0].i);
     }
 }
 
-// Sets parameters (key, type, value)
-void cmd_set(terminal_context_t *context, size_t argc, char **argv) {
-    if (argc < 4) {
-        terminal_print_message("[SYSTEM] SET <key> <type> <value>\n", COLOR_RED, context);
-        return;
-    }
+enum { SET_INT, SET_FLOAT, SET_STRING };
+static const terminal_form_t set_forms[] = {
+    [SET_INT] = FORM(ARG_INT("key", 1, INT32_MAX), ARG_KEYWORD("INT"), ARG_INT("value", INT32_MIN, INT32_MAX)),
+    [SET_FLOAT] = FORM(ARG_INT("key", 1, INT32_MAX), ARG_KEYWORD("FLOAT"), ARG_FLOAT("value")),
+    [SET_STRING] = FORM(ARG_INT("key", 1, INT32_MAX), ARG_KEYWORD("STRING"), ARG_STRING("value")),
+};
 
-    int key = atoi(argv[1]);
-    param_type_t type;
+// Sets parameters (key, type, value); a string with spaces is quoted
+void cmd_set(terminal_context_t *context, const terminal_args_t *args) {
+    int key = args->values[0].i;
     int result;
 
-    if (strcmp(argv[2], "INT") == 0) {
-        type = PARAM_TYPE_INT;
-        char *endptr;
-        int int_value = strtol(argv[3], &endptr, 10);
-        if (*endptr != '\0') {
-            terminal_print_message("[SYSTEM][ERROR] Invalid integer value.\n", COLOR_RED, context);
-            return;
-        }
-        result = set_param(key, type, &int_value);
-    } else if (strcmp(argv[2], "FLOAT") == 0) {
-        type = PARAM_TYPE_FLOAT;
-        char *endptr;
-        float float_value = strtof(argv[3], &endptr);
-        if (*endptr != '\0') {
-            terminal_print_message("[SYSTEM][ERROR] Invalid float value.\n", COLOR_RED, context);
-            return;
-        }
-        result = set_param(key, type, &float_value);
-    } else if (strcmp(argv[2], "STRING") == 0) {
-        type = PARAM_TYPE_STRING;
+    if (args->form == SET_INT) {
+        int int_value = args->values[2].i;
+        result = set_param(key, PARAM_TYPE_INT, &int_value);
+    } else if (args->form == SET_FLOAT) {
+        float float_value = args->values[2].f;
+        result = set_param(key, PARAM_TYPE_FLOAT, &float_value);
+    } else {
         char string_value[64] = {0};
-        size_t len = 0;
-
-        for (int i = 3; i < argc; i++) {
-            if (len + strlen(argv[i]) + 1 >= sizeof(string_value)) {
-                terminal_print_message("[SYSTEM][ERROR] String too long. Truncated.\n", COLOR_YELLOW, context);
-                break;
-            }
-            strncat(string_value, argv[i], sizeof(string_value) - len - 1);
-            len = strlen(string_value);
-            if (i < argc - 1) {
-                strncat(string_value, " ", sizeof(string_value) - len - 1);
-                len = strlen(string_value);
-            }
+        if (strlen(args->values[2].s) >= sizeof(string_value)) {
+            terminal_print_message("[SYSTEM][ERROR] String too long. Truncated.\n", COLOR_YELLOW, context);
         }
-
-        result = set_param(key, type, string_value);
-    } else {
-        terminal_print_message("[SYSTEM][ERROR] Invalid type. Use INT, FLOAT, or STRING.\n", COLOR_RED, context);
-        return;
+        strncpy(string_value, args->values[2].s, sizeof(string_value) - 1);
+        result = set_param(key, PARAM_TYPE_STRING, string_value);
     }
 
     if (result == 0) {
@@ -230,7 +636,7 @@ void cmd_set(terminal_context_t *context, size_t argc, char **argv) {
 }
 
 // Lists initialized parameters with usage statistics
-void cmd_list(terminal_context_t *context, size_t argc, char **argv) {
+void cmd_list(terminal_context_t *context, const terminal_args_t *args) {
     terminal_print_message("[SYSTEM] Listing initialized parameters:\n", COLOR_BLUE, context);
     size_t total_params = 0;
     size_t int_count = 0, float_count = 0, string_count = 0;
@@ -242,15 +648,15 @@ void cmd_list(terminal_context_t *context, size_t argc, char **argv) {
             switch (params[i].type) {
                 case PARAM_TYPE_INT:
                     int_count++;
-                    snprintf(buffer, sizeof(buffer), "Key: %d, Type: INT, Value: %d\n", params[i].key, params[i].value.int_value);
+                    fmt_snprintf(buffer, sizeof(buffer), "Key: %d, Type: INT, Value: %d\n", params[i].key, params[i].value.int_value);
                     break;
                 case PARAM_TYPE_FLOAT:
                     float_count++;
-                    snprintf(buffer, sizeof(buffer), "Key: %d, Type: FLOAT, Value: %.2f\n", params[i].key, params[i].value.float_value);
+                    fmt_snprintf(buffer, sizeof(buffer), "Key: %d, Type: FLOAT, Value: %.2f\n", params[i].key, params[i].value.float_value);
                     break;
                 case PARAM_TYPE_STRING:
                     string_count++;
-                    snprintf(buffer, sizeof(buffer), "Key: %d, Type: STRING, Value: %s\n", params[i].key, params[i].value.string_value);
+                    fmt_snprintf(buffer, sizeof(buffer), "Key: %d, Type: STRING, Value: %s\n", params[i].key, params[i].value.string_value);
                     break;
                 default:
                     continue;
@@ -262,67 +668,79 @@ void cmd_list(terminal_context_t *context, size_t argc, char **argv) {
     size_t used_memory = get_config_params_memory_usage();
     float percentage_sram = ((float)used_memory / (256 * 1024)) * 100.0;
     char mem_usage[128];
-    snprintf(mem_usage, sizeof(mem_usage), "Total SRAM usage: %zu bytes (%.2f%% of available SRAM)\n", used_memory, percentage_sram);
+    fmt_snprintf(mem_usage, sizeof(mem_usage), "Total SRAM usage: %zu bytes (%.2f%% of available SRAM)\n", used_memory, percentage_sram);
     terminal_print_message(mem_usage, COLOR_YELLOW, context);
 
     size_t flash_capacity = FLASH_SECTOR_SIZE;
     size_t flash_used = sizeof(config_param_t) * MAX_PARAMS;
     float percentage_flash = ((float)flash_used / flash_capacity) * 100.0;
     char flash_usage[128];
-    snprintf(flash_usage, sizeof(flash_usage), "Total Flash usage: %zu bytes (%.2f%% of reserved Flash)\n", flash_used, percentage_flash);
+    fmt_snprintf(flash_usage, sizeof(flash_usage), "Total Flash usage: %zu bytes (%.2f%% of reserved Flash)\n", flash_used, percentage_flash);
     terminal_print_message(flash_usage, COLOR_YELLOW, context);
 }
 
-// Retrieves a parameter by its key
-void cmd_get(terminal_context_t *context, size_t argc, char **argv) {
-    if (argc < 2) {
-        terminal_print_message("[SYSTEM] Usage: GET <key>\n", COLOR_RED, context);
-        return;
-    }
+static const terminal_form_t get_forms[] = {
+    FORM(ARG_INT("key", 1, INT32_MAX)),
+};
 
-    int key = atoi(argv[1]);
+// Retrieves a parameter by its key
+void cmd_get(terminal_context_t *context, const terminal_args_t *args) {
+    int key = args->values[0].i;
     config_param_t param;
     if (get_param(key, &param) == 0) {
         char buffer[128];
         switch (param.type) {
             case PARAM_TYPE_INT:
-                snprintf(buffer, sizeof(buffer), "Key: %d, Type: INT, Value: %d\n", param.key, param.value.int_value);
+                fmt_snprintf(buffer, sizeof(buffer), "Key: %d, Type: INT, Value: %d\n", param.key, param.value.int_value);
                 break;
             case PARAM_TYPE_FLOAT:
-                snprintf(buffer, sizeof(buffer), "Key: %d, Type: FLOAT, Value: %.2f\n", param.key, param.value.float_value);
+                fmt_snprintf(buffer, sizeof(buffer), "Key: %d, Type: FLOAT, Value: %.2f\n", param.key, param.value.float_value);
                 break;
             case PARAM_TYPE_STRING:
-                snprintf(buffer, sizeof(buffer), "Key: %d, Type: STRING, Value: %s\n", param.key, param.value.string_value);
+                fmt_snprintf(buffer, sizeof(buffer), "Key: %d, Type: STRING, Value: %s\n", param.key, param.value.string_value);
                 break;
         }
         terminal_print_message(buffer, COLOR_GREEN, context);
     } else {
         char error[64];
-        snprintf(error, sizeof(error), "Parameter with key %d not found.\n", key);
+        fmt_snprintf(error, sizeof(error), "Parameter with key %d not found.\n", key);
         terminal_print_message(error, COLOR_RED, context);
     }
 }
 
 // Resets parameters to their default values
-void cmd_reset(terminal_context_t *context, size_t argc, char **argv) {
+void cmd_reset(terminal_context_t *context, const terminal_args_t *args) {
     reset_params_to_defaults();
     terminal_print_message("[SYSTEM] Parameters reset to defaults.\n", COLOR_GREEN, context);
 }
 
-// Registers all commands to the terminal
-void init_commands(terminal_context_t *context) {
-    terminal_register_command(context, "HELP", "Show the list of commands", cmd_help);
-    terminal_register_command(context, "HISTORY", "Display command history", cmd_history);
-    terminal_register_command(context, "LOGIN", "Authenticate user", cmd_login);
-    terminal_register_command(context, "LOGOUT", "Logout user", cmd_logout);
-    terminal_register_command(context, "TASK", "Manage tasks (PRIO, HOLD, RUN)", cmd_tasks);
-    terminal_register_command(context, "VT100", "Enable/disable VT100 (e.g., VT100 EN or DI)", cmd_vt100);
-    terminal_register_command(context, "PS", "Display active tasks", cmd_ps);
-    terminal_register_command(context, "REBOOT", "Reboot the device", cmd_reboot);
-    terminal_register_command(context, "ALG", "Change scheduler algorithm (e.g., ALG RR)", cmd_set_scheduler);
-    terminal_register_command(context, "DBG", "Enable/disable debug for a task (e.g., DBG <id> EN or DI)", cmd_debug_task);
-    terminal_register_command(context, "SET", "Set a parameter", cmd_set);
-    terminal_register_command(context, "GET", "Retrieve a parameter", cmd_get);
-    terminal_register_command(context, "LIST", "List all parameters", cmd_list);
-    terminal_register_command(context, "RESET", "Reset parameters to defaults", cmd_reset);
-}
+// Commands of the terminal, looked up through the index generated at build time
+REGISTER_COMMAND_ARGS("HELP", "Show the list of commands", cmd_help, help_forms);
+REGISTER_COMMAND("HISTORY", "Display command history", cmd_history);
+REGISTER_COMMAND_ARGS("LOGIN", "Authenticate user", cmd_login, login_forms);
+REGISTER_COMMAND("LOGOUT", "Logout user", cmd_logout);
+REGISTER_COMMAND_ARGS("TASK", "Manage tasks (PRIO, HOLD, RUN, WDT)", cmd_tasks, task_forms);
+REGISTER_COMMAND_ARGS("VT100", "Enable/disable VT100 (e.g., VT100 EN or DI)", cmd_vt100, vt100_forms);
+REGISTER_COMMAND_ARGS("PS", "Display active tasks (PS ALG compares algorithms, PS RESET clears, PS CYC cycle timing)", cmd_ps, ps_forms);
+REGISTER_COMMAND_ARGS("TOP", "Live task view, any key exits (TOP [hz] [CPU|JITTER|MISSES])", cmd_top, top_forms);
+REGISTER_COMMAND("REBOOT", "Reboot the device", cmd_reboot);
+REGISTER_COMMAND_ARGS("ALG", "Change scheduler algorithm (e.g., ALG ROUND_ROBIN, ALG AUTO, ALG LOG)", cmd_set_scheduler, scheduler_forms);
+REGISTER_COMMAND_ARGS("DBG", "Enable/disable debug for a task (e.g., DBG <id> EN or DI)", cmd_debug_task, debug_forms);
+REGISTER_COMMAND_ARGS("SET", "Set a parameter", cmd_set, set_forms);
+REGISTER_COMMAND_ARGS("GET", "Retrieve a parameter", cmd_get, get_forms);
+REGISTER_COMMAND("LIST", "List all parameters", cmd_list);
+REGISTER_COMMAND("RESET", "Reset parameters to defaults", cmd_reset);
+REGISTER_COMMAND("CHAIN", "Display task chains and end-to-end latency", cmd_chain);
+REGISTER_COMMAND_ARGS("CLK", "Clock governor report (CLK AUTO, CLK FIX <kHz>)", cmd_clock, clock_forms);
+REGISTER_COMMAND("WDT", "Show task supervision and last watchdog reset", cmd_watchdog);
+REGISTER_COMMAND_ARGS("TRACE", "Event trace (TRACE START, STOP, DUMP, MARK <id> [arg])", cmd_trace, trace_forms);
+REGISTER_COMMAND_ARGS("PROF", "Sampling profiler (PROF START [hz], STOP, DUMP)", cmd_profiler, profiler_forms);
+REGISTER_COMMAND_ARGS("PIN", "GPIO task tracing (PIN <id|ALL> EN|DI, MODE PULSE|ID, BASE <gpio> [count])", cmd_pin, pin_forms);
+REGISTER_COMMAND_ARGS("POSTMORTEM", "Flight recorder of the previous boot (POSTMORTEM LIST, SNAP, ERASE)", cmd_postmortem, postmortem_forms);
+REGISTER_COMMAND_ARGS("XIP", "XIP cache hit counters (XIP RESET, XIP FLUSH)", cmd_xip, xip_forms);
+REGISTER_COMMAND_ARGS("TX", "UART output buffers (TX DROP, TX BLOCK [us], TX OVERWRITE)", cmd_tx, tx_forms);
+REGISTER_COMMAND("WHO", "Terminal sessions on UART0, UART1 and USB", cmd_who);
+REGISTER_COMMAND_ARGS("STREAM", "Binary statistics stream (STREAM <hz> <ALL|task,task...> [metric,...], STREAM STOP)", cmd_stream, stream_forms);
+REGISTER_COMMAND("BOOT", "Initcall timing of this boot", cmd_boot);
+REGISTER_COMMAND_ARGS("METRICS", "Export metrics (METRICS [JSON|PROM])", cmd_metrics, metrics_forms);
+REGISTER_COMMAND_ARGS("BENCH", "Run microbenchmarks, CSV output (BENCH [SCHED|TERM|CONFIG|FMT])", cmd_bench, bench_forms);
@@ -3,7 +3,7 @@
 
 #include "terminal.h"
 
-// Initializes and registers all terminal commands
-void init_commands(terminal_context_t *context);
+// Define password for login, shared with the binary protocol
+#define PWD "1234"
 
 #endif // CMD_H
@@ -0,0 +1,354 @@
+#include <string.h>
+
+#include "pico/time.h"
+
+#include "rpc.h"
+#include "stream.h"
+#include "cmd.h"
+#include "scheduler.h"
+#include "config.h"
+#include "irq_account.h"
+#include "metrics.h"
+#include "initcalls.h"
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+#define RPC_MAX_PAYLOAD (RPC_MAX_FRAME - RPC_RESPONSE_HEADER - RPC_CRC_SIZE)
+
+// Handles the payload of a request, writes the response payload and its length
+typedef rpc_status_t (*rpc_handler_t)(rpc_session_t *session, const uint8_t *args, size_t length, uint8_t *out, size_t *out_length);
+
+typedef struct {
+    uint8_t op;
+    bool public;           // Allowed before login
+    size_t min_length;     // Shortest valid request payload
+    rpc_handler_t handler;
+} rpc_handler_entry_t;
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static metric_t metric_requests = { .name = "rpc_requests_total", .help = "Binary protocol requests handled", .type = METRIC_COUNTER };
+static metric_t metric_frame_errors = { .name = "rpc_frame_errors_total", .help = "Binary frames dropped by COBS, CRC or length errors", .type = METRIC_COUNTER };
+
+static void rpc_metrics_init(void) {
+    metrics_register(&metric_requests);
+    metrics_register(&metric_frame_errors);
+}
+REGISTER_INITCALL_LEVEL(rpc_metrics_init, INITCALL_CORE);
+
+// -----------------------------------------------------------------------------
+// Encoding
+// -----------------------------------------------------------------------------
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// Statistics are sent as 32-bit values, saturated
+static uint32_t clamp_u32(int64_t v) {
+    return v < 0 ? 0 : v > UINT32_MAX ? UINT32_MAX : (uint32_t)v;
+}
+
+uint16_t rpc_crc16(const uint8_t *data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)(crc << 1) ^ 0x1021 : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t rpc_cobs_encode(const uint8_t *in, size_t length, uint8_t *out) {
+    size_t code_index = 0;
+    size_t written = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < length; i++) {
+        if (in[i] != 0) {
+            out[written++] = in[i];
+            code++;
+        }
+        if (in[i] == 0 || code == 0xFF) {
+            out[code_index] = code;
+            code_index = written++;
+            code = 1;
+        }
+    }
+    out[code_index] = code;
+    return written;
+}
+
+size_t rpc_cobs_decode(const uint8_t *in, size_t length, uint8_t *out) {
+    size_t read = 0;
+    size_t written = 0;
+
+    while (read < length) {
+        uint8_t code = in[read++];
+        if (code == 0 || read + code - 1 > length) return 0;
+        for (uint8_t i = 1; i < code; i++) {
+            out[written++] = in[read++];
+        }
+        if (code != 0xFF && read < length) out[written++] = 0;
+    }
+    return written;
+}
+
+// -----------------------------------------------------------------------------
+// Request Handlers
+// -----------------------------------------------------------------------------
+
+static rpc_status_t rpc_ping(rpc_session_t *session, const uint8_t *args, size_t length, uint8_t *out, size_t *out_length) {
+    if (length > RPC_MAX_PAYLOAD) return RPC_ERR_LENGTH;
+    memcpy(out, args, length);
+    *out_length = length;
+    return RPC_OK;
+}
+
+static rpc_status_t rpc_login(rpc_session_t *session, const uint8_t *args, size_t length, uint8_t *out, size_t *out_length) {
+    if (length != strlen(PWD) || memcmp(args, PWD, length) != 0) return RPC_ERR_AUTH;
+    terminal_set_authenticated(session->terminal, 1);
+    return RPC_OK;
+}
+
+static rpc_status_t rpc_sched_get(rpc_session_t *session, const uint8_t *args, size_t length, uint8_t *out, size_t *out_length) {
+    out[0] = (uint8_t)scheduler_get_algorithm();
+    out[1] = (uint8_t)scheduler_get_active_algorithm();
+    out[2] = (uint8_t)scheduler_get_task_count();
+    *out_length = 3;
+    return RPC_OK;
+}
+
+static rpc_status_t rpc_sched_set_algo(rpc_session_t *session, const uint8_t *args, size_t length, uint8_t *out, size_t *out_length) {
+    return scheduler_set_algorithm((sched_algorithm_t)args[0]) == SCHED_ERR_OK ? RPC_OK : RPC_ERR_INVALID;
+}
+
+static rpc_status_t rpc_task_priority(rpc_session_t *session, const uint8_t *args, size_t length, uint8_t *out, size_t *out_length) {
+    return scheduler_set_task_priority(args[0], (int32_t)get_u32(args + 1)) == SCHED_ERR_OK ? RPC_OK : RPC_ERR_INVALID;
+}
+
+static rpc_status_t rpc_task_interval(rpc_session_t *session, const uint8_t *args, size_t length, uint8_t *out, size_t *out_length) {
+    return scheduler_set_task_interval(args[0], get_u32(args + 1)) == SCHED_ERR_OK ? RPC_OK : RPC_ERR_INVALID;
+}
+
+static rpc_status_t rpc_task_pause(rpc_session_t *session, const uint8_t *args, size_t length, uint8_t *out, size_t *out_length) {
+    return scheduler_pause_task(args[0]) == SCHED_ERR_OK ? RPC_OK : RPC_ERR_INVALID;
+}
+
+static rpc_status_t rpc_task_resume(rpc_session_t *session, const uint8_t *args, size_t length, uint8_t *out, size_t *out_length) {
+    return scheduler_resume_task(args[0]) == SCHED_ERR_OK ? RPC_OK : RPC_ERR_INVALID;
+}
+
+static rpc_status_t rpc_param_get(rpc_session_t *session, const uint8_t *args, size_t length, uint8_t *out, size_t *out_length) {
+    config_param_t param;
+    if (get_param((int32_t)get_u32(args), &param) != 0) return RPC_ERR_INVALID;
+
+    out[0] = (uint8_t)param.type;
+    if (param.type == PARAM_TYPE_STRING) {
+        size_t n = strnlen(param.value.string_value, sizeof(param.value.string_value));
+        memcpy(out + 1, param.value.string_value, n);
+        *out_length = 1 + n;
+    } else {
+        uint32_t raw;
+        memcpy(&raw, &param.value, sizeof(raw)); // int_value or float_value bits
+        put_u32(out + 1, raw);
+        *out_length = 5;
+    }
+    return RPC_OK;
+}
+
+static rpc_status_t rpc_param_set(rpc_session_t *session, const uint8_t *args, size_t length, uint8_t *out, size_t *out_length) {
+    int key = (int32_t)get_u32(args);
+    param_type_t type = (param_type_t)args[4];
+    const uint8_t *value = args + 5;
+    size_t value_length = length - 5;
+    int result;
+
+    if (type == PARAM_TYPE_STRING) {
+        config_param_t param = {0}; // Only its string field holds the NUL-terminated value
+        if (value_length >= sizeof(param.value.string_value)) return RPC_ERR_LENGTH;
+        memcpy(param.value.string_value, value, value_length);
+        result = set_param(key, type, param.value.string_value);
+    } else if (type == PARAM_TYPE_INT || type == PARAM_TYPE_FLOAT) {
+        if (value_length != 4) return RPC_ERR_LENGTH;
+        uint32_t raw = get_u32(value);
+        int int_value;
+        float float_value;
+        memcpy(&int_value, &raw, sizeof(raw));
+        memcpy(&float_value, &raw, sizeof(raw));
+        result = set_param(key, type, type == PARAM_TYPE_INT ? (void *)&int_value : (void *)&float_value);
+    } else {
+        return RPC_ERR_INVALID;
+    }
+
+    if (result == -2) return RPC_ERR_RANGE;
+    return result == 0 ? RPC_OK : RPC_ERR_INVALID;
+}
+
+static rpc_status_t rpc_stats_system(rpc_session_t *session, const uint8_t *args, size_t length, uint8_t *out, size_t *out_length) {
+    put_u64(out, time_us_64());
+    put_u64(out + 8, (uint64_t)scheduler_get_busy_time());
+    put_u64(out + 16, irq_account_total_time());
+    out[24] = (uint8_t)scheduler_get_task_count();
+    out[25] = (uint8_t)scheduler_get_active_algorithm();
+    *out_length = 26;
+    return RPC_OK;
+}
+
+static rpc_status_t rpc_stats_task(rpc_session_t *session, const uint8_t *args, size_t length, uint8_t *out, size_t *out_length) {
+    if (args[0] >= scheduler_get_task_count()) return RPC_ERR_INVALID;
+    const task_t *t = scheduler_get_task(args[0]);
+
+    out[0] = (uint8_t)t->state;
+    put_u32(out + 1, (uint32_t)t->priority);
+    put_u32(out + 5, clamp_u32(t->interval));
+    put_u32(out + 9, (uint32_t)t->exec_count);
+    put_u32(out + 13, t->exec_count ? clamp_u32(t->total_exec_time / t->exec_count) : 0);
+    put_u32(out + 17, clamp_u32(t->max_exec_time));
+    put_u32(out + 21, clamp_u32(t->max_jitter));
+    put_u32(out + 25, (uint32_t)t->deadline_misses);
+
+    size_t n = strlen(t->name);
+    if (n > RPC_MAX_PAYLOAD - 29) n = RPC_MAX_PAYLOAD - 29;
+    memcpy(out + 29, t->name, n);
+    *out_length = 29 + n;
+    return RPC_OK;
+}
+
+static rpc_status_t rpc_stream_start(rpc_session_t *session, const uint8_t *args, size_t length, uint8_t *out, size_t *out_length) {
+    char names[RPC_MAX_FRAME];
+    memcpy(names, args + 6, length - 6);
+    names[length - 6] = '\0';
+
+    uint32_t hz = (uint32_t)args[0] | (uint32_t)args[1] << 8;
+    if (stream_start(session, hz, get_u32(args + 2), names) != STREAM_OK) return RPC_ERR_INVALID;
+    out[0] = (uint8_t)stream_get_metric_count();
+    *out_length = 1;
+    return RPC_OK;
+}
+
+static rpc_status_t rpc_stream_stop(rpc_session_t *session, const uint8_t *args, size_t length, uint8_t *out, size_t *out_length) {
+    stream_stop();
+    return RPC_OK;
+}
+
+static const rpc_handler_entry_t rpc_handlers[] = {
+    { RPC_OP_PING,           true,  0, rpc_ping },
+    { RPC_OP_LOGIN,          true,  0, rpc_login },
+    { RPC_OP_SCHED_GET,      false, 0, rpc_sched_get },
+    { RPC_OP_SCHED_SET_ALGO, false, 1, rpc_sched_set_algo },
+    { RPC_OP_TASK_PRIORITY,  false, 5, rpc_task_priority },
+    { RPC_OP_TASK_INTERVAL,  false, 5, rpc_task_interval },
+    { RPC_OP_TASK_PAUSE,     false, 1, rpc_task_pause },
+    { RPC_OP_TASK_RESUME,    false, 1, rpc_task_resume },
+    { RPC_OP_PARAM_GET,      false, 4, rpc_param_get },
+    { RPC_OP_PARAM_SET,      false, 5, rpc_param_set },
+    { RPC_OP_STATS_SYSTEM,   false, 0, rpc_stats_system },
+    { RPC_OP_STATS_TASK,     false, 1, rpc_stats_task },
+    { RPC_OP_STREAM_START,   false, 6, rpc_stream_start },
+    { RPC_OP_STREAM_STOP,    false, 0, rpc_stream_stop },
+};
+
+// Runs a decoded request (CRC removed) and sends the response
+static void handle_request(rpc_session_t *session, const uint8_t *request, size_t length) {
+    uint8_t response[RPC_MAX_FRAME - RPC_CRC_SIZE];
+    size_t payload_length = 0;
+    const uint8_t *args = request + RPC_REQUEST_HEADER;
+    size_t args_length = length - RPC_REQUEST_HEADER;
+    rpc_status_t status = RPC_ERR_UNKNOWN_OP;
+
+    for (size_t i = 0; i < sizeof(rpc_handlers) / sizeof(rpc_handlers[0]); i++) {
+        const rpc_handler_entry_t *h = &rpc_handlers[i];
+        if (h->op != request[0]) continue;
+
+        if (!h->public && !terminal_is_authenticated(session->terminal)) {
+            status = RPC_ERR_AUTH;
+        } else if (args_length < h->min_length) {
+            status = RPC_ERR_LENGTH;
+        } else {
+            status = h->handler(session, args, args_length, response + RPC_RESPONSE_HEADER, &payload_length);
+        }
+        break;
+    }
+    if (status != RPC_OK) payload_length = 0;
+
+    response[0] = request[0] | RPC_RESPONSE;
+    response[1] = request[1]; // Request ID
+    response[2] = request[2];
+    response[3] = (uint8_t)status;
+    rpc_send_frame(session, response, RPC_RESPONSE_HEADER + payload_length);
+    metric_inc(&metric_requests);
+}
+
+// -----------------------------------------------------------------------------
+// Binary Protocol API
+// -----------------------------------------------------------------------------
+
+void rpc_session_init(rpc_session_t *session, terminal_context_t *terminal, rpc_write_t write) {
+    session->terminal = terminal;
+    session->write = write;
+    rpc_session_reset(session);
+}
+
+void rpc_session_reset(rpc_session_t *session) {
+    session->length = 0;
+    session->overflow = false;
+}
+
+void rpc_send_frame(rpc_session_t *session, const uint8_t *data, size_t length) {
+    uint8_t frame[RPC_MAX_FRAME];
+    uint8_t encoded[RPC_MAX_ENCODED + 2];
+
+    if (length > RPC_MAX_FRAME - RPC_CRC_SIZE) return;
+    memcpy(frame, data, length);
+    put_u16(frame + length, rpc_crc16(data, length));
+
+    // The leading delimiter separates the frame from text output sent before it
+    encoded[0] = RPC_DELIMITER;
+    size_t n = rpc_cobs_encode(frame, length + RPC_CRC_SIZE, encoded + 1);
+    encoded[n + 1] = RPC_DELIMITER;
+    session->write(encoded, n + 2);
+}
+
+bool rpc_feed(rpc_session_t *session, uint8_t byte) {
+    if (byte != RPC_DELIMITER) {
+        if (session->length < sizeof(session->frame)) {
+            session->frame[session->length++] = byte;
+        } else {
+            session->overflow = true;
+        }
+        return false;
+    }
+    if (session->length == 0) return false; // Delimiter before a frame
+
+    uint8_t frame[RPC_MAX_ENCODED];
+    size_t length = session->overflow ? 0 : rpc_cobs_decode(session->frame, session->length, frame);
+    rpc_session_reset(session);
+
+    // Responses are ignored, so a loopback cannot start an endless exchange
+    if (length < RPC_REQUEST_HEADER + RPC_CRC_SIZE || (frame[0] & RPC_RESPONSE) ||
+        rpc_crc16(frame, length - RPC_CRC_SIZE) != (uint16_t)(frame[length - 2] | frame[length - 1] << 8)) {
+        metric_inc(&metric_frame_errors);
+        return true;
+    }
+    handle_request(session, frame, length - RPC_CRC_SIZE);
+    return true;
+}
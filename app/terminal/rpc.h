@@ -0,0 +1,95 @@
+#ifndef RPC_H
+#define RPC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "terminal.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define RPC_MAX_FRAME      256                    // Decoded frame: header, payload and CRC
+#define RPC_MAX_ENCODED    (RPC_MAX_FRAME + RPC_MAX_FRAME / 254 + 1) // COBS worst case
+#define RPC_DELIMITER      0x00                   // Ends a frame, never appears inside one
+#define RPC_RESPONSE       0x80                   // Set in the opcode of a response
+#define RPC_REQUEST_HEADER 3                      // Opcode, request ID
+#define RPC_RESPONSE_HEADER 4                     // Opcode, request ID, status
+#define RPC_CRC_SIZE       2
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+// A frame is COBS(opcode, request ID, payload, CRC-16) followed by RPC_DELIMITER.
+// Multi-byte fields are little endian. A response repeats the request ID, so a
+// client can send many requests before reading the responses.
+
+// Opcodes and their payloads (request -> response)
+typedef enum {
+    RPC_OP_PING           = 0x01, // any bytes -> same bytes
+    RPC_OP_LOGIN          = 0x02, // password -> none
+    RPC_OP_SCHED_GET      = 0x10, // none -> u8 selected algorithm, u8 active algorithm, u8 task count
+    RPC_OP_SCHED_SET_ALGO = 0x11, // u8 algorithm -> none
+    RPC_OP_TASK_PRIORITY  = 0x12, // u8 task, i32 priority -> none
+    RPC_OP_TASK_INTERVAL  = 0x13, // u8 task, u32 interval (us) -> none
+    RPC_OP_TASK_PAUSE     = 0x14, // u8 task -> none
+    RPC_OP_TASK_RESUME    = 0x15, // u8 task -> none
+    RPC_OP_PARAM_GET      = 0x20, // i32 key -> u8 type, value (i32, f32 or string bytes)
+    RPC_OP_PARAM_SET      = 0x21, // i32 key, u8 type, value -> none
+    RPC_OP_STATS_SYSTEM   = 0x30, // none -> u64 uptime, u64 busy, u64 irq (us), u8 task count, u8 algorithm
+    RPC_OP_STATS_TASK     = 0x31, // u8 task -> u8 state, i32 priority, u32 interval, u32 runs, u32 avg,
+                                  //            u32 max, u32 max jitter (us), u32 misses, name bytes
+    RPC_OP_STREAM_START   = 0x40, // u16 rate (Hz), u32 task mask, metric names separated by ',' -> u8 metrics
+    RPC_OP_STREAM_STOP    = 0x41, // none -> none
+    RPC_OP_STREAM_RECORD  = 0x42, // Sent unrequested with RPC_RESPONSE set, the request ID is the sequence number
+} rpc_op_t;
+
+// Response status
+typedef enum {
+    RPC_OK = 0,
+    RPC_ERR_UNKNOWN_OP,    // Opcode not supported
+    RPC_ERR_LENGTH,        // Payload too short or too long
+    RPC_ERR_AUTH,          // Login required
+    RPC_ERR_INVALID,       // Invalid task, parameter or value
+    RPC_ERR_RANGE,         // Value outside the parameter range
+} rpc_status_t;
+
+// Sends the bytes of a frame
+typedef void (*rpc_write_t)(const uint8_t *data, size_t length);
+
+// Receive state of one link
+typedef struct {
+    uint8_t frame[RPC_MAX_ENCODED];  // Encoded bytes since the last delimiter
+    size_t length;                   // Bytes in frame
+    bool overflow;                   // The frame is too long, dropped at the delimiter
+    terminal_context_t *terminal;    // Terminal of the link, shares its login state
+    rpc_write_t write;               // Output of the link
+} rpc_session_t;
+
+// -----------------------------------------------------------------------------
+// Binary Protocol API
+// -----------------------------------------------------------------------------
+
+// Prepares a session for a link
+void rpc_session_init(rpc_session_t *session, terminal_context_t *terminal, rpc_write_t write);
+
+// Feeds one received byte, returns true when it completed a frame
+bool rpc_feed(rpc_session_t *session, uint8_t byte);
+
+// Drops a partially received frame
+void rpc_session_reset(rpc_session_t *session);
+
+// Sends a frame on the link of a session: delimiter, COBS(data, CRC), delimiter
+void rpc_send_frame(rpc_session_t *session, const uint8_t *data, size_t length);
+
+// COBS encoding, returns the encoded length (out holds length + length / 254 + 1 bytes)
+size_t rpc_cobs_encode(const uint8_t *in, size_t length, uint8_t *out);
+
+// COBS decoding, returns the decoded length or 0 if the input is malformed
+size_t rpc_cobs_decode(const uint8_t *in, size_t length, uint8_t *out);
+
+// CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF)
+uint16_t rpc_crc16(const uint8_t *data, size_t length);
+
+#endif // RPC_H
@@ -0,0 +1,162 @@
+#include <string.h>
+
+#include "pico/time.h"
+
+#include "stream.h"
+#include "scheduler.h"
+#include "metrics.h"
+#include "initcalls.h"
+#include "fmt.h"
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static rpc_session_t *stream_session = NULL;   // Subscriber, NULL when stopped
+static uint32_t stream_hz = 0;
+static uint32_t stream_mask = 0;               // Subscribed tasks
+static const metric_t *stream_metrics[STREAM_MAX_METRICS];
+static int stream_metric_count = 0;
+static uint16_t sequence = 0;                  // Sequence number of the next record
+static uint32_t since_keyframe = 0;            // Records sent since the last keyframe
+static uint32_t last_values[1 + STREAM_MAX_TASKS * STREAM_TASK_FIELDS + STREAM_MAX_METRICS]; // Values of the previous record
+static uint32_t records_sent = 0;
+static int stream_task = -1;
+
+// -----------------------------------------------------------------------------
+// Encoding
+// -----------------------------------------------------------------------------
+
+static size_t put_varint(uint8_t *p, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+// Appends the change of a value since the previous record, small either way
+static size_t put_delta(uint8_t *p, uint32_t value, uint32_t *last) {
+    int32_t delta = (int32_t)(value - *last);
+    *last = value;
+    return put_varint(p, ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+}
+
+// -----------------------------------------------------------------------------
+// Stream Task
+// -----------------------------------------------------------------------------
+
+void task_stream(void) {
+    if (!stream_session) return;
+
+    uint8_t frame[RPC_MAX_FRAME - RPC_CRC_SIZE];
+    uint32_t *last = last_values;
+    bool keyframe = since_keyframe == 0;
+    size_t n = 0;
+
+    frame[n++] = RPC_OP_STREAM_RECORD | RPC_RESPONSE;
+    frame[n++] = (uint8_t)sequence;
+    frame[n++] = (uint8_t)(sequence >> 8);
+    frame[n++] = RPC_OK;
+    frame[n++] = keyframe ? STREAM_FLAG_KEYFRAME : 0;
+    if (keyframe) {
+        memset(last_values, 0, sizeof(last_values));
+        n += put_varint(frame + n, stream_mask);
+        frame[n++] = (uint8_t)stream_metric_count;
+    }
+
+    n += put_delta(frame + n, time_us_32(), last++);
+    for (int i = 0; i < scheduler_get_task_count(); i++) {
+        if (!(stream_mask & (1u << i))) continue;
+        const task_t *t = scheduler_get_task(i);
+        n += put_delta(frame + n, (uint32_t)t->exec_count, last++);
+        n += put_delta(frame + n, (uint32_t)t->total_exec_time, last++);
+        n += put_delta(frame + n, (uint32_t)t->max_exec_time, last++);
+        n += put_delta(frame + n, (uint32_t)t->max_jitter, last++);
+        n += put_delta(frame + n, (uint32_t)t->deadline_misses, last++);
+    }
+    for (int i = 0; i < stream_metric_count; i++) {
+        n += put_delta(frame + n, (uint32_t)stream_metrics[i]->value, last++);
+    }
+
+    rpc_send_frame(stream_session, frame, n);
+    sequence++;
+    records_sent++;
+    since_keyframe = (since_keyframe + 1) % STREAM_KEYFRAME_INTERVAL;
+}
+
+// -----------------------------------------------------------------------------
+// Streaming API
+// -----------------------------------------------------------------------------
+
+// Resolves the metric names into stream_metrics
+static stream_error_t parse_metrics(const char *names) {
+    char buffer[128];
+    char *saveptr;
+
+    stream_metric_count = 0;
+    if (!names) return STREAM_OK;
+    strncpy(buffer, names, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+
+    for (char *name = strtok_r(buffer, ", ", &saveptr); name; name = strtok_r(NULL, ", ", &saveptr)) {
+        const metric_t *m = metrics_find(name);
+        if (!m || m->collect || m->type == METRIC_HISTOGRAM || stream_metric_count >= STREAM_MAX_METRICS) {
+            stream_metric_count = 0;
+            return STREAM_ERR_METRIC;
+        }
+        stream_metrics[stream_metric_count++] = m;
+    }
+    return STREAM_OK;
+}
+
+stream_error_t stream_start(rpc_session_t *session, uint32_t hz, uint32_t task_mask, const char *metric_names) {
+    if (hz == 0 || hz > STREAM_MAX_HZ) return STREAM_ERR_RATE;
+    uint32_t valid = scheduler_get_task_count() >= 32 ? UINT32_MAX : (1u << scheduler_get_task_count()) - 1;
+    if ((task_mask & ~valid) || __builtin_popcount(task_mask) > STREAM_MAX_TASKS) return STREAM_ERR_TASKS;
+
+    stream_stop();
+    stream_error_t err = parse_metrics(metric_names);
+    if (err != STREAM_OK) return err;
+
+    stream_mask = task_mask;
+    stream_hz = hz;
+    since_keyframe = 0;
+    stream_session = session;
+    scheduler_set_task_interval(stream_task, 1000000 / hz);
+    scheduler_resume_task(stream_task);
+    return STREAM_OK;
+}
+
+void stream_stop(void) {
+    stream_session = NULL;
+    scheduler_pause_task(stream_task);
+}
+
+int stream_get_metric_count(void) {
+    return stream_metric_count;
+}
+
+void stream_print_status(void) {
+    fmt_printf("\n--- Stream ---\n");
+    if (!stream_session) {
+        fmt_printf("State: stopped, %lu records sent\n\n", (unsigned long)records_sent);
+        return;
+    }
+    fmt_printf("State: %lu Hz, task mask 0x%08lx, next sequence %u, %lu records sent\n", (unsigned long)stream_hz,
+               (unsigned long)stream_mask, sequence, (unsigned long)records_sent);
+    for (int i = 0; i < stream_metric_count; i++) {
+        fmt_printf("Metric: %s\n", stream_metrics[i]->name);
+    }
+    fmt_printf("\n");
+}
+
+// Adds the stream task paused, a subscription starts it
+static void task_stream_init(void) {
+    if (scheduler_add_task("stream", task_stream, 0, 1000000 / STREAM_MAX_HZ, TASK_PAUSED, sizeof(last_values)) != SCHED_ERR_OK) {
+        fmt_printf("[STREAM][ERROR] Failed to add stream task.\n");
+    }
+    stream_task = scheduler_find_task("stream");
+}
+REGISTER_INITCALL(task_stream_init);
@@ -0,0 +1,57 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "rpc.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define STREAM_MAX_TASKS         8    // Tasks per subscription, a keyframe always fits one frame
+#define STREAM_MAX_METRICS       4    // Metrics per subscription
+#define STREAM_MAX_HZ            100  // Highest record rate
+#define STREAM_KEYFRAME_INTERVAL 50   // Records between two keyframes
+#define STREAM_TASK_FIELDS       5    // Runs, total time, max time, max jitter, misses
+#define STREAM_FLAG_KEYFRAME     0x01 // Values are absolute, the record also carries the subscription
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+// A record is an RPC_OP_STREAM_RECORD frame whose request ID is a 16-bit sequence
+// number. Its payload is a flags byte, then in a keyframe the task mask (varint)
+// and the metric count (byte), then one varint per value: the timestamp (us),
+// STREAM_TASK_FIELDS per subscribed task in index order, one per metric. Values
+// are the low 32 bits of the statistics; each varint is the zigzag-encoded
+// difference from the previous record, or from zero in a keyframe. After a gap
+// in the sequence a client waits for the next keyframe.
+
+typedef enum {
+    STREAM_OK = 0,
+    STREAM_ERR_RATE,     // Rate is 0 or above STREAM_MAX_HZ
+    STREAM_ERR_TASKS,    // Unknown task or more than STREAM_MAX_TASKS
+    STREAM_ERR_METRIC,   // Unknown metric, labelled metric or histogram, or too many
+} stream_error_t;
+
+// -----------------------------------------------------------------------------
+// Streaming API
+// -----------------------------------------------------------------------------
+
+// Starts sending records to a session, replacing the previous subscription
+// metric_names lists plain counters and gauges separated by ',' or ' ' (may be NULL).
+stream_error_t stream_start(rpc_session_t *session, uint32_t hz, uint32_t task_mask, const char *metric_names);
+
+// Stops the records
+void stream_stop(void);
+
+// Returns the number of subscribed metrics
+int stream_get_metric_count(void);
+
+// Prints the subscription and the records sent
+void stream_print_status(void);
+
+// Task function: sends one record per run
+void task_stream(void);
+
+#endif // STREAM_H
@@ -0,0 +1,361 @@
+#include <string.h>
+
+#include "pico/time.h"
+
+#include "top.h"
+#include "scheduler.h"
+#include "irq_account.h"
+#include "task_terminal.h"
+#include "initcalls.h"
+#include "fmt.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+
+// Screen rows, from 1
+#define ROW_SUMMARY 1
+#define ROW_STATUS  2
+#define ROW_HEADER  4
+#define ROW_TASKS   5
+
+#define HINT_COLUMN 50 // "Any key exits" on the summary row
+
+// Values of the two summary rows and of a task row
+enum { SUMMARY_UPTIME, SUMMARY_CPU, SUMMARY_IRQ, SUMMARY_ALGORITHM, SUMMARY_SORT, SUMMARY_RATE, SUMMARY_OUTPUT, SUMMARY_CELLS };
+enum { CELL_PID, CELL_NAME, CELL_STATE, CELL_PRIORITY, CELL_CPU, CELL_RUNS, CELL_AVG, CELL_MAX, CELL_JITTER, CELL_MISSES, TASK_CELLS };
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// One value on screen
+typedef struct {
+    const char *label; // Column header of a task value, label before a summary value
+    uint8_t row;       // Screen row of a summary value
+    uint8_t width;     // Characters of the value, longer text is cut
+} top_field_t;
+
+static const top_field_t summary_fields[SUMMARY_CELLS] = {
+    [SUMMARY_UPTIME]    = { "Uptime", ROW_SUMMARY, 10 },
+    [SUMMARY_CPU]       = { "CPU", ROW_SUMMARY, 6 },
+    [SUMMARY_IRQ]       = { "IRQ", ROW_SUMMARY, 6 },
+    [SUMMARY_ALGORITHM] = { "Alg", ROW_STATUS, 23 },
+    [SUMMARY_SORT]      = { "Sort", ROW_STATUS, 6 },
+    [SUMMARY_RATE]      = { "Rate", ROW_STATUS, 6 },
+    [SUMMARY_OUTPUT]    = { "Out", ROW_STATUS, 7 },
+};
+
+static const top_field_t task_fields[TASK_CELLS] = {
+    [CELL_PID]      = { "PID", 0, 3 },
+    [CELL_NAME]     = { "Name", 0, 10 },
+    [CELL_STATE]    = { "State", 0, 7 },
+    [CELL_PRIORITY] = { "Prio", 0, 4 },
+    [CELL_CPU]      = { "CPU%", 0, 6 },
+    [CELL_RUNS]     = { "Runs", 0, 10 },
+    [CELL_AVG]      = { "AvgUs", 0, 8 },
+    [CELL_MAX]      = { "MaxUs", 0, 8 },
+    [CELL_JITTER]   = { "MaxJitUs", 0, 8 },
+    [CELL_MISSES]   = { "Misses", 0, 7 },
+};
+
+static const char *const sort_names[TOP_SORT_COUNT] = { "CPU", "JITTER", "MISSES" };
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static terminal_context_t *top_context = NULL; // Session showing the view, NULL when stopped
+static top_sort_t top_sort = TOP_SORT_CPU;
+static uint32_t top_hz = 0;
+static int top_task = -1;
+
+static uint8_t summary_columns[SUMMARY_CELLS];            // Screen column of each value
+static uint8_t task_columns[TASK_CELLS];
+static uint32_t summary_shown[SUMMARY_CELLS];             // Values on screen
+static uint32_t task_shown[MAX_TASKS][TASK_CELLS];        // Values on screen, by screen row
+static int rows_shown = -1;                               // Task rows on screen, -1 before the first frame
+static uint64_t last_full_us = 0;                         // Time of the last full redraw
+
+// Totals at the previous frame, the CPU shares cover the time between two frames
+static uint64_t last_frame_us = 0;
+static int64_t last_exec_time[MAX_TASKS];
+static int64_t last_busy_time = 0;
+static uint64_t last_irq_time = 0;
+
+// Output of the frame being drawn
+static char buffer[TOP_BUFFER_SIZE];
+static size_t buffered = 0;
+static uint32_t frame_bytes = 0;                          // Bytes of the frame being drawn
+static uint32_t last_frame_bytes = 0;
+static int cursor_row = 0, cursor_column = 0;             // Terminal cursor, 0 when unknown
+
+// -----------------------------------------------------------------------------
+// Output
+// -----------------------------------------------------------------------------
+
+static void top_flush(void) {
+    if (buffered) terminal_write(top_context, buffer, buffered);
+    buffered = 0;
+}
+
+static void top_write(void *context, const char *data, size_t length) {
+    (void)context;
+    frame_bytes += (uint32_t)length;
+    while (length) {
+        size_t n = sizeof(buffer) - buffered;
+        if (n > length) n = length;
+        memcpy(buffer + buffered, data, n);
+        buffered += n;
+        data += n;
+        length -= n;
+        if (buffered == sizeof(buffer)) top_flush();
+    }
+}
+
+static void FMT_PRINTF(1, 2) top_printf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    fmt_format(top_write, NULL, format, args);
+    va_end(args);
+}
+
+// Writes text padded or cut to a width
+// A cell right after the previous one only needs the separating space, not a cursor move.
+static void draw_text(int row, int column, int width, const char *text) {
+    if (row == cursor_row && column == cursor_column + 1) {
+        top_printf(" %-*.*s", width, width, text);
+    } else {
+        top_printf(VT100_CURSOR_TO "%-*.*s", row, column, width, width, text);
+    }
+    cursor_row = row;
+    cursor_column = column + width - 1;
+}
+
+// -----------------------------------------------------------------------------
+// Cells
+// -----------------------------------------------------------------------------
+
+static void format_permille(char *text, size_t size, uint32_t permille) {
+    fmt_snprintf(text, size, "%lu.%lu%%", (unsigned long)(permille / 10), (unsigned long)(permille % 10));
+}
+
+static void format_summary(int cell, uint32_t value, char *text, size_t size) {
+    switch (cell) {
+        case SUMMARY_UPTIME: fmt_snprintf(text, size, "%lu s", (unsigned long)value); break;
+        case SUMMARY_CPU:
+        case SUMMARY_IRQ: format_permille(text, size, value); break;
+        case SUMMARY_ALGORITHM: fmt_snprintf(text, size, "%s", scheduler_algorithm_to_string((sched_algorithm_t)value)); break;
+        case SUMMARY_SORT: fmt_snprintf(text, size, "%s", sort_names[value]); break;
+        case SUMMARY_RATE: fmt_snprintf(text, size, "%lu Hz", (unsigned long)value); break;
+        case SUMMARY_OUTPUT: fmt_snprintf(text, size, "%lu B", (unsigned long)value); break;
+    }
+}
+
+static void format_task(int cell, uint32_t value, char *text, size_t size) {
+    switch (cell) {
+        case CELL_NAME: fmt_snprintf(text, size, "%s", scheduler_get_task((int)value)->name); break;
+        case CELL_STATE: fmt_snprintf(text, size, "%s", value == TASK_RUNNING ? "RUNNING" : "PAUSED"); break;
+        case CELL_PRIORITY: fmt_snprintf(text, size, "%ld", (long)(int32_t)value); break;
+        case CELL_CPU: format_permille(text, size, value); break;
+        default: fmt_snprintf(text, size, "%lu", (unsigned long)value); break;
+    }
+}
+
+// Draws the values that differ from the ones on screen, all of them on a full redraw
+static void draw_summary(const uint32_t *values, bool full) {
+    char text[32];
+    for (int i = 0; i < SUMMARY_CELLS; i++) {
+        if (!full && values[i] == summary_shown[i]) continue;
+        summary_shown[i] = values[i];
+        format_summary(i, values[i], text, sizeof(text));
+        draw_text(summary_fields[i].row, summary_columns[i], summary_fields[i].width, text);
+    }
+}
+
+static void draw_task_row(int row, const uint32_t *values, bool full) {
+    char text[32];
+    uint32_t *shown = task_shown[row];
+    for (int i = 0; i < TASK_CELLS; i++) {
+        if (!full && values[i] == shown[i]) continue;
+        shown[i] = values[i];
+        format_task(i, values[i], text, sizeof(text));
+        draw_text(ROW_TASKS + row, task_columns[i], task_fields[i].width, text);
+    }
+}
+
+// Clears the screen and draws what does not change: labels and column headers
+static void draw_frame(void) {
+    top_printf(VT100_CURSOR_HIDE VT100_CLEAR_SCREEN);
+    for (int i = 0; i < SUMMARY_CELLS; i++) {
+        top_printf(VT100_CURSOR_TO "%s:", summary_fields[i].row, summary_columns[i] - (int)strlen(summary_fields[i].label) - 2,
+                   summary_fields[i].label);
+    }
+    top_printf(VT100_CURSOR_TO "Any key exits", ROW_SUMMARY, HINT_COLUMN);
+    top_printf(VT100_CURSOR_TO, ROW_HEADER, 1);
+    for (int i = 0; i < TASK_CELLS; i++) {
+        top_printf("%-*s ", task_fields[i].width, task_fields[i].label);
+    }
+    cursor_row = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Top Task
+// -----------------------------------------------------------------------------
+
+// Share of an interval in tenths of a percent
+static uint32_t permille(int64_t part, uint64_t whole) {
+    if (part <= 0 || whole == 0) return 0;
+    uint64_t p = (uint64_t)part * 1000u / whole;
+    return p > 1000 ? 1000 : (uint32_t)p;
+}
+
+// Value the rows are sorted by
+static uint32_t sort_key(const task_t *t, uint32_t cpu) {
+    switch (top_sort) {
+        case TOP_SORT_JITTER: return (uint32_t)t->max_jitter;
+        case TOP_SORT_MISSES: return (uint32_t)t->deadline_misses;
+        default: return cpu;
+    }
+}
+
+void task_top(void) {
+    if (!top_context) return;
+
+    uint64_t now = time_us_64();
+    uint64_t elapsed = now - last_frame_us;
+    int count = scheduler_get_task_count();
+    bool full = count != rows_shown || now - last_full_us >= TOP_FULL_REDRAW_US;
+
+    // CPU share of every task since the previous frame, and the rows in sort order
+    uint32_t cpu[MAX_TASKS];
+    uint32_t keys[MAX_TASKS];
+    uint8_t order[MAX_TASKS];
+    for (int i = 0; i < count; i++) {
+        const task_t *t = scheduler_get_task(i);
+        cpu[i] = permille(t->total_exec_time - last_exec_time[i], elapsed);
+        last_exec_time[i] = t->total_exec_time;
+        keys[i] = sort_key(t, cpu[i]);
+
+        // Insertion sort, highest key first and lower index first on ties
+        int j = i;
+        while (j > 0 && keys[order[j - 1]] < keys[i]) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = (uint8_t)i;
+    }
+
+    uint32_t summary[SUMMARY_CELLS];
+    int64_t busy = scheduler_get_busy_time();
+    uint64_t irq = irq_account_total_time();
+    summary[SUMMARY_UPTIME] = (uint32_t)(now / 1000000u);
+    summary[SUMMARY_CPU] = permille(busy - last_busy_time, elapsed);
+    summary[SUMMARY_IRQ] = permille((int64_t)(irq - last_irq_time), elapsed);
+    summary[SUMMARY_ALGORITHM] = scheduler_get_active_algorithm();
+    summary[SUMMARY_SORT] = top_sort;
+    summary[SUMMARY_RATE] = top_hz;
+    summary[SUMMARY_OUTPUT] = last_frame_bytes;
+    last_busy_time = busy;
+    last_irq_time = irq;
+    last_frame_us = now;
+
+    frame_bytes = 0;
+    if (full) {
+        draw_frame();
+        last_full_us = now;
+        rows_shown = count;
+    }
+    draw_summary(summary, full);
+    for (int r = 0; r < count; r++) {
+        const task_t *t = scheduler_get_task(order[r]);
+        uint32_t values[TASK_CELLS] = {
+            [CELL_PID] = order[r],
+            [CELL_NAME] = order[r],
+            [CELL_STATE] = (uint32_t)t->state,
+            [CELL_PRIORITY] = (uint32_t)t->priority,
+            [CELL_CPU] = cpu[order[r]],
+            [CELL_RUNS] = (uint32_t)t->exec_count,
+            [CELL_AVG] = t->exec_count > 0 ? (uint32_t)(t->total_exec_time / t->exec_count) : 0,
+            [CELL_MAX] = (uint32_t)t->max_exec_time,
+            [CELL_JITTER] = (uint32_t)t->max_jitter,
+            [CELL_MISSES] = (uint32_t)t->deadline_misses,
+        };
+        draw_task_row(r, values, full);
+    }
+
+    // Park the cursor below the table, where foreign output does the least damage
+    if (cursor_row != 0) {
+        top_printf(VT100_CURSOR_TO, ROW_TASKS + count + 1, 1);
+        cursor_row = 0;
+    }
+    top_flush();
+    last_frame_bytes = frame_bytes;
+}
+
+// -----------------------------------------------------------------------------
+// Live View API
+// -----------------------------------------------------------------------------
+
+void top_start(terminal_context_t *context, uint32_t hz, top_sort_t sort) {
+    top_stop();
+
+    top_sort = sort;
+    top_hz = hz;
+    rows_shown = -1;
+    last_frame_bytes = 0;
+    last_frame_us = time_us_64();
+    last_busy_time = scheduler_get_busy_time();
+    last_irq_time = irq_account_total_time();
+    for (int i = 0; i < scheduler_get_task_count(); i++) {
+        last_exec_time[i] = scheduler_get_task(i)->total_exec_time;
+    }
+
+    // The first frame is drawn by the task, after the prompt of the command
+    top_context = context;
+    scheduler_set_task_interval(top_task, 1000000 / hz);
+    scheduler_resume_task(top_task);
+}
+
+void top_stop(void) {
+    if (!top_context) return;
+    scheduler_pause_task(top_task);
+    if (rows_shown >= 0) {
+        top_printf(VT100_CURSOR_TO VT100_CLEAR_LINE VT100_CURSOR_SHOW, ROW_TASKS + rows_shown + 1, 1);
+        top_flush();
+    }
+    top_context = NULL;
+}
+
+bool top_is_running_on(const terminal_context_t *context) {
+    return top_context != NULL && top_context == context;
+}
+
+const char *top_sort_to_string(top_sort_t sort) {
+    return sort < TOP_SORT_COUNT ? sort_names[sort] : "UNKNOWN";
+}
+
+// Lays out the screen and adds the top task paused, TOP starts it
+static void task_top_init(void) {
+    int column = 1;
+    int row = summary_fields[0].row;
+    for (int i = 0; i < SUMMARY_CELLS; i++) {
+        if (summary_fields[i].row != row) {
+            row = summary_fields[i].row;
+            column = 1;
+        }
+        column += (int)strlen(summary_fields[i].label) + 2; // "Label: "
+        summary_columns[i] = (uint8_t)column;
+        column += summary_fields[i].width + 2;
+    }
+    column = 1;
+    for (int i = 0; i < TASK_CELLS; i++) {
+        task_columns[i] = (uint8_t)column;
+        column += task_fields[i].width + 1;
+    }
+
+    if (scheduler_add_task("top", task_top, 0, 1000000 / TOP_DEFAULT_HZ, TASK_PAUSED, sizeof(task_shown)) != SCHED_ERR_OK) {
+        fmt_printf("[TOP][ERROR] Failed to add top task.\n");
+    }
+    top_task = scheduler_find_task("top");
+}
+REGISTER_INITCALL(task_top_init);
@@ -0,0 +1,54 @@
+#ifndef TOP_H
+#define TOP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "terminal.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define TOP_DEFAULT_HZ     2        // Refresh rate when none is given
+#define TOP_MAX_HZ         10       // Highest refresh rate
+#define TOP_FULL_REDRAW_US 10000000 // The whole screen is redrawn this often, repairing foreign output
+#define TOP_BUFFER_SIZE    128      // Output gathered before it is queued on the link
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// Order of the task rows, highest first
+typedef enum {
+    TOP_SORT_CPU = 0,   // CPU share since the previous frame
+    TOP_SORT_JITTER,    // Maximum jitter
+    TOP_SORT_MISSES,    // Deadline misses
+    TOP_SORT_COUNT
+} top_sort_t;
+
+// -----------------------------------------------------------------------------
+// Live View API
+// -----------------------------------------------------------------------------
+// TOP shows the task statistics of PS on a VT100 screen refreshed in place.
+// The first frame clears the screen and draws labels and headers; later
+// frames compare each value with the one on screen and rewrite only the
+// cells that changed, so a steady system costs a few bytes per refresh.
+// Only values that changed are formatted. The view belongs to the session
+// that started it, whose input is reserved for the key that ends it.
+
+// Starts the view on the session of a terminal context, replacing a running one
+void top_start(terminal_context_t *context, uint32_t hz, top_sort_t sort);
+
+// Ends the view and restores the cursor below it
+void top_stop(void);
+
+// Returns true while the view runs on the session of a context
+bool top_is_running_on(const terminal_context_t *context);
+
+// Returns the name of a sort order
+const char *top_sort_to_string(top_sort_t sort);
+
+// Task function: draws one frame
+void task_top(void);
+
+#endif // TOP_H
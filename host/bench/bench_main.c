@@ -0,0 +1,100 @@
+// Microbenchmarks of the scheduler, terminal, configuration and formatting hot paths
+//
+// Runs the cases of system/bench.c on the host, sweeping the number of tasks up to
+// the MAX_TASKS of the build (see host/CMakeLists.txt), plus a full scheduler_run_once per algorithm, which cannot run inside the live
+// scheduler on the device. Output is the same CSV as the BENCH terminal command.
+//
+// Usage: sched_bench [SCHED|TERM|CONFIG|FMT]
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/time.h"
+#include "bench.h"
+#include "scheduler.h"
+#include "config.h"
+#include "terminal.h"
+#include "initcalls.h"
+
+// Defaults are not used by the benchmark, the parameter table is filled in main()
+const config_param_t default_params[MAX_PARAMS] = {{0}};
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static char task_names[MAX_TASKS][8];
+
+// -----------------------------------------------------------------------------
+// Cases
+// -----------------------------------------------------------------------------
+
+static void noop_task(void) {
+}
+
+// One full scheduler iteration, time advances so tasks keep being released
+static void bench_op_run_once(void *arg) {
+    (void)arg;
+    virtual_time_advance(100);
+    scheduler_run_once();
+}
+
+// Returns true for the sizes of a sweep: powers of two and the maximum
+static bool is_sweep_size(int n, int max) {
+    return (n & (n - 1)) == 0 || n == max;
+}
+
+static void bench_scheduler_sweep(void) {
+    char name[48];
+    scheduler_start();
+    for (int n = 1; n <= MAX_TASKS; n++) {
+        snprintf(task_names[n - 1], sizeof(task_names[n - 1]), "t%02d", n - 1);
+        scheduler_add_task(task_names[n - 1], noop_task, n % 4, 1000, TASK_RUNNING, 0);
+        if (!is_sweep_size(n, MAX_TASKS)) continue;
+
+        // Every task ready: the decision scans the whole task list
+        virtual_time_advance(10000000);
+        bench_scheduler();
+
+        for (int a = 0; a < SCHED_ALGO_COUNT; a++) {
+            scheduler_set_algorithm((sched_algorithm_t)a);
+            snprintf(name, sizeof(name), "sched_run_once_%s", scheduler_algorithm_to_string((sched_algorithm_t)a));
+            bench_measure(name, n, bench_op_run_once, NULL);
+        }
+    }
+}
+
+// Fills the table with distinct integer parameters, the last one is the worst case lookup
+static void bench_config_table(void) {
+    for (int i = 0; i < MAX_PARAMS; i++) {
+        memset(&params[i], 0, sizeof(config_param_t));
+        params[i].key = i + 1;
+        params[i].type = PARAM_TYPE_INT;
+        params[i].value.int_value = i;
+        params[i].validation.int_range.min = 0;
+        params[i].validation.int_range.max = MAX_PARAMS;
+    }
+    bench_config();
+}
+
+int main(int argc, char **argv) {
+    unsigned groups = BENCH_GROUP_ALL;
+    if (argc >= 2) {
+        if (strcmp(argv[1], "SCHED") == 0) groups = BENCH_GROUP_SCHED;
+        else if (strcmp(argv[1], "TERM") == 0) groups = BENCH_GROUP_TERMINAL;
+        else if (strcmp(argv[1], "CONFIG") == 0) groups = BENCH_GROUP_CONFIG;
+        else if (strcmp(argv[1], "FMT") == 0) groups = BENCH_GROUP_FORMAT;
+        else {
+            fprintf(stderr, "Usage: %s [SCHED|TERM|CONFIG|FMT]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    initcalls();
+    bench_print_header();
+    bench_overhead();
+    if (groups & BENCH_GROUP_SCHED) bench_scheduler_sweep();
+    if (groups & BENCH_GROUP_TERMINAL) bench_terminal();
+    if (groups & BENCH_GROUP_CONFIG) bench_config_table();
+    if (groups & BENCH_GROUP_FORMAT) bench_format();
+    return 0;
+}
@@ -0,0 +1,17 @@
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#include "pico/time.h"
+
+static systick_hw_t systick;
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    return clk_index == clk_sys ? HOST_CLK_SYS_HZ : 0;
+}
+
+// Counts down from the reload value at clk_sys, following the virtual clock
+systick_hw_t *host_systick(void) {
+    uint64_t cycles = time_us_64() * (HOST_CLK_SYS_HZ / 1000000u);
+    uint32_t period = systick.rvr + 1;
+    systick.cvr = systick.rvr - (uint32_t)(cycles % period);
+    return &systick;
+}
@@ -0,0 +1,33 @@
+#include "flash.h"
+#include "config.h"
+
+// Flash storage emulated in RAM, erased flash reads as 0xFF
+static uint8_t storage[FLASH_CAPACITY_BYTES];
+static bool erased = false;
+
+static void erase_once(void) {
+    if (!erased) {
+        memset(storage, 0xFF, sizeof(storage));
+        erased = true;
+    }
+}
+
+int flash_storage_write(const void *data, size_t size) {
+    if (size > sizeof(storage)) return -1;
+    memset(storage, 0xFF, sizeof(storage));
+    memcpy(storage, data, size);
+    erased = true;
+    return 0;
+}
+
+int flash_storage_read(void *buffer, size_t size) {
+    if (size > sizeof(storage)) return -1;
+    erase_once();
+    memcpy(buffer, storage, size);
+    return 0;
+}
+
+size_t flash_storage_get_free_space() {
+    size_t used_space = sizeof(config_param_t) * MAX_PARAMS;
+    return FLASH_CAPACITY_BYTES > used_space ? FLASH_CAPACITY_BYTES - used_space : 0;
+}
@@ -0,0 +1,30 @@
+#include "hardware/gpio.h"
+#include "hardware/structs/sio.h"
+
+#define HOST_NUM_GPIOS 30
+
+sio_hw_t host_sio;
+
+// Every pin is unassigned after reset
+static enum gpio_function functions[HOST_NUM_GPIOS] = { [0 ... HOST_NUM_GPIOS - 1] = GPIO_FUNC_NULL };
+
+void gpio_init(uint gpio) {
+    host_sio.gpio_oe &= ~(1u << gpio);
+    gpio_set_function(gpio, GPIO_FUNC_SIO);
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    if (gpio < HOST_NUM_GPIOS) functions[gpio] = fn;
+}
+
+enum gpio_function gpio_get_function(uint gpio) {
+    return gpio < HOST_NUM_GPIOS ? functions[gpio] : GPIO_FUNC_NULL;
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    if (out) {
+        host_sio.gpio_oe |= 1u << gpio;
+    } else {
+        host_sio.gpio_oe &= ~(1u << gpio);
+    }
+}
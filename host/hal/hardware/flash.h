@@ -0,0 +1,11 @@
+#ifndef HOST_HARDWARE_FLASH_H
+#define HOST_HARDWARE_FLASH_H
+
+// Host flash: geometry of the Pico flash, contents emulated in RAM (see flash.c)
+
+#include "pico/types.h"
+
+#define FLASH_PAGE_SIZE   (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+
+#endif // HOST_HARDWARE_FLASH_H
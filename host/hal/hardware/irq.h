@@ -0,0 +1,16 @@
+#ifndef HOST_HARDWARE_IRQ_H
+#define HOST_HARDWARE_IRQ_H
+
+// Host interrupts: handlers are recorded and called by the peripheral models
+
+#include "pico/types.h"
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+
+// Calls the handler of an enabled interrupt
+void host_irq_raise(uint num);
+
+#endif // HOST_HARDWARE_IRQ_H
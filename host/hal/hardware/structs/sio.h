@@ -0,0 +1,26 @@
+#ifndef HOST_HARDWARE_STRUCTS_SIO_H
+#define HOST_HARDWARE_STRUCTS_SIO_H
+
+// Host SIO: plain registers, writes to the set/clear aliases are only stored
+
+#include "pico/types.h"
+
+typedef struct {
+    volatile uint32_t cpuid;
+    volatile uint32_t gpio_in;
+    volatile uint32_t gpio_hi_in;
+    uint32_t _pad0;
+    volatile uint32_t gpio_out;
+    volatile uint32_t gpio_set;
+    volatile uint32_t gpio_clr;
+    volatile uint32_t gpio_togl;
+    volatile uint32_t gpio_oe;
+    volatile uint32_t gpio_oe_set;
+    volatile uint32_t gpio_oe_clr;
+    volatile uint32_t gpio_oe_togl;
+} sio_hw_t;
+
+extern sio_hw_t host_sio;
+#define sio_hw (&host_sio)
+
+#endif // HOST_HARDWARE_STRUCTS_SIO_H
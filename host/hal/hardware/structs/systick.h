@@ -0,0 +1,18 @@
+#ifndef HOST_HARDWARE_STRUCTS_SYSTICK_H
+#define HOST_HARDWARE_STRUCTS_SYSTICK_H
+
+// Host SysTick: the current value is derived from the virtual clock on every access
+
+#include "pico/types.h"
+
+typedef struct {
+    volatile uint32_t csr;
+    volatile uint32_t rvr;
+    volatile uint32_t cvr;
+    volatile uint32_t calib;
+} systick_hw_t;
+
+systick_hw_t *host_systick(void);
+#define systick_hw (host_systick())
+
+#endif // HOST_HARDWARE_STRUCTS_SYSTICK_H
@@ -0,0 +1,64 @@
+#ifndef HOST_HARDWARE_UART_H
+#define HOST_HARDWARE_UART_H
+
+// Host UART: a 32-byte TX FIFO emptied at the baud rate of virtual time into a
+// capture buffer. Writes to the data register are taken when the model is next
+// polled, and polling a full FIFO costs one microsecond, so busy-wait loops make
+// progress. Interrupts are not raised: tests call the registered handler through
+// host_uart_run(), the way the TX interrupt would drain the driver's buffer.
+
+#include "pico/types.h"
+
+#define NUM_UARTS 2
+#define UART0_IRQ 20
+#define UART1_IRQ 21
+#define UART_UARTIMSC_TXIM_BITS 0x00000020u
+#define HOST_UART_FIFO_SIZE 32
+#define HOST_UART_DR_EMPTY  0xFFFFFFFFu // Data register value meaning "nothing written"
+
+typedef struct {
+    volatile uint32_t dr;
+    volatile uint32_t imsc;
+} uart_hw_t;
+
+typedef struct uart_inst {
+    uart_hw_t hw;
+    uint baud;
+    uint32_t fifo_level;         // Bytes in the TX FIFO
+    absolute_time_t last_drain;  // Time up to which the FIFO has been emptied
+    char *capture;               // Bytes sent on the wire, NULL to discard them
+    size_t capture_size;
+    size_t captured;             // Bytes sent, also counted beyond capture_size
+} uart_inst_t;
+
+extern uart_inst_t host_uarts[NUM_UARTS];
+#define uart0 (&host_uarts[0])
+#define uart1 (&host_uarts[1])
+
+static inline void hw_set_bits(volatile uint32_t *addr, uint32_t mask) {
+    *addr |= mask;
+}
+
+static inline void hw_clear_bits(volatile uint32_t *addr, uint32_t mask) {
+    *addr &= ~mask;
+}
+
+static inline uart_hw_t *uart_get_hw(uart_inst_t *uart) {
+    return &uart->hw;
+}
+
+static inline uint uart_get_index(uart_inst_t *uart) {
+    return uart == uart1 ? 1 : 0;
+}
+
+uint uart_init(uart_inst_t *uart, uint baudrate);
+bool uart_is_writable(uart_inst_t *uart);
+void uart_tx_wait_blocking(uart_inst_t *uart);
+
+// Captures the bytes sent by a UART
+void host_uart_capture(uart_inst_t *uart, char *buffer, size_t size);
+
+// Advances virtual time, calling the UART interrupt handlers as the FIFOs empty
+void host_uart_run(uint64_t us);
+
+#endif // HOST_HARDWARE_UART_H
@@ -0,0 +1,29 @@
+#ifndef HOST_HARDWARE_WATCHDOG_H
+#define HOST_HARDWARE_WATCHDOG_H
+
+// Host watchdog: scratch registers live in RAM and an expiry is counted instead of
+// resetting, so the simulator can report how often the supervisor would have fired.
+
+#include "pico/types.h"
+
+typedef struct {
+    volatile uint32_t ctrl;
+    volatile uint32_t load;
+    volatile uint32_t reason;
+    volatile uint32_t scratch[8];
+    volatile uint32_t tick;
+} watchdog_hw_t;
+
+extern watchdog_hw_t host_watchdog_hw;
+#define watchdog_hw (&host_watchdog_hw)
+
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug);
+void watchdog_update(void);
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms);
+bool watchdog_caused_reboot(void);
+bool watchdog_enable_caused_reboot(void);
+
+// Number of times the watchdog would have reset the system
+uint32_t host_watchdog_expiries(void);
+
+#endif // HOST_HARDWARE_WATCHDOG_H
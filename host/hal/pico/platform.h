@@ -0,0 +1,11 @@
+#ifndef HOST_PICO_PLATFORM_H
+#define HOST_PICO_PLATFORM_H
+
+#include "pico/types.h"
+
+// Host code always runs in thread mode
+static inline uint __get_current_exception(void) {
+    return 0;
+}
+
+#endif // HOST_PICO_PLATFORM_H
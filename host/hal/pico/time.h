@@ -0,0 +1,27 @@
+#ifndef HOST_PICO_TIME_H
+#define HOST_PICO_TIME_H
+
+// Virtual-time implementation of the subset of pico/time.h used by system/.
+// Time only moves when the host program advances it, so hours of scheduler
+// operation can be simulated in seconds and every run is reproducible.
+
+#include "pico/types.h"
+
+// Pico SDK time API
+absolute_time_t get_absolute_time(void);
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to);
+uint64_t to_us_since_boot(absolute_time_t t);
+absolute_time_t make_timeout_time_us(uint64_t us);
+absolute_time_t make_timeout_time_ms(uint32_t ms);
+absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us);
+bool time_reached(absolute_time_t t);
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+
+// Virtual clock control
+void virtual_time_advance(uint64_t us);
+void virtual_time_set(uint64_t us);
+
+#endif // HOST_PICO_TIME_H
@@ -0,0 +1,18 @@
+#ifndef HOST_PICO_TYPES_H
+#define HOST_PICO_TYPES_H
+
+// Host stand-in for the Pico SDK base types
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t; // Microseconds since (virtual) boot
+
+// Code placement attributes are meaningless on the host
+#define __not_in_flash_func(func_name) func_name
+#define __time_critical_func(func_name) func_name
+#define __not_in_flash(group)
+
+#endif // HOST_PICO_TYPES_H
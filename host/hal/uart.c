@@ -0,0 +1,98 @@
+#include <string.h>
+
+#include "hardware/uart.h"
+#include "hardware/irq.h"
+#include "pico/time.h"
+
+#define HOST_IRQ_COUNT 32
+
+uart_inst_t host_uarts[NUM_UARTS];
+
+static irq_handler_t irq_handlers[HOST_IRQ_COUNT];
+static bool irq_enabled[HOST_IRQ_COUNT];
+
+// -----------------------------------------------------------------------------
+// Interrupts
+// -----------------------------------------------------------------------------
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    if (num < HOST_IRQ_COUNT) irq_handlers[num] = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    if (num < HOST_IRQ_COUNT) irq_enabled[num] = enabled;
+}
+
+void host_irq_raise(uint num) {
+    if (num < HOST_IRQ_COUNT && irq_enabled[num] && irq_handlers[num]) irq_handlers[num]();
+}
+
+// -----------------------------------------------------------------------------
+// UART Model
+// -----------------------------------------------------------------------------
+
+// 10 bits per byte: start, 8 data, stop
+static uint64_t byte_time_us(const uart_inst_t *uart) {
+    return uart->baud ? 10000000ull / uart->baud : 1;
+}
+
+// Takes a written byte into the FIFO and removes the bytes sent since the last update
+static void uart_update(uart_inst_t *uart) {
+    uint64_t byte_us = byte_time_us(uart);
+    absolute_time_t now = get_absolute_time();
+    while (uart->fifo_level > 0 && absolute_time_diff_us(uart->last_drain, now) >= (int64_t)byte_us) {
+        uart->fifo_level--;
+        uart->last_drain += byte_us;
+    }
+    if (uart->fifo_level == 0) uart->last_drain = now;
+
+    if (uart->hw.dr != HOST_UART_DR_EMPTY && uart->fifo_level < HOST_UART_FIFO_SIZE) {
+        if (uart->capture && uart->captured < uart->capture_size) uart->capture[uart->captured] = (char)uart->hw.dr;
+        uart->captured++;
+        uart->fifo_level++;
+        uart->hw.dr = HOST_UART_DR_EMPTY;
+    }
+}
+
+uint uart_init(uart_inst_t *uart, uint baudrate) {
+    memset(uart, 0, sizeof(*uart));
+    uart->hw.dr = HOST_UART_DR_EMPTY;
+    uart->baud = baudrate;
+    uart->last_drain = get_absolute_time();
+    return baudrate;
+}
+
+bool uart_is_writable(uart_inst_t *uart) {
+    uart_update(uart);
+    if (uart->hw.dr == HOST_UART_DR_EMPTY && uart->fifo_level < HOST_UART_FIFO_SIZE) return true;
+    virtual_time_advance(1);
+    return false;
+}
+
+void uart_tx_wait_blocking(uart_inst_t *uart) {
+    uart_update(uart);
+    while (uart->hw.dr != HOST_UART_DR_EMPTY || uart->fifo_level > 0) {
+        virtual_time_advance(1);
+        uart_update(uart);
+    }
+}
+
+void host_uart_capture(uart_inst_t *uart, char *buffer, size_t size) {
+    uart->capture = buffer;
+    uart->capture_size = size;
+    uart->captured = 0;
+}
+
+void host_uart_run(uint64_t us) {
+    for (uint64_t i = 0; i < us; i++) {
+        virtual_time_advance(1);
+        for (int u = 0; u < NUM_UARTS; u++) {
+            uart_inst_t *uart = &host_uarts[u];
+            uart_update(uart);
+            // The TX interrupt fires when the FIFO drains to half
+            if ((uart->hw.imsc & UART_UARTIMSC_TXIM_BITS) && uart->fifo_level <= HOST_UART_FIFO_SIZE / 2) {
+                host_irq_raise(u ? UART1_IRQ : UART0_IRQ);
+            }
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#include "pico/time.h"
+
+// Current virtual time in microseconds
+static uint64_t virtual_now_us = 0;
+
+absolute_time_t get_absolute_time(void) {
+    return virtual_now_us;
+}
+
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+
+uint64_t to_us_since_boot(absolute_time_t t) {
+    return t;
+}
+
+absolute_time_t make_timeout_time_us(uint64_t us) {
+    return virtual_now_us + us;
+}
+
+absolute_time_t make_timeout_time_ms(uint32_t ms) {
+    return virtual_now_us + (uint64_t)ms * 1000;
+}
+
+absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) {
+    return t + us;
+}
+
+bool time_reached(absolute_time_t t) {
+    return virtual_now_us >= t;
+}
+
+uint64_t time_us_64(void) {
+    return virtual_now_us;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)virtual_now_us;
+}
+
+// Sleeping simply moves the virtual clock forward
+void sleep_us(uint64_t us) {
+    virtual_now_us += us;
+}
+
+void sleep_ms(uint32_t ms) {
+    virtual_now_us += (uint64_t)ms * 1000;
+}
+
+void virtual_time_advance(uint64_t us) {
+    virtual_now_us += us;
+}
+
+void virtual_time_set(uint64_t us) {
+    virtual_now_us = us;
+}
@@ -0,0 +1,47 @@
+#include "hardware/watchdog.h"
+#include "pico/time.h"
+
+watchdog_hw_t host_watchdog_hw;
+
+static bool enabled = false;         // Watchdog started
+static uint32_t timeout_us = 0;      // Configured timeout
+static absolute_time_t last_feed;    // Time of the last feed
+static uint32_t expiries = 0;        // Timeouts that would have reset the system
+
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug) {
+    (void)pause_on_debug;
+    enabled = true;
+    timeout_us = delay_ms * 1000u;
+    last_feed = get_absolute_time();
+}
+
+// Counts an expiry when the previous feed is older than the timeout
+void watchdog_update(void) {
+    absolute_time_t now = get_absolute_time();
+    if (enabled && absolute_time_diff_us(last_feed, now) > (int64_t)timeout_us) {
+        expiries++;
+    }
+    last_feed = now;
+}
+
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms) {
+    (void)pc;
+    (void)sp;
+    (void)delay_ms;
+}
+
+bool watchdog_caused_reboot(void) {
+    return false;
+}
+
+bool watchdog_enable_caused_reboot(void) {
+    return false;
+}
+
+// Includes the running interval since the last feed
+uint32_t host_watchdog_expiries(void) {
+    if (enabled && absolute_time_diff_us(last_feed, get_absolute_time()) > (int64_t)timeout_us) {
+        return expiries + 1;
+    }
+    return expiries;
+}
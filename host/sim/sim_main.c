@@ -0,0 +1,410 @@
+// Discrete-event simulator of the scheduler
+//
+// Compiles system/scheduler_core.c unchanged against the virtual-time HAL in host/hal.
+// Each simulated task advances the virtual clock by an execution time drawn from its
+// distribution, and idle periods jump straight to the next release, so hours of
+// operation are simulated in seconds. Every algorithm runs in its own process, which
+// gives each run a freshly initialized scheduler.
+//
+// Usage: sched_sim [-d seconds] [-a ALGORITHM|all] [-s seed] [-o overhead_us] [-t] taskset.txt
+//   -t dumps the event trace of the last simulated milliseconds (see tools/trace2perfetto.py)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "pico/time.h"
+#include "hardware/watchdog.h"
+#include "scheduler.h"
+#include "supervisor.h"
+#include "initcalls.h"
+#include "scheduler_auto.h"
+#include "trace.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define SIM_MAX_LINE        256
+#define SIM_NAME_SIZE       32
+#define SIM_DEFAULT_SECONDS 3600
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// Execution-time distributions
+typedef enum {
+    DIST_CONST,   // const <us>
+    DIST_UNIFORM, // uniform <min> <max>
+    DIST_NORMAL,  // normal <mean> <stddev>
+    DIST_EXP,     // exp <mean>
+    DIST_SPIKE    // spike <base> <spike> <percent>
+} sim_dist_t;
+
+// Synthetic task definition
+typedef struct {
+    char name[SIM_NAME_SIZE];
+    int priority;
+    int64_t interval;
+    sim_dist_t dist;
+    double a, b, c;
+    int64_t max_exec_budget;
+    int64_t max_release_gap;
+} sim_task_def_t;
+
+// Chain definition
+typedef struct {
+    char name[SIM_NAME_SIZE];
+    int head;
+    int64_t deadline;
+    int links[MAX_TASKS * MAX_TASKS][2];
+    int link_count;
+} sim_chain_def_t;
+
+// Summary of one run, sent from the child process to the parent
+typedef struct {
+    int algorithm;
+    long long dispatches;
+    long long misses;
+    long long max_jitter;
+    long long avg_jitter;
+    int utilization_permille;
+    long long chain_misses;
+    unsigned watchdog_expiries;
+    int supervisor_fault;
+    double wall_seconds;
+} sim_summary_t;
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static sim_task_def_t task_defs[MAX_TASKS];
+static int task_def_count = 0;
+static sim_chain_def_t chain_defs[MAX_CHAINS];
+static int chain_def_count = 0;
+static uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+static bool dump_trace = false;
+
+// -----------------------------------------------------------------------------
+// Random Execution Times
+// -----------------------------------------------------------------------------
+
+// xorshift64*: fast and reproducible across platforms
+static uint64_t rng_next(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1Dull;
+}
+
+// Uniform double in (0, 1)
+static double rng_unit(void) {
+    return ((rng_next() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+// Draws an execution time from the distribution of a task
+static int64_t sample_exec_time(const sim_task_def_t *d) {
+    double v;
+    switch (d->dist) {
+        case DIST_CONST:   v = d->a; break;
+        case DIST_UNIFORM: v = d->a + (d->b - d->a) * rng_unit(); break;
+        case DIST_NORMAL:  v = d->a + d->b * sqrt(-2.0 * log(rng_unit())) * cos(2.0 * M_PI * rng_unit()); break;
+        case DIST_EXP:     v = -d->a * log(rng_unit()); break;
+        case DIST_SPIKE:   v = (rng_unit() * 100.0 < d->c) ? d->b : d->a; break;
+        default:           v = 0; break;
+    }
+    return v < 0 ? 0 : (int64_t)(v + 0.5);
+}
+
+// Simulated task body: consumes virtual time
+static void sim_task(void) {
+    int index = scheduler_get_current_task();
+    if (index >= 0 && index < task_def_count) {
+        virtual_time_advance(sample_exec_time(&task_defs[index]));
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Task Set Parsing
+// -----------------------------------------------------------------------------
+
+static int find_task_def(const char *name) {
+    for (int i = 0; i < task_def_count; i++) {
+        if (strcmp(task_defs[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+static int find_chain_def(const char *name) {
+    for (int i = 0; i < chain_def_count; i++) {
+        if (strcmp(chain_defs[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+// Parses the distribution of a task line
+static int parse_dist(sim_task_def_t *d, const char *kind, int count, double a, double b, double c) {
+    d->a = a;
+    d->b = b;
+    d->c = c;
+    if (strcmp(kind, "const") == 0 && count >= 1) d->dist = DIST_CONST;
+    else if (strcmp(kind, "uniform") == 0 && count >= 2) d->dist = DIST_UNIFORM;
+    else if (strcmp(kind, "normal") == 0 && count >= 2) d->dist = DIST_NORMAL;
+    else if (strcmp(kind, "exp") == 0 && count >= 1) d->dist = DIST_EXP;
+    else if (strcmp(kind, "spike") == 0 && count >= 3) d->dist = DIST_SPIKE;
+    else return -1;
+    return 0;
+}
+
+// Loads a task set file
+//   task  <name> <priority> <interval_us> <dist> <params...>
+//   wdt   <task> <max_exec_us> <max_gap_us>
+//   chain <name> <head_task> <deadline_us>
+//   link  <chain> <from_task> <to_task>
+static int load_taskset(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    char line[SIM_MAX_LINE];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), f)) {
+        line_number++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char kind[16], s1[SIM_NAME_SIZE], s2[SIM_NAME_SIZE], s3[SIM_NAME_SIZE];
+        double a = 0, b = 0, c = 0;
+        long long n1 = 0, n2 = 0;
+        if (sscanf(line, "%15s", kind) != 1) continue;
+
+        int ok = 0;
+        if (strcmp(kind, "task") == 0 && task_def_count < MAX_TASKS) {
+            sim_task_def_t *d = &task_defs[task_def_count];
+            memset(d, 0, sizeof(*d));
+            int count = sscanf(line, "%*s %31s %d %lld %31s %lf %lf %lf", d->name, &d->priority, &n1, s1, &a, &b, &c);
+            d->interval = n1;
+            ok = count >= 5 && d->interval > 0 && parse_dist(d, s1, count - 4, a, b, c) == 0;
+            if (ok) task_def_count++;
+        } else if (strcmp(kind, "wdt") == 0) {
+            int i;
+            ok = sscanf(line, "%*s %31s %lld %lld", s1, &n1, &n2) == 3 && (i = find_task_def(s1)) >= 0;
+            if (ok) {
+                task_defs[i].max_exec_budget = n1;
+                task_defs[i].max_release_gap = n2;
+            }
+        } else if (strcmp(kind, "chain") == 0 && chain_def_count < MAX_CHAINS) {
+            sim_chain_def_t *ch = &chain_defs[chain_def_count];
+            memset(ch, 0, sizeof(*ch));
+            ok = sscanf(line, "%*s %31s %31s %lld", ch->name, s1, &n1) == 3 && (ch->head = find_task_def(s1)) >= 0;
+            ch->deadline = n1;
+            if (ok) chain_def_count++;
+        } else if (strcmp(kind, "link") == 0) {
+            int ci, from, to;
+            ok = sscanf(line, "%*s %31s %31s %31s", s1, s2, s3) == 3 &&
+                 (ci = find_chain_def(s1)) >= 0 && (from = find_task_def(s2)) >= 0 && (to = find_task_def(s3)) >= 0 &&
+                 chain_defs[ci].link_count < (int)(sizeof(chain_defs[ci].links) / sizeof(chain_defs[ci].links[0]));
+            if (ok) {
+                sim_chain_def_t *ch = &chain_defs[ci];
+                ch->links[ch->link_count][0] = from;
+                ch->links[ch->link_count][1] = to;
+                ch->link_count++;
+            }
+        }
+
+        if (!ok) {
+            fprintf(stderr, "%s:%d: invalid line\n", path, line_number);
+            fclose(f);
+            return -1;
+        }
+    }
+
+    fclose(f);
+    return task_def_count > 0 ? 0 : -1;
+}
+
+// -----------------------------------------------------------------------------
+// Simulation
+// -----------------------------------------------------------------------------
+
+// Registers the task set with the scheduler
+static int register_taskset(void) {
+    for (int i = 0; i < task_def_count; i++) {
+        sim_task_def_t *d = &task_defs[i];
+        if (scheduler_add_task(d->name, sim_task, d->priority, d->interval, TASK_RUNNING, 0) != SCHED_ERR_OK) return -1;
+        if (d->max_exec_budget || d->max_release_gap) {
+            scheduler_set_task_supervision(i, d->max_exec_budget, d->max_release_gap);
+        }
+    }
+    for (int c = 0; c < chain_def_count; c++) {
+        sim_chain_def_t *ch = &chain_defs[c];
+        int chain_id;
+        if (scheduler_chain_create(ch->name, ch->head, ch->deadline, &chain_id) != SCHED_ERR_OK) return -1;
+        for (int l = 0; l < ch->link_count; l++) {
+            if (scheduler_chain_link(chain_id, ch->links[l][0], ch->links[l][1]) != SCHED_ERR_OK) return -1;
+        }
+    }
+    return 0;
+}
+
+// Returns the time until the next periodic release, at least 1 us
+static int64_t time_to_next_release(void) {
+    absolute_time_t now = get_absolute_time();
+    int64_t next = INT64_MAX;
+    for (int i = 0; i < scheduler_get_task_count(); i++) {
+        const task_t *t = scheduler_get_task(i);
+        if (t->state == TASK_PAUSED) continue;
+        if (t->chain_id != CHAIN_NONE && scheduler_get_chain(t->chain_id)->head != i) continue;
+        int64_t until = absolute_time_diff_us(now, t->last_execution) + t->interval;
+        if (until < next) next = until;
+    }
+    return next < 1 ? 1 : next;
+}
+
+// Runs the scheduler on virtual time and fills the summary
+static void simulate(sched_algorithm_t algorithm, int64_t duration_us, int64_t overhead_us, sim_summary_t *summary) {
+    struct timespec wall_start, wall_end;
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+
+    scheduler_set_algorithm(algorithm);
+    scheduler_start();
+    while ((int64_t)to_us_since_boot(get_absolute_time()) < duration_us) {
+        int dispatched = scheduler_run_once();
+        if (dispatched < 0) {
+            virtual_time_advance(time_to_next_release());
+        } else {
+            virtual_time_advance(overhead_us);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &wall_end);
+
+    memset(summary, 0, sizeof(*summary));
+    summary->algorithm = algorithm;
+    long long total_jitter = 0;
+    for (int i = 0; i < scheduler_get_task_count(); i++) {
+        const task_t *t = scheduler_get_task(i);
+        summary->dispatches += t->exec_count;
+        summary->misses += t->deadline_misses;
+        total_jitter += t->total_jitter;
+        if (t->max_jitter > summary->max_jitter) summary->max_jitter = t->max_jitter;
+    }
+    for (int c = 0; c < scheduler_get_chain_count(); c++) {
+        summary->chain_misses += scheduler_get_chain(c)->deadline_misses;
+    }
+    summary->avg_jitter = summary->dispatches ? total_jitter / summary->dispatches : 0;
+    summary->utilization_permille = (int)(scheduler_get_busy_time() * 1000 / to_us_since_boot(get_absolute_time()));
+    summary->watchdog_expiries = host_watchdog_expiries();
+    summary->supervisor_fault = !supervisor_is_healthy();
+    summary->wall_seconds = (wall_end.tv_sec - wall_start.tv_sec) + (wall_end.tv_nsec - wall_start.tv_nsec) / 1e9;
+}
+
+// Runs one algorithm in a child process, prints its report and returns its summary
+static int run_algorithm(sched_algorithm_t algorithm, int64_t duration_us, int64_t overhead_us, uint64_t seed, sim_summary_t *summary) {
+    int fds[2];
+    if (pipe(fds) != 0) return -1;
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) return -1;
+
+    if (pid == 0) {
+        close(fds[0]);
+        rng_state = seed ? seed : 1;
+        sim_summary_t s;
+        initcalls();
+        if (register_taskset() != 0) {
+            fprintf(stderr, "Invalid task set for the scheduler (limits or chain topology)\n");
+            _exit(1);
+        }
+        simulate(algorithm, duration_us, overhead_us, &s);
+
+        printf("\n===== %s =====\n", scheduler_algorithm_to_string(algorithm));
+        scheduler_print_task_list();
+        if (scheduler_get_chain_count() > 0) scheduler_print_chain_list();
+        if (algorithm == SCHED_ALGO_AUTO) scheduler_auto_print_log();
+        if (dump_trace) trace_dump();
+        fflush(stdout);
+
+        ssize_t written = write(fds[1], &s, sizeof(s));
+        _exit(written == sizeof(s) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    ssize_t got = read(fds[0], summary, sizeof(*summary));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return (got == sizeof(*summary) && WIFEXITED(status) && WEXITSTATUS(status) == 0) ? 0 : -1;
+}
+
+// Parses an algorithm name, returns -1 for "all"
+static int parse_algorithm(const char *name) {
+    if (strcmp(name, "all") == 0) return -1;
+    for (int a = 0; a <= SCHED_ALGO_AUTO; a++) {
+        if (strcmp(name, scheduler_algorithm_to_string((sched_algorithm_t)a)) == 0) return a;
+    }
+    return -2;
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [-d seconds] [-a ALGORITHM|all] [-s seed] [-o overhead_us] [-t] taskset.txt\n", program);
+}
+
+int main(int argc, char **argv) {
+    double seconds = SIM_DEFAULT_SECONDS;
+    int algorithm = -1;
+    uint64_t seed = 1;
+    int64_t overhead_us = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:a:s:o:th")) != -1) {
+        switch (opt) {
+            case 'd': seconds = atof(optarg); break;
+            case 'a': algorithm = parse_algorithm(optarg); break;
+            case 's': seed = strtoull(optarg, NULL, 0); break;
+            case 'o': overhead_us = atoll(optarg); break;
+            case 't': dump_trace = true; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (optind >= argc || algorithm < -1 || seconds <= 0 || overhead_us < 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (load_taskset(argv[optind]) != 0) {
+        return 1;
+    }
+
+    int64_t duration_us = (int64_t)(seconds * 1e6);
+    sim_summary_t summaries[SCHED_ALGO_AUTO + 1];
+    int run_count = 0;
+
+    for (int a = 0; a <= SCHED_ALGO_AUTO; a++) {
+        if (algorithm >= 0 && a != algorithm) continue;
+        if (run_algorithm((sched_algorithm_t)a, duration_us, overhead_us, seed, &summaries[run_count]) != 0) {
+            fprintf(stderr, "Simulation of %s failed\n", scheduler_algorithm_to_string((sched_algorithm_t)a));
+            return 1;
+        }
+        run_count++;
+    }
+
+    printf("\n===== Summary: %.0f s simulated, seed %llu =====\n", seconds, (unsigned long long)seed);
+    printf("%-25s %-12s %-10s %-10s %-10s %-8s %-10s %-8s %-8s\n",
+           "Algorithm", "Dispatches", "Misses", "MaxJitter", "AvgJitter", "CPU%", "ChainMiss", "WdtExp", "Wall(s)");
+    for (int i = 0; i < run_count; i++) {
+        const sim_summary_t *s = &summaries[i];
+        printf("%-25s %-12lld %-10lld %-10lld %-10lld %-8.1f %-10lld %-8u %-8.2f%s\n",
+               scheduler_algorithm_to_string((sched_algorithm_t)s->algorithm),
+               s->dispatches, s->misses, s->max_jitter, s->avg_jitter,
+               s->utilization_permille / 10.0, s->chain_misses, s->watchdog_expiries, s->wall_seconds,
+               s->supervisor_fault ? " (supervisor fault)" : "");
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Checks system/fmt.c against the host C library
+//
+// Fixed cases cover flags, widths, lengths and the %f corners (ties, values just
+// off a tie, -0.0, carries into the integer part); a seeded sweep then compares
+// %.<p>f for p = 0..FMT_MAX_PRECISION over random doubles. glibc rounds %f from
+// the exact binary value, as fmt does, so the strings must be identical.
+//
+// Usage: fmt_test [values]
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fmt.h"
+
+#define SWEEP_VALUES 1000000
+
+static int failures = 0;
+static int checks = 0;
+
+// Formats with both and reports a difference
+#define CHECK(...) do { \
+    char ours[256], libc[256]; \
+    int ours_length = fmt_snprintf(ours, sizeof(ours), __VA_ARGS__); \
+    int libc_length = snprintf(libc, sizeof(libc), __VA_ARGS__); \
+    checks++; \
+    if (ours_length != libc_length || strcmp(ours, libc) != 0) { \
+        if (failures++ < 20) printf("FAIL: %-32s fmt \"%s\" libc \"%s\"\n", #__VA_ARGS__, ours, libc); \
+    } \
+} while (0)
+
+// xorshift64, a fixed seed keeps the sweep reproducible
+static uint64_t random_state = 88172645463325252ull;
+static uint64_t random_next(void) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return random_state;
+}
+
+static void check_fixed_cases(void) {
+    CHECK("%d|%d|%d|%u", 0, -1, INT_MIN, UINT_MAX);
+    CHECK("%5d|%-5d|%05d|%+d|% d", 42, 42, 42, 5, 5);
+    CHECK("%x %X %#x %#o %o %#.3o", 255, 255, 255, 8, 8, 8);
+    CHECK("%lld %lld %llu", (long long)INT64_MIN, (long long)INT64_MAX, (unsigned long long)UINT64_MAX);
+    CHECK("%llx %020lld", 0x123456789abcdefULL, -123456789012LL);
+    CHECK("%s|%10s|%-10s|%.3s|%-10.8s|", "abc", "abc", "abc", "abcdef", "abcdefghijk");
+    CHECK("%c%c %% %zu %hhu %hd", 'a', 'b', (size_t)123, (unsigned char)255, (short)-3);
+    CHECK("%*d|%-*d|%.*f|%.0d|%.3d", 6, 7, 6, 7, 3, 1.23456, 0, 5);
+    CHECK("%p", (void *)0x1234);
+
+    // Exact ties round to even, values just off a tie to the nearest
+    CHECK("%.0f %.0f %.0f %.0f", 0.5, 1.5, 2.5, -0.5);
+    CHECK("%.2f %.2f %.1f %.1f %.1f", 0.125, 0.375, 0.25, 0.05, 0.15);
+    CHECK("%.2f %.2f %.3f %.2f", -0.005, 0.135, 0.0005, 1.005);
+    CHECK("%.2f %.2f %+.1f % .1f", -0.0, -0.001, 2.25, 2.35);
+    CHECK("%.9f %.9f %.9f", 1.000000001, 0.9999999995, 1e-10);
+    CHECK("%f %8.3f|%-8.3f|%08.3f", 1.0 / 3, 2.5, -2.5, -1.5);
+    CHECK("%.2f %.2f %.1f %5.1f%%", 1e9, 4294967296.5, 1e18, 99.95);
+    CHECK("%.3f %.9f", 5e-324, 2.2250738585072014e-308);
+}
+
+static void check_sweep(long values) {
+    for (long i = 0; i < values; i++) {
+        uint64_t bits = random_next();
+        double value;
+        switch (i % 4) {
+            case 0: memcpy(&value, &bits, sizeof(value)); break;              // Any bit pattern
+            case 1: value = (double)(bits % 100000) / 1000.0; break;          // Short decimals, near ties
+            case 2: value = (double)(bits % 2000001) / 200.0 - 5000.0; break; // Halves of the last digit
+            default: value = (double)(int64_t)bits / 1e6; break;
+        }
+        if (value != value || value >= 1.8e19 || value <= -1.8e19) continue; // NaN, beyond the integer part
+        int precision = (int)(random_next() % (FMT_MAX_PRECISION + 1));
+        CHECK("%.*f", precision, value);
+    }
+}
+
+int main(int argc, char **argv) {
+    long values = argc > 1 ? atol(argv[1]) : SWEEP_VALUES;
+    check_fixed_cases();
+    check_sweep(values);
+    printf("%d of %d checks differ from libc\n", failures, checks);
+    return failures ? 1 : 0;
+}
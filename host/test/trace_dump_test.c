@@ -0,0 +1,120 @@
+// Checks that a full TRACE DUMP leaves the UART intact
+//
+// The ring is filled, dumped once into memory as the reference and then through
+// the buffered UART driver (platform/uart_tx.c) on the host UART model at
+// 115200 baud, under the default DROP policy. Run in steps the way the terminal
+// task runs a report, the dump must arrive whole although it is four times the
+// TX buffer; printed in one call it must lose part of it, or the check proves nothing.
+//
+// Usage: trace_dump_test
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "hardware/uart.h"
+#include "pico/time.h"
+#include "config.h"
+#include "fmt.h"
+#include "initcalls.h"
+#include "scheduler.h"
+#include "trace.h"
+#include "uart_tx.h"
+
+#define DUMP_CAPACITY (64 * 1024)
+#define REPORT_CHUNK  1024 // TERMINAL_REPORT_CHUNK of app/task_terminal.h
+#define REPORT_RUN_US 2000 // Terminal task interval while a report runs
+
+// Not used by the test, config.c expects the table
+const config_param_t default_params[MAX_PARAMS] = {{0}};
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static char expected[DUMP_CAPACITY];
+static size_t expected_length = 0;
+static char wire[DUMP_CAPACITY];
+
+// -----------------------------------------------------------------------------
+// Outputs
+// -----------------------------------------------------------------------------
+
+static void memory_output(const char *data, size_t length) {
+    if (expected_length + length <= sizeof(expected)) memcpy(&expected[expected_length], data, length);
+    expected_length += length;
+}
+
+static void uart_output(const char *data, size_t length) {
+    uart_tx_write(uart0, data, length);
+}
+
+static void task_idle(void) {
+}
+
+// Dumps the trace through the UART, in steps or in one call, and returns the bytes that reached the wire
+static size_t dump_to_uart(bool steps) {
+    host_uart_capture(uart0, wire, sizeof(wire));
+    fmt_set_output(uart_output);
+    if (steps) {
+        trace_dump_t dump;
+        bool more = true;
+        trace_dump_begin(&dump);
+        while (more) {
+            while (more && uart_tx_space(uart0) >= REPORT_CHUNK) more = trace_dump_step(&dump);
+            host_uart_run(REPORT_RUN_US); // The TX interrupt sends until the next run
+        }
+    } else {
+        trace_dump();
+    }
+    host_uart_run(2 * 1000 * 1000); // Lets the TX interrupt send what is still buffered
+    fmt_set_output(NULL);
+    return uart0->captured;
+}
+
+int main(void) {
+    initcalls();
+    scheduler_add_task("sense", task_idle, 1, 1000, TASK_RUNNING, 0);
+    scheduler_add_task("act", task_idle, 1, 1000, TASK_RUNNING, 0);
+
+    // More events than the ring holds, so the dump is as large as it gets
+    trace_start();
+    for (uint32_t i = 0; i < 3 * TRACE_BUFFER_SIZE; i++) {
+        virtual_time_advance(37);
+        trace_event(i % 2 ? TRACE_TASK_END : TRACE_TASK_START, (uint8_t)(i / 2 % 2), (uint16_t)i);
+    }
+
+    fmt_set_output(memory_output);
+    trace_dump();
+    fmt_set_output(NULL);
+    if (expected_length > sizeof(expected) || expected_length <= UART_TX_BUFFER_SIZE) {
+        printf("FAIL: reference dump of %zu bytes does not exercise the %d-byte TX buffer\n", expected_length, UART_TX_BUFFER_SIZE);
+        return 1;
+    }
+
+    uart_init(uart0, 115200);
+    uart_tx_init(uart0);
+    int failures = 0;
+
+    if (uart_tx_get_policy() != UART_TX_DROP) {
+        printf("FAIL: default policy is %s, output must never wait for the link\n", uart_tx_policy_to_string(uart_tx_get_policy()));
+        failures++;
+    }
+
+    size_t sent = dump_to_uart(true);
+    if (sent != expected_length || memcmp(wire, expected, expected_length) != 0) {
+        printf("FAIL: stepped dump delivered %zu of %zu bytes%s\n", sent, expected_length,
+               sent == expected_length ? " with different content" : "");
+        failures++;
+    } else {
+        printf("Stepped: %zu bytes intact\n", sent);
+    }
+
+    sent = dump_to_uart(false);
+    if (sent >= expected_length) {
+        printf("FAIL: one-call dump delivered all %zu bytes, the UART model does not fill the buffer\n", sent);
+        failures++;
+    } else {
+        printf("One call: %zu of %zu bytes, truncated as expected\n", sent, expected_length);
+    }
+    return failures ? 1 : 0;
+}
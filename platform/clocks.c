@@ -0,0 +1,64 @@
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/uart.h"
+#include "clocks.h"
+#include "initcalls.h"
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static clock_listener_t listeners[CLOCKS_MAX_LISTENERS]; // Drivers depending on clk_sys
+static int listener_count = 0;
+
+// Notifies all listeners of the current system clock
+static void notify_listeners(void) {
+    uint32_t sys_hz = clock_get_hz(clk_sys);
+    for (int i = 0; i < listener_count; i++) {
+        listeners[i](sys_hz);
+    }
+}
+
+// Moves clk_peri to PLL_USB
+// The SDK boots with clk_peri on clk_sys; set_sys_clock_khz() already moves it to
+// the fixed 48 MHz PLL_USB output, so only the boot clock needs routing. The stdio
+// UART was set up for clk_sys and no listener exists yet: its divisor is restored here.
+void clocks_init(void) {
+    uart_tx_wait_blocking(uart0); // Do not garble the characters being sent
+    clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB, CLOCKS_PERI_HZ, CLOCKS_PERI_HZ);
+    uart_set_baudrate(uart0, PICO_DEFAULT_UART_BAUD_RATE);
+    notify_listeners();
+}
+REGISTER_INITCALL_LEVEL(clocks_init, INITCALL_EARLY);
+
+// Changes the system clock and notifies the listeners
+// Pending UART output is flushed first and every driver depending on clk_sys
+// (PWM dividers, baud rates) is reconfigured. clk_peri stays on PLL_USB.
+bool clocks_set_sys_khz(uint32_t khz) {
+    if (khz == clocks_get_sys_khz()) {
+        return true;
+    }
+
+    uart_tx_wait_blocking(uart0);
+    if (!set_sys_clock_khz(khz, false)) {
+        return false; // Frequency not achievable with the system PLL
+    }
+    notify_listeners();
+    return true;
+}
+
+// Returns the current system clock in kHz
+uint32_t clocks_get_sys_khz(void) {
+    return clock_get_hz(clk_sys) / 1000;
+}
+
+// Registers a clock change listener
+bool clocks_register_listener(clock_listener_t listener) {
+    if (listener == NULL || listener_count >= CLOCKS_MAX_LISTENERS) {
+        return false;
+    }
+    listeners[listener_count++] = listener;
+    listener(clock_get_hz(clk_sys));
+    return true;
+}
@@ -0,0 +1,33 @@
+#ifndef CLOCKS_H
+#define CLOCKS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define CLOCKS_PERI_HZ          (48 * 1000 * 1000) // clk_peri runs from PLL_USB, independent of clk_sys
+#define CLOCKS_MAX_LISTENERS    8                  // Maximum number of clock change listeners
+
+// Callback invoked after the system clock has changed
+typedef void (*clock_listener_t)(uint32_t sys_hz);
+
+// -----------------------------------------------------------------------------
+// Clock API
+// -----------------------------------------------------------------------------
+
+// Moves clk_peri to PLL_USB so UART baud rates no longer depend on clk_sys (registered as initcall)
+void clocks_init(void);
+
+// Changes the system clock and notifies the listeners. Returns false if the frequency is not achievable.
+bool clocks_set_sys_khz(uint32_t khz);
+
+// Returns the current system clock in kHz
+uint32_t clocks_get_sys_khz(void);
+
+// Registers a callback invoked after every system clock change.
+// The callback is also invoked immediately with the current frequency.
+bool clocks_register_listener(clock_listener_t listener);
+
+#endif // CLOCKS_H
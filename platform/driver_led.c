@@ -1,5 +1,6 @@
 #include "pico/stdlib.h"
 #include "hardware/pwm.h"
+#include "hardware/clocks.h"
 #include "driver_led.h"
 
 // Hardware Abstraction Layer (HAL) for LED control on Raspberry Pi Pico
@@ -14,6 +15,7 @@ void led_init(DriverLed *driver, int gpio_pin) {
     uint slice_num = pwm_gpio_to_slice_num(driver->led_pin);
     pwm_config config = pwm_get_default_config();
     pwm_config_set_wrap(&config, 255); // 8-bit resolution
+    pwm_config_set_clkdiv(&config, (float)clock_get_hz(clk_sys) / LED_PWM_COUNTER_HZ); // Clock independent frequency
     pwm_init(slice_num, &config, true);
     pwm_set_gpio_level(driver->led_pin, 0); // Start with LED off
     pwm_set_enabled(slice_num, true);
@@ -74,6 +76,13 @@ void led_process_fade(DriverLed *driver) {
     }
 }
 
+// Recomputes the PWM divider after a system clock change
+// The counter keeps running at LED_PWM_COUNTER_HZ, so the PWM frequency does not change.
+void led_update_clock(DriverLed *driver, uint32_t sys_hz) {
+    uint slice_num = pwm_gpio_to_slice_num(driver->led_pin);
+    pwm_set_clkdiv(slice_num, (float)sys_hz / LED_PWM_COUNTER_HZ);
+}
+
 // Initializes and binds LED driver functions
 void initialize_driver_led(DriverLed *driver, int gpio_pin) {
     driver->init = led_init;
@@ -83,6 +92,7 @@ void initialize_driver_led(DriverLed *driver, int gpio_pin) {
     driver->fade_in = led_fade_in;
     driver->fade_out = led_fade_out;
     driver->process_fade = led_process_fade;
+    driver->update_clock = led_update_clock;
 
     driver->init(driver, gpio_pin);
 }
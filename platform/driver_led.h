@@ -5,6 +5,8 @@
 #include <time.h>
 #include <pico/types.h>
 
+#define LED_PWM_COUNTER_HZ 1000000 // PWM counter rate, kept constant across system clock changes
+
 // Enum to define LED states
 typedef enum {
     LED_OFF = 0,
@@ -35,6 +37,7 @@ typedef struct DriverLed {
     void (*fade_out)(struct DriverLed *driver, uint32_t duration_ms); // Fades LED out
     void (*process_fade)(struct DriverLed *driver); // Processes ongoing fades
     void (*set_brightness)(struct DriverLed *driver, uint8_t brightness); // Sets specific brightness
+    void (*update_clock)(struct DriverLed *driver, uint32_t sys_hz); // Keeps the PWM frequency after a clock change
 } DriverLed;
 
 // Initializes the LED driver
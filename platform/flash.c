@@ -17,6 +17,28 @@ int flash_storage_read(void *buffer, size_t size) {
     return 0;
 }
 
+// Erases sectors, offset and size must be multiples of FLASH_SECTOR_SIZE
+int flash_region_erase(uint32_t offset, size_t size) {
+    if (offset % FLASH_SECTOR_SIZE || size % FLASH_SECTOR_SIZE) return -1;
+    uint32_t ints = save_and_disable_interrupts();
+    flash_range_erase(offset, size);
+    restore_interrupts(ints);
+    return 0;
+}
+
+// Programs pages, offset and size must be multiples of FLASH_PAGE_SIZE
+int flash_region_program(uint32_t offset, const void *data, size_t size) {
+    if (offset % FLASH_PAGE_SIZE || size % FLASH_PAGE_SIZE) return -1;
+    uint32_t ints = save_and_disable_interrupts();
+    flash_range_program(offset, data, size);
+    restore_interrupts(ints);
+    return 0;
+}
+
+const void *flash_region_map(uint32_t offset) {
+    return (const void *)(uintptr_t)(XIP_BASE + offset);
+}
+
 // Calculates the remaining free space in flash storage
 size_t flash_storage_get_free_space() {
     size_t used_space = sizeof(config_param_t) * MAX_PARAMS; // Calculate used space
@@ -15,6 +15,10 @@
 // Offset for application data storage
 #define FLASH_TARGET_OFFSET (256 * 1024)
 
+// Flight recorder ring, after the parameter sector
+#define FLASH_RECORDER_OFFSET  (FLASH_TARGET_OFFSET + FLASH_SECTOR_SIZE)
+#define FLASH_RECORDER_SECTORS 8
+
 // Writes data to flash storage
 int flash_storage_write(const void *data, size_t size);
 
@@ -24,4 +28,13 @@ int flash_storage_read(void *buffer, size_t size);
 // Retrieves the available free space in flash storage
 size_t flash_storage_get_free_space();
 
+// Erases whole sectors at a flash offset (about 50 ms per sector, interrupts disabled)
+int flash_region_erase(uint32_t offset, size_t size);
+
+// Programs whole pages at a flash offset, previously erased (about 1 ms per page)
+int flash_region_program(uint32_t offset, const void *data, size_t size);
+
+// Returns the memory-mapped address of a flash offset
+const void *flash_region_map(uint32_t offset);
+
 #endif // FLASH_H
@@ -6,7 +6,7 @@ const HardwareConfig hardware_v1 = {
     .uart1_cts_pin = 2, // CTS pin for UART1
     .uart1_tx_pin = 4,  // TX pin for UART1
     .uart1_rx_pin = 5,  // RX pin for UART1
-    .uart1_baud = 5000000, // Baud rate for UART1
+    .uart1_baud = 3000000, // Baud rate for UART1 (at most clk_peri / 16 = 3 Mbaud)
 
     .uart0_rts_pin = -1,
     .uart0_cts_pin = -1,
@@ -16,7 +16,8 @@ const HardwareConfig hardware_v1 = {
 
     .led_pin = 25, // LED GPIO pin
     .esp32_rst_pin = 6, // ESP32 reset pin
-    .extra_gpio1 = 26 // Additional GPIO pin
+    .extra_gpio1 = 26, // Additional GPIO pin (PWM of LED 2)
+    .trace_pin = 22 // Free header pin for the GPIO trace
 };
 
 // Hardware configuration for version V2
@@ -35,7 +36,8 @@ const HardwareConfig hardware_v2 = {
 
     .led_pin = -1,
     .esp32_rst_pin = -1,
-    .extra_gpio1 = -1
+    .extra_gpio1 = -1,
+    .trace_pin = -1
 };
 
 // Pointer to the current hardware configuration
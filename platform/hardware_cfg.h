@@ -18,6 +18,7 @@ typedef struct {
     int led_pin;
     int esp32_rst_pin;
     int extra_gpio1;
+    int trace_pin; // Default GPIO of the PIN command, not used by any driver
 } HardwareConfig;
 
 // Hardware configurations declarations
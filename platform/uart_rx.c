@@ -0,0 +1,107 @@
+#include "hardware/dma.h"
+
+#include "uart_rx.h"
+#include "metrics.h"
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+typedef struct {
+    uint8_t *ring;
+    int dma_channel;         // -1 until uart_rx_init
+    uint32_t dma_base;       // Bytes received by the previous DMA runs
+    uint32_t read;           // Bytes consumed, wraps like the DMA count
+    uint32_t bytes;          // Bytes consumed
+    uint32_t overruns;       // Bytes lost to a full ring
+} uart_rx_state_t;
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static uint8_t rx_rings[NUM_UARTS][UART_RX_RING_SIZE] __attribute__((aligned(UART_RX_RING_SIZE)));
+static uart_rx_state_t rx_state[NUM_UARTS] = { { .dma_channel = -1 }, { .dma_channel = -1 } };
+
+static void collect_rx_bytes(metrics_sink_t *sink) {
+    for (int i = 0; i < NUM_UARTS; i++) {
+        if (rx_state[i].dma_channel >= 0) metrics_sample(sink, i ? "uart1" : "uart0", rx_state[i].bytes);
+    }
+}
+
+static void collect_rx_overruns(metrics_sink_t *sink) {
+    for (int i = 0; i < NUM_UARTS; i++) {
+        if (rx_state[i].dma_channel >= 0) metrics_sample(sink, i ? "uart1" : "uart0", rx_state[i].overruns);
+    }
+}
+
+static metric_t metric_rx_bytes = { .name = "uart_rx_bytes_total", .help = "Bytes received on each terminal UART", .type = METRIC_COUNTER,
+                                    .label = "uart", .collect = collect_rx_bytes };
+static metric_t metric_rx_overruns = { .name = "uart_rx_ring_overruns_total", .help = "Bytes lost because the reader fell behind the DMA ring",
+                                       .type = METRIC_COUNTER, .label = "uart", .collect = collect_rx_overruns };
+
+// -----------------------------------------------------------------------------
+// DMA Receive
+// -----------------------------------------------------------------------------
+
+// Total bytes written by the DMA, wraps at 2^32
+static uint32_t rx_received(const uart_rx_state_t *s) {
+    return s->dma_base + (UART_RX_DMA_COUNT - dma_channel_hw_addr(s->dma_channel)->transfer_count);
+}
+
+// Starts a DMA run from the UART data register into the ring
+static void rx_dma_start(uart_inst_t *uart, uart_rx_state_t *s) {
+    dma_channel_config c = dma_channel_get_default_config(s->dma_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, UART_RX_RING_BITS);
+    channel_config_set_dreq(&c, uart_get_dreq(uart, false));
+    dma_channel_configure(s->dma_channel, &c, s->ring, &uart_get_hw(uart)->dr, UART_RX_DMA_COUNT, true);
+}
+
+// -----------------------------------------------------------------------------
+// DMA Receive API
+// -----------------------------------------------------------------------------
+
+void uart_rx_init(uart_inst_t *uart) {
+    uart_rx_state_t *s = &rx_state[uart_get_index(uart)];
+    bool first = rx_state[0].dma_channel < 0 && rx_state[1].dma_channel < 0;
+
+    s->ring = rx_rings[uart_get_index(uart)];
+    s->dma_channel = dma_claim_unused_channel(true);
+    uart_set_irq_enables(uart, false, false);
+    uart_get_hw(uart)->dmacr |= UART_UARTDMACR_RXDMAE_BITS;
+    rx_dma_start(uart, s);
+
+    if (first) {
+        metrics_register(&metric_rx_bytes);
+        metrics_register(&metric_rx_overruns);
+    }
+}
+
+uint32_t uart_rx_pending(uart_inst_t *uart) {
+    const uart_rx_state_t *s = &rx_state[uart_get_index(uart)];
+    return s->dma_channel < 0 ? 0 : rx_received(s) - s->read;
+}
+
+int uart_rx_getc(uart_inst_t *uart, bool *overrun) {
+    uart_rx_state_t *s = &rx_state[uart_get_index(uart)];
+    if (s->dma_channel < 0) return -1;
+
+    // A run ends after 2^32 bytes, the UART FIFO holds the bytes arriving meanwhile
+    if (!dma_channel_is_busy(s->dma_channel)) {
+        s->dma_base += UART_RX_DMA_COUNT;
+        rx_dma_start(uart, s);
+    }
+
+    uint32_t received = rx_received(s);
+    uint32_t pending = received - s->read;
+    if (pending == 0) return -1;
+    if (pending > UART_RX_RING_SIZE) { // The DMA overwrote unread bytes
+        s->overruns += pending - UART_RX_RING_SIZE;
+        s->read = received - UART_RX_RING_SIZE;
+        *overrun = true;
+    }
+
+    s->bytes++;
+    return s->ring[s->read++ & (UART_RX_RING_SIZE - 1)];
+}
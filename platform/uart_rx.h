@@ -0,0 +1,35 @@
+#ifndef UART_RX_H
+#define UART_RX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "hardware/uart.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define UART_RX_RING_BITS 8                       // Ring of 256 bytes per UART
+#define UART_RX_RING_SIZE (1u << UART_RX_RING_BITS)
+#define UART_RX_DMA_COUNT 0xffffffffu             // Transfers per DMA run, re-armed by uart_rx_getc when it ends
+
+// -----------------------------------------------------------------------------
+// DMA Receive API
+// -----------------------------------------------------------------------------
+// A DMA channel paced by the UART DREQ copies every received byte into a ring
+// whose write address wraps in hardware, so reception needs no interrupt. The
+// reader polls the DMA transfer count; if it falls more than a ring behind, the
+// overwritten bytes are skipped and counted.
+
+// Starts reception on a configured UART
+void uart_rx_init(uart_inst_t *uart);
+
+// Returns the next received byte, or -1 if none
+// *overrun is set when bytes were lost since the previous call.
+int uart_rx_getc(uart_inst_t *uart, bool *overrun);
+
+// Returns the bytes received and not read yet
+uint32_t uart_rx_pending(uart_inst_t *uart);
+
+#endif // UART_RX_H
@@ -0,0 +1,220 @@
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "pico/platform.h"
+#include "pico/time.h"
+
+#include "uart_tx.h"
+#include "irq_account.h"
+#include "metrics.h"
+#include "hot_path.h"
+#include "fmt.h"
+
+_Static_assert((UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1)) == 0, "UART_TX_BUFFER_SIZE must be a power of two");
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+typedef struct {
+    uart_inst_t *uart;           // NULL until uart_tx_init
+    uint irq;
+    char *ring;
+    uint32_t head;               // Bytes queued, wraps
+    volatile uint32_t tail;      // Bytes moved to the UART FIFO, wraps
+    uint32_t high_water;         // Largest buffer use
+    uint32_t bytes;              // Bytes queued
+    uint32_t dropped;            // Bytes discarded by a full buffer
+    uint32_t overwritten;        // Unsent bytes overwritten by newer output
+    uint32_t timeouts;           // Blocking writes that timed out
+    bool stalled;                // A blocking write timed out, writes do not wait until one fits again
+} uart_tx_state_t;
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static char tx_rings[NUM_UARTS][UART_TX_BUFFER_SIZE];
+static uart_tx_state_t tx_state[NUM_UARTS];
+static uart_tx_policy_t tx_policy = UART_TX_DROP;
+static uint32_t tx_timeout_us = 0;
+
+static const char *policy_names[UART_TX_POLICY_COUNT] = { "DROP", "BLOCK", "OVERWRITE" };
+
+// -----------------------------------------------------------------------------
+// Metrics
+// -----------------------------------------------------------------------------
+
+#define TX_COLLECTOR(field) \
+    static void collect_tx_##field(metrics_sink_t *sink) { \
+        for (int i = 0; i < NUM_UARTS; i++) { \
+            if (tx_state[i].uart) metrics_sample(sink, i ? "uart1" : "uart0", tx_state[i].field); \
+        } \
+    }
+
+TX_COLLECTOR(bytes)
+TX_COLLECTOR(dropped)
+TX_COLLECTOR(overwritten)
+TX_COLLECTOR(timeouts)
+
+static metric_t tx_metrics[] = {
+    { .name = "uart_tx_bytes_total", .help = "Bytes queued for each terminal UART", .type = METRIC_COUNTER, .label = "uart", .collect = collect_tx_bytes },
+    { .name = "uart_tx_dropped_bytes_total", .help = "Bytes discarded by a full TX buffer", .type = METRIC_COUNTER, .label = "uart", .collect = collect_tx_dropped },
+    { .name = "uart_tx_overwritten_bytes_total", .help = "Unsent bytes overwritten by newer output", .type = METRIC_COUNTER, .label = "uart", .collect = collect_tx_overwritten },
+    { .name = "uart_tx_block_timeouts_total", .help = "Blocking writes that timed out", .type = METRIC_COUNTER, .label = "uart", .collect = collect_tx_timeouts },
+};
+
+// -----------------------------------------------------------------------------
+// Transmission
+// -----------------------------------------------------------------------------
+
+// Moves bytes into the UART FIFO, enabling the TX interrupt while bytes remain
+// Called with interrupts disabled or from the TX interrupt.
+static void __hot_path_func(tx_fill_fifo)(uart_tx_state_t *s) {
+    uart_hw_t *hw = uart_get_hw(s->uart);
+    while (s->tail != s->head && uart_is_writable(s->uart)) {
+        hw->dr = (uint8_t)s->ring[s->tail & (UART_TX_BUFFER_SIZE - 1)];
+        s->tail++;
+    }
+    if (s->tail != s->head) {
+        hw_set_bits(&hw->imsc, UART_UARTIMSC_TXIM_BITS);
+    } else {
+        hw_clear_bits(&hw->imsc, UART_UARTIMSC_TXIM_BITS);
+    }
+}
+
+// The TX interrupt fires when the FIFO drains below its threshold
+static void __hot_path_func(uart0_tx_irq_handler)(void) {
+    irq_account_enter(UART0_IRQ);
+    tx_fill_fifo(&tx_state[0]);
+    irq_account_exit(UART0_IRQ);
+}
+
+static void __hot_path_func(uart1_tx_irq_handler)(void) {
+    irq_account_enter(UART1_IRQ);
+    tx_fill_fifo(&tx_state[1]);
+    irq_account_exit(UART1_IRQ);
+}
+
+// Queues what fits, applying UART_TX_OVERWRITE; returns the bytes queued
+static size_t tx_enqueue(uart_tx_state_t *s, const char *data, size_t length, bool overwrite) {
+    uint32_t status = save_and_disable_interrupts();
+    uint32_t space = UART_TX_BUFFER_SIZE - (s->head - s->tail);
+    if (overwrite && length > space) {
+        if (length > UART_TX_BUFFER_SIZE) { // Only the end of the data can be kept, the caller counts the rest
+            data += length - UART_TX_BUFFER_SIZE;
+            length = UART_TX_BUFFER_SIZE;
+        }
+        s->overwritten += length - space;
+        s->tail += length - space;
+        space = length;
+    }
+
+    size_t count = length < space ? length : space;
+    for (size_t i = 0; i < count; i++) {
+        s->ring[s->head++ & (UART_TX_BUFFER_SIZE - 1)] = data[i];
+    }
+    if (s->head - s->tail > s->high_water) s->high_water = s->head - s->tail;
+    tx_fill_fifo(s);
+    restore_interrupts(status);
+    return count;
+}
+
+// -----------------------------------------------------------------------------
+// Buffered Transmit API
+// -----------------------------------------------------------------------------
+
+size_t uart_tx_write(uart_inst_t *uart, const char *data, size_t length) {
+    uart_tx_state_t *s = &tx_state[uart_get_index(uart)];
+    if (!s->uart) return 0;
+
+    // An interrupt handler cannot wait for the TX interrupt
+    bool block = tx_policy == UART_TX_BLOCK && !s->stalled && __get_current_exception() == 0;
+    size_t sent = tx_enqueue(s, data, length, tx_policy == UART_TX_OVERWRITE);
+
+    if (block && sent < length) {
+        absolute_time_t deadline = make_timeout_time_us(tx_timeout_us);
+        while (sent < length && !time_reached(deadline)) {
+            sent += tx_enqueue(s, data + sent, length - sent, false); // Also drains if interrupts are masked
+        }
+        if (sent < length) {
+            s->timeouts++;
+            s->stalled = true;
+        }
+    }
+    if (sent == length) s->stalled = false;
+
+    s->bytes += sent;
+    if (sent < length) s->dropped += length - sent;
+    return tx_policy == UART_TX_OVERWRITE ? length : sent;
+}
+
+size_t uart_tx_space(uart_inst_t *uart) {
+    const uart_tx_state_t *s = &tx_state[uart_get_index(uart)];
+    return s->uart ? UART_TX_BUFFER_SIZE - (s->head - s->tail) : 0;
+}
+
+bool uart_tx_flush(uint32_t timeout_us) {
+    absolute_time_t deadline = make_timeout_time_us(timeout_us);
+    for (int i = 0; i < NUM_UARTS; i++) {
+        uart_tx_state_t *s = &tx_state[i];
+        if (!s->uart) continue;
+        while (s->tail != s->head) {
+            if (time_reached(deadline)) return false;
+            uint32_t status = save_and_disable_interrupts();
+            tx_fill_fifo(s);
+            restore_interrupts(status);
+        }
+        uart_tx_wait_blocking(s->uart);
+    }
+    return true;
+}
+
+void uart_tx_set_policy(uart_tx_policy_t policy, uint32_t timeout_us) {
+    if (policy >= UART_TX_POLICY_COUNT) return;
+    tx_policy = policy;
+    tx_timeout_us = timeout_us;
+}
+
+uart_tx_policy_t uart_tx_get_policy(void) {
+    return tx_policy;
+}
+
+const char *uart_tx_policy_to_string(uart_tx_policy_t policy) {
+    return policy < UART_TX_POLICY_COUNT ? policy_names[policy] : "UNKNOWN";
+}
+
+void uart_tx_print_status(void) {
+    // Read before printing, the report itself goes through a buffer
+    uart_tx_state_t snapshot[NUM_UARTS];
+    for (int i = 0; i < NUM_UARTS; i++) snapshot[i] = tx_state[i];
+
+    fmt_printf("\n--- UART TX ---\n");
+    fmt_printf("Policy: %s", uart_tx_policy_to_string(tx_policy));
+    if (tx_policy == UART_TX_BLOCK) fmt_printf(" (timeout %lu us)", (unsigned long)tx_timeout_us);
+    fmt_printf("\n%-6s %-12s %-10s %-10s %-10s %-12s %-8s\n", "UART", "Buffer", "HighWater", "Queued", "Dropped", "Overwritten", "Timeouts");
+    for (int i = 0; i < NUM_UARTS; i++) {
+        const uart_tx_state_t *s = &snapshot[i];
+        if (!s->uart) continue;
+        fmt_printf("%-6d %5lu/%-6u %-10lu %-10lu %-10lu %-12lu %-8lu\n", i, (unsigned long)(s->head - s->tail), UART_TX_BUFFER_SIZE,
+                   (unsigned long)s->high_water, (unsigned long)s->bytes, (unsigned long)s->dropped,
+                   (unsigned long)s->overwritten, (unsigned long)s->timeouts);
+    }
+    fmt_printf("\n");
+}
+
+void uart_tx_init(uart_inst_t *uart) {
+    int index = uart_get_index(uart);
+    uart_tx_state_t *s = &tx_state[index];
+    bool first = !tx_state[0].uart && !tx_state[1].uart;
+
+    s->ring = tx_rings[index];
+    s->irq = index ? UART1_IRQ : UART0_IRQ;
+    s->uart = uart;
+    irq_set_exclusive_handler(s->irq, index ? uart1_tx_irq_handler : uart0_tx_irq_handler);
+    irq_account_register(s->irq, index ? "UART1" : "UART0");
+    irq_set_enabled(s->irq, true);
+
+    if (first) {
+        for (size_t i = 0; i < sizeof(tx_metrics) / sizeof(tx_metrics[0]); i++) {
+            metrics_register(&tx_metrics[i]);
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef UART_TX_H
+#define UART_TX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "hardware/uart.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE 4096 // Per UART, power of two, overridable by the build
+#endif
+#define UART_TX_DEFAULT_TIMEOUT_US 1000 // Default wait of TX BLOCK, about 11 characters at 115200 baud
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// Behavior of a write that does not fit in the buffer
+typedef enum {
+    UART_TX_DROP,       // The bytes that do not fit are discarded
+    UART_TX_BLOCK,      // The writer waits up to the timeout, then drops
+    UART_TX_OVERWRITE,  // The oldest unsent bytes are discarded
+    UART_TX_POLICY_COUNT
+} uart_tx_policy_t;
+
+// -----------------------------------------------------------------------------
+// Buffered Transmit API
+// -----------------------------------------------------------------------------
+// Output is copied into a ring buffer per UART and sent by the TX interrupt, so
+// a writer only pays for the copy. Writes are safe from tasks and interrupt
+// handlers; in an interrupt handler UART_TX_BLOCK behaves as UART_TX_DROP.
+// The default is UART_TX_DROP, so output never stalls the writer; reports larger
+// than the buffer are written in steps as uart_tx_space allows (task_terminal.h).
+// A UART whose blocking write timed out does not make later writes wait again
+// until one fits, so a stalled host costs one timeout, not one per line.
+
+// Takes over the transmitter of a configured UART
+void uart_tx_init(uart_inst_t *uart);
+
+// Queues bytes, returns how many were queued
+size_t uart_tx_write(uart_inst_t *uart, const char *data, size_t length);
+
+// Returns the free bytes of the buffer of a UART, 0 before uart_tx_init
+size_t uart_tx_space(uart_inst_t *uart);
+
+// Waits until the buffers of all UARTs are sent or the timeout expires, returns true if they are empty
+bool uart_tx_flush(uint32_t timeout_us);
+
+// Selects the full-buffer behavior of all UARTs; timeout_us only applies to UART_TX_BLOCK
+void uart_tx_set_policy(uart_tx_policy_t policy, uint32_t timeout_us);
+uart_tx_policy_t uart_tx_get_policy(void);
+const char *uart_tx_policy_to_string(uart_tx_policy_t policy);
+
+// Prints the policy, the buffer use and the loss counters
+void uart_tx_print_status(void);
+
+#endif // UART_TX_H
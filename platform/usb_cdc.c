@@ -0,0 +1,116 @@
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/structs/scb.h"
+#include "pico/platform.h"
+#include "pico/stdio_usb.h"
+#include "pico/time.h"
+#include "tusb.h"
+
+#include "usb_cdc.h"
+#include "irq_account.h"
+#include "metrics.h"
+
+_Static_assert((USB_CDC_TX_BUFFER_SIZE & (USB_CDC_TX_BUFFER_SIZE - 1)) == 0, "USB_CDC_TX_BUFFER_SIZE must be a power of two");
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static char tx_ring[USB_CDC_TX_BUFFER_SIZE];
+static uint32_t tx_head = 0; // Bytes queued, wraps
+static uint32_t tx_tail = 0; // Bytes handed to TinyUSB, wraps
+static irq_handler_t sdk_handlers[IRQ_ACCOUNT_MAX_IRQS]; // Handlers behind the accounting wrapper
+
+static metric_t metric_usb_tx_bytes = { .name = "usb_cdc_tx_bytes_total", .help = "Bytes queued for the USB serial port", .type = METRIC_COUNTER };
+static metric_t metric_usb_tx_dropped = { .name = "usb_cdc_tx_dropped_bytes_total", .help = "Bytes discarded by a full USB TX buffer", .type = METRIC_COUNTER };
+static metric_t metric_usb_rx_bytes = { .name = "usb_cdc_rx_bytes_total", .help = "Bytes received on the USB serial port", .type = METRIC_COUNTER };
+
+// -----------------------------------------------------------------------------
+// Interrupt Accounting
+// -----------------------------------------------------------------------------
+// The SDK installs the handlers of the USB port itself, so they cannot call the
+// accounting hooks: their vector table entries are moved behind one wrapper.
+
+// Runs from RAM like the handlers it wraps
+static void __not_in_flash_func(accounted_irq_handler)(void) {
+    uint8_t irq = (uint8_t)(__get_current_exception() - VTABLE_FIRST_IRQ);
+    irq_account_enter(irq);
+    sdk_handlers[irq]();
+    irq_account_exit(irq);
+}
+
+// Accounts an interrupt whose handler the SDK installed, unless a driver already does
+// The handler must not be replaced afterwards: the SDK would find the wrapper in its place.
+static void account_sdk_irq(uint irq, const char *name) {
+    if (irq_account_get(irq)) return;
+    sdk_handlers[irq] = irq_get_vtable_handler(irq);
+    uint32_t status = save_and_disable_interrupts();
+    ((irq_handler_t *)(uintptr_t)scb_hw->vtor)[VTABLE_FIRST_IRQ + irq] = accounted_irq_handler;
+    restore_interrupts(status);
+    irq_account_register(irq, name);
+}
+
+// -----------------------------------------------------------------------------
+// USB CDC API
+// -----------------------------------------------------------------------------
+
+void usb_cdc_init(void) {
+    stdio_set_driver_enabled(&stdio_usb, false);
+
+    // The controller interrupt, the user interrupt running the TinyUSB task (stdio_usb
+    // claims the only one in use) and the default alarm pool timer that raises it
+    account_sdk_irq(USBCTRL_IRQ, "USB");
+    for (uint irq = FIRST_USER_IRQ; irq < NUM_IRQS; irq++) {
+        if (user_irq_is_claimed(irq)) account_sdk_irq(irq, "USB_TASK");
+    }
+    account_sdk_irq(TIMER_IRQ_0 + alarm_pool_hardware_alarm_num(alarm_pool_get_default()), "ALARM");
+
+    metrics_register(&metric_usb_tx_bytes);
+    metrics_register(&metric_usb_tx_dropped);
+    metrics_register(&metric_usb_rx_bytes);
+}
+
+bool usb_cdc_connected(void) {
+    return stdio_usb_connected();
+}
+
+// The stdio_usb driver functions take the lock shared with the USB background task
+int usb_cdc_getc(void) {
+    char c;
+    if (stdio_usb.in_chars(&c, 1) != 1) return -1;
+    metric_inc(&metric_usb_rx_bytes);
+    return (uint8_t)c;
+}
+
+size_t usb_cdc_write(const char *data, size_t length) {
+    uint32_t status = save_and_disable_interrupts();
+    uint32_t space = USB_CDC_TX_BUFFER_SIZE - (tx_head - tx_tail);
+    size_t count = length < space ? length : space;
+    for (size_t i = 0; i < count; i++) {
+        tx_ring[tx_head++ & (USB_CDC_TX_BUFFER_SIZE - 1)] = data[i];
+    }
+    restore_interrupts(status);
+
+    metric_add(&metric_usb_tx_bytes, count);
+    if (count < length) metric_add(&metric_usb_tx_dropped, length - count);
+    return count;
+}
+
+size_t usb_cdc_tx_space(void) {
+    return USB_CDC_TX_BUFFER_SIZE - (tx_head - tx_tail);
+}
+
+void usb_cdc_poll(void) {
+    if (!usb_cdc_connected()) return;
+
+    // Contiguous part of the queue that fits in the CDC FIFO, the write does not wait
+    uint32_t pending = tx_head - tx_tail;
+    uint32_t offset = tx_tail & (USB_CDC_TX_BUFFER_SIZE - 1);
+    uint32_t count = USB_CDC_TX_BUFFER_SIZE - offset;
+    uint32_t room = tud_cdc_write_available();
+    if (count > pending) count = pending;
+    if (count > room) count = room;
+    if (count == 0) return;
+
+    stdio_usb.out_chars(&tx_ring[offset], (int)count);
+    tx_tail += count;
+}
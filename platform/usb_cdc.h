@@ -0,0 +1,41 @@
+#ifndef USB_CDC_H
+#define USB_CDC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#ifndef USB_CDC_TX_BUFFER_SIZE
+#define USB_CDC_TX_BUFFER_SIZE 2048 // Power of two, overridable by the build
+#endif
+
+// -----------------------------------------------------------------------------
+// USB CDC API
+// -----------------------------------------------------------------------------
+// The USB serial port of pico_stdio_usb, used as a link of its own rather than
+// as a copy of stdout. Output is queued and moved to the CDC FIFO by
+// usb_cdc_poll only as far as it has room, so a host that stops reading fills
+// the queue and loses output instead of stalling the writer.
+
+// Detaches the USB port from stdout and accounts the SDK interrupts serving it
+void usb_cdc_init(void);
+
+// Returns the next received byte, or -1 if none
+int usb_cdc_getc(void);
+
+// Queues bytes, returns how many were queued; the rest is dropped and counted
+size_t usb_cdc_write(const char *data, size_t length);
+
+// Returns the free bytes of the queue
+size_t usb_cdc_tx_space(void);
+
+// Moves queued output to the CDC FIFO
+void usb_cdc_poll(void);
+
+// Returns true while a host has the port open
+bool usb_cdc_connected(void);
+
+#endif // USB_CDC_H
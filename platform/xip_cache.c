@@ -0,0 +1,63 @@
+#include "hardware/structs/xip_ctrl.h"
+
+#include "xip_cache.h"
+#include "hot_path.h"
+#include "scheduler.h"
+#include "metrics.h"
+#include "initcalls.h"
+#include "fmt.h"
+
+#define SRAM_START 0x20000000u // Code below this address is fetched through XIP
+
+void xip_cache_reset_counters(void) {
+    xip_ctrl_hw->ctr_hit = 0; // Any write clears
+    xip_ctrl_hw->ctr_acc = 0;
+}
+
+void xip_cache_get_counters(uint32_t *hits, uint32_t *accesses) {
+    *accesses = xip_ctrl_hw->ctr_acc;
+    *hits = xip_ctrl_hw->ctr_hit;
+}
+
+void xip_cache_flush(void) {
+    xip_ctrl_hw->flush = 1;
+    (void)xip_ctrl_hw->flush; // The read completes once the flush is done
+}
+
+void xip_cache_print_report(void) {
+    uint32_t hits, accesses;
+    xip_cache_get_counters(&hits, &accesses);
+    uint32_t permille = accesses ? (uint32_t)((uint64_t)hits * 1000 / accesses) : 0;
+    uintptr_t dispatch = (uintptr_t)&scheduler_run_once;
+
+    fmt_printf("\n--- XIP Cache ---\n");
+    fmt_printf("Accesses: %lu%s\n", (unsigned long)accesses, accesses == UINT32_MAX ? " (saturated, use XIP RESET)" : "");
+    fmt_printf("Hits: %lu, misses: %lu, hit rate: %lu.%lu%%\n", (unsigned long)hits, (unsigned long)(accesses - hits),
+               (unsigned long)(permille / 10), (unsigned long)(permille % 10));
+    fmt_printf("Hot path: %s, scheduler_run_once at 0x%08lx (%s)\n\n", RAM_HOT_PATH ? "RAM" : "flash",
+               (unsigned long)dispatch, dispatch >= SRAM_START ? "SRAM" : "XIP");
+}
+
+// -----------------------------------------------------------------------------
+// Metrics
+// -----------------------------------------------------------------------------
+
+static void collect_hits(metrics_sink_t *sink) {
+    metrics_sample(sink, NULL, xip_ctrl_hw->ctr_hit);
+}
+
+static void collect_accesses(metrics_sink_t *sink) {
+    metrics_sample(sink, NULL, xip_ctrl_hw->ctr_acc);
+}
+
+static metric_t xip_metrics[] = {
+    { .name = "xip_cache_hits_total", .help = "XIP cache hits since the last reset (saturating)", .type = METRIC_COUNTER, .collect = collect_hits },
+    { .name = "xip_cache_accesses_total", .help = "XIP accesses since the last reset (saturating)", .type = METRIC_COUNTER, .collect = collect_accesses },
+};
+
+static void xip_cache_init(void) {
+    xip_cache_reset_counters();
+    metrics_register(&xip_metrics[0]);
+    metrics_register(&xip_metrics[1]);
+}
+REGISTER_INITCALL_LEVEL(xip_cache_init, INITCALL_CORE);
@@ -0,0 +1,25 @@
+#ifndef XIP_CACHE_H
+#define XIP_CACHE_H
+
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// XIP Cache API
+// -----------------------------------------------------------------------------
+// The XIP cache (16 KB) counts every flash access and every hit in two 32-bit
+// saturating counters. Misses stall the CPU for a QSPI fetch, so a low hit rate
+// around the scheduler shows up as execution-time jitter.
+
+// Clears the hit and access counters
+void xip_cache_reset_counters(void);
+
+// Reads the counters
+void xip_cache_get_counters(uint32_t *hits, uint32_t *accesses);
+
+// Invalidates the cache, the next accesses miss (worst-case timing)
+void xip_cache_flush(void);
+
+// Prints the counters, the hit rate and where the hot path runs from
+void xip_cache_print_report(void);
+
+#endif // XIP_CACHE_H
@@ -0,0 +1,341 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "bench.h"
+#include "scheduler.h"
+#include "terminal.h"
+#include "config.h"
+#include "fmt.h"
+
+#if BENCH_LIBC_FORMAT
+#include <stdio.h>
+#endif
+
+#if PICO_ON_DEVICE
+#include "pico/time.h"
+#else
+#include <time.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static uint32_t cpu_hz = 0;                                   // CPU frequency for cycle conversion
+static terminal_context_t bench_context;                      // Private context, the live terminal is not touched
+
+// -----------------------------------------------------------------------------
+// Measurement
+// -----------------------------------------------------------------------------
+
+// Monotonic time in nanoseconds
+// On the device the hardware timer has a 1 us resolution, which is why every
+// case runs for at least BENCH_MIN_TIME_NS.
+static uint64_t bench_now_ns(void) {
+#if PICO_ON_DEVICE
+    return time_us_64() * 1000u;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void bench_set_cpu_hz(uint32_t hz) {
+    cpu_hz = hz;
+}
+
+void bench_print_header(void) {
+    fmt_printf("bench,case,size,iterations,total_ns,ns_per_op,cycles_per_op\n");
+}
+
+// Measures an operation, doubling the iterations until the run is long enough
+uint32_t bench_measure(const char *name, int size, bench_op_t op, void *arg) {
+    bench_op_t volatile call = op; // Keeps the compiler from inlining or removing the operation
+    uint32_t iterations = BENCH_MIN_ITERATIONS;
+    uint64_t elapsed;
+
+    for (;;) {
+        uint64_t start = bench_now_ns();
+        for (uint32_t i = 0; i < iterations; i++) {
+            call(arg);
+        }
+        elapsed = bench_now_ns() - start;
+        if (elapsed >= BENCH_MIN_TIME_NS || iterations >= (1u << 30)) break;
+        iterations *= 2;
+    }
+
+    // Fixed point with two decimals, printf float support is not needed
+    uint64_t ns_x100 = elapsed * 100u / iterations;
+    fmt_printf("bench,%s,%d,%lu,%llu,%lu.%02lu,", name, size, (unsigned long)iterations,
+               (unsigned long long)elapsed, (unsigned long)(ns_x100 / 100), (unsigned long)(ns_x100 % 100));
+    if (cpu_hz) {
+        uint64_t cycles_x100 = elapsed * (cpu_hz / 1000u) / 10000u / iterations;
+        fmt_printf("%lu.%02lu", (unsigned long)(cycles_x100 / 100), (unsigned long)(cycles_x100 % 100));
+    }
+    fmt_printf("\n");
+    return (uint32_t)(ns_x100 / 100);
+}
+
+// Empty operation, measures the loop and the indirect call
+static void bench_op_empty(void *arg) {
+    (void)arg;
+}
+
+void bench_overhead(void) {
+    bench_measure("bench_overhead", 0, bench_op_empty, NULL);
+}
+
+// -----------------------------------------------------------------------------
+// Scheduler
+// -----------------------------------------------------------------------------
+
+static void bench_op_peek(void *arg) {
+    scheduler_peek_next_task((sched_algorithm_t)(intptr_t)arg);
+}
+
+static bool bench_scheduler_case(int index) {
+    char name[48];
+    if (index >= SCHED_ALGO_COUNT) return false;
+    fmt_snprintf(name, sizeof(name), "sched_decision_%s", scheduler_algorithm_to_string((sched_algorithm_t)index));
+    bench_measure(name, scheduler_get_task_count(), bench_op_peek, (void *)(intptr_t)index);
+    return true;
+}
+
+void bench_scheduler(void) {
+    for (int i = 0; bench_scheduler_case(i); i++) {
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Terminal
+// -----------------------------------------------------------------------------
+
+// Command without side effects, executed by the benchmark with three integer arguments
+static const terminal_form_t nop_forms[] = {
+    FORM(ARG_INT_OPTIONAL("a", INT32_MIN, INT32_MAX, 0), ARG_INT_OPTIONAL("b", INT32_MIN, INT32_MAX, 0), ARG_INT_OPTIONAL("c", INT32_MIN, INT32_MAX, 0)),
+};
+
+static void cmd_nop(terminal_context_t *context, const terminal_args_t *args) {
+    (void)context;
+    (void)args;
+}
+REGISTER_COMMAND_ARGS("NOP", "Do nothing, times the command dispatch", cmd_nop, nop_forms);
+
+static void bench_op_command(void *arg) {
+    terminal_run_commands(&bench_context, (const char *)arg);
+}
+
+static void bench_op_find(void *arg) {
+    terminal_find_command((const char *)arg);
+}
+
+static bool bench_terminal_case(int index) {
+    static char line[] = "NOP 1 2 3";
+    static char hit[] = "NOP";
+    static char miss[] = "NOPE";
+    int count = (int)terminal_get_command_count();
+
+    switch (index) {
+        case 0:
+            terminal_init(&bench_context);
+            bench_context.authenticated = 1; // Set directly, terminal_set_authenticated prints
+            bench_measure("terminal_exec", count, bench_op_command, line);
+            return true;
+        case 1: bench_measure("terminal_find_hit", count, bench_op_find, hit); return true;
+        case 2: bench_measure("terminal_find_miss", count, bench_op_find, miss); return true;
+        default: return false;
+    }
+}
+
+void bench_terminal(void) {
+    for (int i = 0; bench_terminal_case(i); i++) {
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Configuration
+// -----------------------------------------------------------------------------
+
+static void bench_op_get(void *arg) {
+    config_param_t param;
+    get_param(*(int *)arg, &param);
+}
+
+// Writes back the current value, so the lookup and validation run without side effects
+static void bench_op_set(void *arg) {
+    config_param_t param;
+    if (get_param(*(int *)arg, &param) == 0) {
+        set_param(param.key, param.type, &param.value);
+    }
+}
+
+static bool bench_config_case(int index) {
+    static int last_key;
+    static int missing_key = -1;
+    last_key = params[MAX_PARAMS - 1].key;
+
+    switch (index) {
+        case 0: bench_measure("config_get_last", MAX_PARAMS, bench_op_get, &last_key); return true;
+        case 1: bench_measure("config_get_missing", MAX_PARAMS, bench_op_get, &missing_key); return true;
+        case 2: bench_measure("config_get_set_last", MAX_PARAMS, bench_op_set, &last_key); return true;
+        default: return false;
+    }
+}
+
+void bench_config(void) {
+    for (int i = 0; bench_config_case(i); i++) {
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Formatting
+// -----------------------------------------------------------------------------
+
+// Painted area, within the 2 KB core 0 stack on the device
+#if PICO_ON_DEVICE
+#define BENCH_STACK_PAINT 768
+#else
+#define BENCH_STACK_PAINT 8192
+#endif
+#define BENCH_STACK_FILL 0xA5
+
+// One row of scheduler_print_task_list and one line of its header
+#define BENCH_ROW_FORMAT   "%-5d %-10s %-10s %-10d %-10d %-10lld %-10lld %-10lld %-10lld %-10lld %-10lld %-10d %-10zu\n"
+#define BENCH_ROW_ARGS     row.pid, row.name, row.state, row.priority, row.count, row.total, row.min, row.max, row.avg, \
+                           row.max_jitter, row.avg_jitter, row.misses, row.memory
+#define BENCH_FLOAT_FORMAT "CPU Usage: %.2f%% (%lld us)\n"
+
+static struct {
+    int pid, priority, count, misses;
+    const char *name, *state;
+    long long total, min, max, avg, max_jitter, avg_jitter, uptime;
+    size_t memory;
+    double usage;
+} row = { 3, 2, 123456, 0, "terminal", "RUNNING", 98765432, 12, 3456, 800, 150, 20, 4000000123ll, 512, 37.4159 };
+static char format_buffer[192];
+
+#if BENCH_LIBC_FORMAT
+static void bench_op_row_libc(void *arg) {
+    (void)arg;
+    snprintf(format_buffer, sizeof(format_buffer), BENCH_ROW_FORMAT, BENCH_ROW_ARGS);
+}
+
+static void bench_op_float_libc(void *arg) {
+    (void)arg;
+    snprintf(format_buffer, sizeof(format_buffer), BENCH_FLOAT_FORMAT, row.usage, row.uptime);
+}
+#endif
+
+static void bench_op_row_fmt(void *arg) {
+    (void)arg;
+    fmt_snprintf(format_buffer, sizeof(format_buffer), BENCH_ROW_FORMAT, BENCH_ROW_ARGS);
+}
+
+static void bench_op_float_fmt(void *arg) {
+    (void)arg;
+    fmt_snprintf(format_buffer, sizeof(format_buffer), BENCH_FLOAT_FORMAT, row.usage, row.uptime);
+}
+
+static uintptr_t stack_area; // Lowest address of the painted area, below the current frame once painted
+
+// Fills an area just below the caller's frame, where the measured call will place its frames
+static void __attribute__((noinline)) bench_stack_paint(void) {
+    volatile uint8_t area[BENCH_STACK_PAINT];
+    for (size_t i = 0; i < sizeof(area); i++) area[i] = BENCH_STACK_FILL;
+    stack_area = (uintptr_t)area;
+}
+
+// Bytes of the area overwritten since the paint, from its top to the deepest write
+static size_t __attribute__((noinline)) bench_stack_scan(void) {
+    const volatile uint8_t *area = (const volatile uint8_t *)stack_area;
+    size_t untouched = 0;
+    while (untouched < BENCH_STACK_PAINT && area[untouched] == BENCH_STACK_FILL) untouched++;
+    return BENCH_STACK_PAINT - untouched;
+}
+
+// Prints the stack bytes written by one call of the operation
+// A call that reaches the end of the painted area may have gone further: ">=" marks it.
+static void __attribute__((noinline)) bench_stack(const char *name, bench_op_t op) {
+    bench_stack_paint();
+    op(NULL);
+    size_t used = bench_stack_scan();
+    fmt_printf("stack,%s,%s%u\n", name, used >= BENCH_STACK_PAINT ? ">=" : "", (unsigned)used);
+}
+
+// Timed cases first, then the stack of each operation
+static const struct {
+    const char *name;
+    int size;         // Conversions in the format
+    bench_op_t op;
+} format_cases[] = {
+#if BENCH_LIBC_FORMAT
+    { "format_row_libc", 13, bench_op_row_libc },
+#endif
+    { "format_row_fmt", 13, bench_op_row_fmt },
+#if BENCH_LIBC_FORMAT
+    { "format_float_libc", 2, bench_op_float_libc },
+#endif
+    { "format_float_fmt", 2, bench_op_float_fmt },
+};
+#define FORMAT_CASE_COUNT ((int)(sizeof(format_cases) / sizeof(format_cases[0])))
+
+static bool bench_format_case(int index) {
+    if (index < FORMAT_CASE_COUNT) {
+        bench_measure(format_cases[index].name, format_cases[index].size, format_cases[index].op, NULL);
+    } else if (index < 2 * FORMAT_CASE_COUNT) {
+        bench_stack(format_cases[index - FORMAT_CASE_COUNT].name, format_cases[index - FORMAT_CASE_COUNT].op);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void bench_format(void) {
+    for (int i = 0; bench_format_case(i); i++) {
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Runner
+// -----------------------------------------------------------------------------
+
+// Cases of each group in run order; a case function returns false past the last case
+static const struct {
+    unsigned group;
+    bool (*run_case)(int index);
+} group_cases[] = {
+    { BENCH_GROUP_SCHED, bench_scheduler_case },
+    { BENCH_GROUP_TERMINAL, bench_terminal_case },
+    { BENCH_GROUP_CONFIG, bench_config_case },
+    { BENCH_GROUP_FORMAT, bench_format_case },
+};
+#define BENCH_GROUP_COUNT ((int)(sizeof(group_cases) / sizeof(group_cases[0])))
+
+void bench_run_begin(bench_run_t *run, unsigned groups) {
+    run->groups = groups;
+    run->group = -1;
+    run->index = 0;
+}
+
+bool bench_run_step(bench_run_t *run) {
+    if (run->group < 0) {
+        bench_print_header();
+        bench_overhead();
+        run->group = 0;
+        return true;
+    }
+    for (; run->group < BENCH_GROUP_COUNT; run->group++, run->index = 0) {
+        if ((run->groups & group_cases[run->group].group) && group_cases[run->group].run_case(run->index)) {
+            run->index++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void bench_run(unsigned groups) {
+    bench_run_t run;
+    bench_run_begin(&run, groups);
+    while (bench_run_step(&run)) {
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define BENCH_MIN_TIME_NS     20000000ull // Minimum measured time of a case (20 ms)
+#define BENCH_MIN_ITERATIONS  16          // Iterations of the first calibration run
+
+// Benchmark groups, combinable as a bitmask
+#define BENCH_GROUP_SCHED     (1u << 0) // Scheduling decision of each algorithm
+#define BENCH_GROUP_TERMINAL  (1u << 1) // Command line parse and lookup
+#define BENCH_GROUP_CONFIG    (1u << 2) // Parameter get/set lookup
+#define BENCH_GROUP_FORMAT    (1u << 3) // Report row formatting with fmt, against libc snprintf if built in
+#define BENCH_GROUP_ALL       (BENCH_GROUP_SCHED | BENCH_GROUP_TERMINAL | BENCH_GROUP_CONFIG | BENCH_GROUP_FORMAT)
+
+// The libc snprintf cases link the libc printf with its float support, which the
+// firmware otherwise does without: on the device only with the CMake option
+// RT_BENCH_LIBC_FORMAT.
+#ifndef BENCH_LIBC_FORMAT
+#if PICO_ON_DEVICE
+#define BENCH_LIBC_FORMAT 0
+#else
+#define BENCH_LIBC_FORMAT 1
+#endif
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// Operation measured by a benchmark case
+typedef void (*bench_op_t)(void *arg);
+
+// Position of a run printed in steps
+typedef struct {
+    unsigned groups;  // Selected groups
+    int group;        // Group of the next case, -1 before the header
+    int index;        // Next case within the group
+} bench_run_t;
+
+// -----------------------------------------------------------------------------
+// Benchmark API
+// -----------------------------------------------------------------------------
+// Results are printed as CSV rows, one per case:
+//   bench,<case>,<size>,<iterations>,<total_ns>,<ns_per_op>,<cycles_per_op>
+// The bench_overhead row is the cost of the measurement loop itself.
+// Stack measurements are printed as:
+//   stack,<case>,<bytes>
+// with <bytes> written ">=<n>" when the call used the whole painted area of n bytes.
+
+// Sets the CPU frequency used to convert time to cycles (0 leaves the column empty)
+void bench_set_cpu_hz(uint32_t hz);
+
+// Prints the CSV header
+void bench_print_header(void);
+
+// Measures an operation and prints its row. Returns the time per operation in ns.
+uint32_t bench_measure(const char *name, int size, bench_op_t op, void *arg);
+
+// Cost of the measurement loop, to be subtracted from the other cases
+void bench_overhead(void);
+
+// Scheduling decision of every algorithm on the registered task set
+void bench_scheduler(void);
+
+// Command execution and lookup over the linked commands, in a private terminal context
+void bench_terminal(void);
+
+// Parameter lookups on the current parameter table (values are left unchanged)
+void bench_config(void);
+
+// Formatting of a PS row and of a fixed-point line, libc snprintf against fmt_snprintf, time and stack
+void bench_format(void);
+
+// Runs the selected groups with the sizes of the running system
+void bench_run(unsigned groups);
+
+// The same run one case per step (the header and bench_overhead first), so the
+// caller can return to the scheduler between cases; each bench_run_step returns
+// false once the run is complete
+void bench_run_begin(bench_run_t *run, unsigned groups);
+bool bench_run_step(bench_run_t *run);
+
+#endif // BENCH_H
@@ -1,11 +1,25 @@
 #include "config.h"
 #include "flash.h"
+#include "metrics.h"
+#include "initcalls.h"
 #include <string.h>
 #include <stdio.h>
 
 // Global configuration parameters
 config_param_t params[MAX_PARAMS];
 
+// Metrics of parameter updates
+static metric_t metric_sets = { .name = "config_set_total", .help = "Parameters updated", .type = METRIC_COUNTER };
+static metric_t metric_rejected = { .name = "config_set_rejected_total", .help = "Parameter updates rejected", .type = METRIC_COUNTER };
+static metric_t metric_saves = { .name = "config_flash_saves_total", .help = "Parameter saves to flash", .type = METRIC_COUNTER };
+
+static void config_metrics_init(void) {
+    metrics_register(&metric_sets);
+    metrics_register(&metric_rejected);
+    metrics_register(&metric_saves);
+}
+REGISTER_INITCALL_LEVEL(config_metrics_init, INITCALL_CORE);
+
 // Declaration of default_params (defined in secret.c)
 extern const config_param_t default_params[MAX_PARAMS];
 
@@ -42,7 +56,7 @@ bool validate_param(const config_param_t *param) {
 }
 
 // Sets a parameter value, validating it before applying
-int set_param(int key, param_type_t type, void *value) {
+static int update_param(int key, param_type_t type, void *value) {
     for (size_t i = 0; i < MAX_PARAMS; i++) {
         if (params[i].key == key) {
             if (params[i].type != type) {
@@ -98,6 +112,13 @@ int set_param(int key, param_type_t type, void *value) {
     return -1; // Parameter not found
 }
 
+// Sets a parameter value and counts the outcome
+int set_param(int key, param_type_t type, void *value) {
+    int result = update_param(key, type, value);
+    metric_inc(result == 0 ? &metric_sets : &metric_rejected);
+    return result;
+}
+
 // Retrieves a parameter by its key
 int get_param(int key, config_param_t *out_param) {
     for (size_t i = 0; i < MAX_PARAMS; i++) {
@@ -117,6 +138,7 @@ void reset_params_to_defaults() {
 // Saves current parameters to flash storage
 void save_params_to_flash() {
     flash_storage_write(params, sizeof(params));
+    metric_inc(&metric_saves);
 }
 
 // Loads parameters from flash storage
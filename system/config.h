@@ -5,7 +5,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-#define MAX_PARAMS 20
+#ifndef MAX_PARAMS
+#define MAX_PARAMS 20 // Overridable by the build
+#endif
 
 // Types of configuration parameters
 typedef enum {
@@ -0,0 +1,33 @@
+#include <stdint.h>
+
+#include "hardware/clocks.h"
+#include "cycles.h"
+#include "initcalls.h"
+#include "hot_path.h"
+
+void cycles_init(void) {
+    systick_hw->csr = 0;
+    systick_hw->rvr = CYCLES_COUNTER_MASK;
+    systick_hw->cvr = 0; // Any write clears the counter, it reloads on the next cycle
+    systick_hw->csr = CYCLES_SYST_CLKSOURCE | CYCLES_SYST_ENABLE;
+}
+REGISTER_INITCALL_LEVEL(cycles_init, INITCALL_EARLY);
+
+uint32_t __hot_path_func(cycles_per_us)(void) {
+    return clock_get_hz(clk_sys) / 1000000u;
+}
+
+// The counter counts down, so the raw difference is start - end modulo 2^24.
+// The microsecond measurement is accurate to about one microsecond, far less than
+// a wrap, so the nearest whole number of wraps is the right one.
+uint32_t __hot_path_func(cycles_elapsed)(uint32_t start, uint32_t end, int64_t elapsed_us) {
+    uint32_t diff = (start - end) & CYCLES_COUNTER_MASK;
+    if (elapsed_us <= 0) return diff;
+
+    int64_t estimate = elapsed_us * (int64_t)cycles_per_us();
+    int64_t wraps = (estimate - (int64_t)diff + (1 << (CYCLES_COUNTER_BITS - 1))) >> CYCLES_COUNTER_BITS;
+    if (wraps <= 0) return diff;
+
+    uint64_t cycles = ((uint64_t)wraps << CYCLES_COUNTER_BITS) + diff;
+    return cycles > UINT32_MAX ? UINT32_MAX : (uint32_t)cycles;
+}
@@ -0,0 +1,39 @@
+#ifndef CYCLES_H
+#define CYCLES_H
+
+#include <stdint.h>
+#include "hardware/structs/systick.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define CYCLES_COUNTER_BITS 24                            // Width of the SysTick counter
+#define CYCLES_COUNTER_MASK ((1u << CYCLES_COUNTER_BITS) - 1)
+
+// SysTick control and status bits
+#define CYCLES_SYST_ENABLE    (1u << 0) // Counter enabled
+#define CYCLES_SYST_CLKSOURCE (1u << 2) // Counts processor clock cycles
+
+// -----------------------------------------------------------------------------
+// Cycle Counter API
+// -----------------------------------------------------------------------------
+// The Cortex-M0+ has no DWT cycle counter; SysTick runs free on the processor clock
+// as a 24-bit down-counter, without interrupt. It wraps every 2^24 cycles (134 ms at
+// 125 MHz): intervals are measured in cycles and in microseconds at the same time, and
+// the number of wraps is recovered from the microsecond measurement.
+
+// Starts the free-running counter (registered as initcall)
+void cycles_init(void);
+
+// Reads the counter, a single register load
+static inline uint32_t cycles_now(void) {
+    return systick_hw->cvr;
+}
+
+// Returns the processor cycles per microsecond at the current clock
+uint32_t cycles_per_us(void);
+
+// Returns the cycles between two readings of the same interval measured as elapsed_us
+uint32_t cycles_elapsed(uint32_t start, uint32_t end, int64_t elapsed_us);
+
+#endif // CYCLES_H
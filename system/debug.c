@@ -1,8 +1,8 @@
-#include <stdio.h>
 #include <stdbool.h>
 
 #include "debug.h"
 #include "scheduler.h"
+#include "fmt.h"
 
 // Debug state for each task
 static bool debug_task_enabled[MAX_TASKS] = {false};
@@ -11,7 +11,7 @@ static bool debug_task_enabled[MAX_TASKS] = {false};
 void debug_enable_task(int task_id) {
     if (task_id >= 0 && task_id < MAX_TASKS) {
         debug_task_enabled[task_id] = true;
-        printf("[DEBUG] Debug enabled for task %d\n", task_id);
+        fmt_printf("[DEBUG] Debug enabled for task %d\n", task_id);
     }
 }
 
@@ -19,7 +19,7 @@ void debug_enable_task(int task_id) {
 void debug_disable_task(int task_id) {
     if (task_id >= 0 && task_id < MAX_TASKS) {
         debug_task_enabled[task_id] = false;
-        printf("[DEBUG] Debug disabled for task %d\n", task_id);
+        fmt_printf("[DEBUG] Debug disabled for task %d\n", task_id);
     }
 }
 
@@ -2,13 +2,14 @@
 #define DEBUG_H
 
 #include <stdbool.h>
-#include <stdio.h>
+
+#include "fmt.h"
 
 // Macro for task-specific debug logging
 #define DEBUG_LOG_TASK(task_id, format, ...) \
     do { \
         if (debug_is_task_enabled(task_id)) { \
-            printf("[DEBUG][Task %d] " format "\n", task_id, ##__VA_ARGS__); \
+            fmt_printf("[DEBUG][Task %d] " format "\n", task_id, ##__VA_ARGS__); \
         } \
     } while (0)
 
@@ -0,0 +1,470 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "fmt.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define FLAG_LEFT   (1u << 0) // '-'
+#define FLAG_ZERO   (1u << 1) // '0'
+#define FLAG_PLUS   (1u << 2) // '+'
+#define FLAG_SPACE  (1u << 3) // ' '
+#define FLAG_ALT    (1u << 4) // '#'
+
+// Integer argument sizes
+enum { LENGTH_CHAR, LENGTH_SHORT, LENGTH_INT, LENGTH_LONG, LENGTH_LLONG, LENGTH_SIZE };
+
+static const char fill_spaces[16] = "                ";
+static const char fill_zeros[16] = "0000000000000000";
+static const char digits_lower[] = "0123456789abcdef";
+static const char digits_upper[] = "0123456789ABCDEF";
+static const uint32_t pow10[FMT_MAX_PRECISION + 1] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// Writer and running count of one fmt_format call
+typedef struct {
+    fmt_write_t write;
+    void *context;
+    int count;
+} fmt_out_t;
+
+// Destination of fmt_vsnprintf
+typedef struct {
+    char *buffer;
+    size_t size;   // Usable characters, the NUL excluded
+    size_t length; // Characters stored
+} fmt_buffer_t;
+
+// Destination of fmt_vprintf
+typedef struct {
+    char data[FMT_CHUNK_SIZE];
+    size_t length;
+} fmt_chunk_t;
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static void fmt_stdout(const char *data, size_t length);
+static fmt_output_t fmt_output = fmt_stdout; // Destination of fmt_printf
+
+// -----------------------------------------------------------------------------
+// Conversions
+// -----------------------------------------------------------------------------
+// The converters write backwards from the end of a buffer and return the first digit.
+
+static char *convert_u32(char *end, uint32_t value) {
+    do {
+        *--end = (char)('0' + value % 10u);
+        value /= 10u;
+    } while (value);
+    return end;
+}
+
+// Only the chunks above 32 bits need the 64-bit division
+static char *convert_u64(char *end, uint64_t value) {
+    while (value > UINT32_MAX) {
+        uint64_t high = value / 1000000000u;
+        char *start = convert_u32(end, (uint32_t)(value - high * 1000000000u));
+        while (end - start < 9) *--start = '0';
+        end = start;
+        value = high;
+    }
+    return convert_u32(end, (uint32_t)value);
+}
+
+static char *convert_hex(char *end, uint64_t value, bool upper) {
+    const char *digits = upper ? digits_upper : digits_lower;
+    do {
+        *--end = digits[value & 0xF];
+        value >>= 4;
+    } while (value);
+    return end;
+}
+
+static char *convert_octal(char *end, uint64_t value) {
+    do {
+        *--end = (char)('0' + (value & 7));
+        value >>= 3;
+    } while (value);
+    return end;
+}
+
+// Fixed point: integer part and fraction scaled by 10^precision
+// The fraction is rounded from the exact binary value of the double, ties to even,
+// so the digits match glibc and newlib. It is mantissa / 2^bits, and scaling by
+// 10^precision = 5^precision * 2^precision takes the product mantissa * 5^precision,
+// at most 75 bits, kept in two words.
+static char *convert_fixed(char *end, double value, int precision, bool point) {
+    uint64_t integer = (uint64_t)value;
+    double rest = value - (double)integer; // Exact, the fraction of a double is representable
+    uint32_t fraction = 0;
+    bool round_up = false;
+
+    if (rest != 0) {
+        uint64_t raw;
+        memcpy(&raw, &rest, sizeof(raw));
+        int exponent = (int)(raw >> 52) & 0x7FF;
+        uint64_t mantissa = raw & ((1ull << 52) - 1);
+        if (exponent) mantissa |= 1ull << 52;
+        int shift = (exponent ? 1075 - exponent : 1074) - precision; // fraction * 10^p = product / 2^shift
+
+        uint64_t five = pow10[precision] >> precision;
+        uint64_t low = (mantissa & 0xFFFFFFFFu) * five;
+        uint64_t mid = (mantissa >> 32) * five;
+        uint64_t lo = low + (mid << 32);
+        uint64_t hi = (mid >> 32) + (lo < low);
+
+        if (shift <= 0) {
+            fraction = (uint32_t)(lo << -shift); // Fewer fraction bits than digits: exact
+        } else if (shift < 128) {
+            fraction = (uint32_t)(shift < 64 ? (lo >> shift) | (hi << (64 - shift)) : hi >> (shift - 64));
+            int half = shift - 1; // Bit worth half a unit of the last digit
+            bool half_set = half < 64 ? (lo >> half) & 1 : (hi >> (half - 64)) & 1;
+            bool below = half < 64 ? (lo & ((1ull << half) - 1)) != 0 : lo != 0 || (hi & ((1ull << (half - 64)) - 1)) != 0;
+            uint32_t last = precision > 0 ? fraction : (uint32_t)integer;
+            round_up = half_set && (below || (last & 1));
+        }
+    }
+
+    if (round_up && ++fraction >= pow10[precision]) {
+        integer++;
+        fraction -= pow10[precision];
+    }
+
+    if (precision > 0) {
+        char *start = convert_u32(end, fraction);
+        while (end - start < precision) *--start = '0';
+        end = start;
+    }
+    if (precision > 0 || point) *--end = '.';
+    return convert_u64(end, integer);
+}
+
+// -----------------------------------------------------------------------------
+// Output
+// -----------------------------------------------------------------------------
+
+static void out(fmt_out_t *o, const char *data, size_t length) {
+    if (length == 0) return;
+    o->write(o->context, data, length);
+    o->count += (int)length;
+}
+
+static void out_fill(fmt_out_t *o, const char *fill, int count) {
+    while (count > 0) {
+        int n = count < (int)sizeof(fill_spaces) ? count : (int)sizeof(fill_spaces);
+        out(o, fill, (size_t)n);
+        count -= n;
+    }
+}
+
+// Writes prefix (sign, 0x), leading zeros and body, padded to the width
+static void out_field(fmt_out_t *o, unsigned flags, int width, const char *prefix, int zeros,
+                      const char *body, size_t length) {
+    size_t prefix_length = strlen(prefix);
+    int pad = width - (int)(prefix_length + length) - zeros;
+
+    if (flags & FLAG_LEFT) {
+        out(o, prefix, prefix_length);
+        out_fill(o, fill_zeros, zeros);
+        out(o, body, length);
+        out_fill(o, fill_spaces, pad);
+    } else if (flags & FLAG_ZERO) {
+        out(o, prefix, prefix_length);
+        out_fill(o, fill_zeros, zeros + pad);
+        out(o, body, length);
+    } else {
+        out_fill(o, fill_spaces, pad);
+        out(o, prefix, prefix_length);
+        out_fill(o, fill_zeros, zeros);
+        out(o, body, length);
+    }
+}
+
+static const char *sign_prefix(bool negative, unsigned flags) {
+    if (negative) return "-";
+    if (flags & FLAG_PLUS) return "+";
+    if (flags & FLAG_SPACE) return " ";
+    return "";
+}
+
+// -----------------------------------------------------------------------------
+// Formatter API
+// -----------------------------------------------------------------------------
+
+int fmt_format(fmt_write_t write, void *context, const char *format, va_list args) {
+    fmt_out_t o = { write, context, 0 };
+    const char *p = format;
+
+    while (*p) {
+        // Literal text up to the next conversion, in one piece
+        const char *literal = p;
+        while (*p && *p != '%') p++;
+        out(&o, literal, (size_t)(p - literal));
+        if (*p == '\0') break;
+        p++;
+
+        unsigned flags = 0;
+        for (;; p++) {
+            if (*p == '-') flags |= FLAG_LEFT;
+            else if (*p == '0') flags |= FLAG_ZERO;
+            else if (*p == '+') flags |= FLAG_PLUS;
+            else if (*p == ' ') flags |= FLAG_SPACE;
+            else if (*p == '#') flags |= FLAG_ALT;
+            else break;
+        }
+
+        int width = 0;
+        if (*p == '*') {
+            width = va_arg(args, int);
+            if (width < 0) {
+                flags |= FLAG_LEFT;
+                width = -width;
+            }
+            p++;
+        } else {
+            while (*p >= '0' && *p <= '9') width = width * 10 + (*p++ - '0');
+        }
+
+        int precision = -1;
+        if (*p == '.') {
+            p++;
+            precision = 0;
+            if (*p == '*') {
+                precision = va_arg(args, int);
+                p++;
+            } else {
+                while (*p >= '0' && *p <= '9') precision = precision * 10 + (*p++ - '0');
+            }
+        }
+
+        int length = LENGTH_INT;
+        if (*p == 'h') {
+            p++;
+            length = LENGTH_SHORT;
+            if (*p == 'h') {
+                p++;
+                length = LENGTH_CHAR;
+            }
+        } else if (*p == 'l') {
+            p++;
+            length = LENGTH_LONG;
+            if (*p == 'l') {
+                p++;
+                length = LENGTH_LLONG;
+            }
+        } else if (*p == 'j') {
+            p++;
+            length = LENGTH_LLONG;
+        } else if (*p == 'z' || *p == 't') {
+            p++;
+            length = LENGTH_SIZE;
+        }
+
+        char buffer[32];
+        char *end = buffer + sizeof(buffer);
+        const char *start;
+        char conversion = *p;
+        if (conversion == '\0') break;
+        p++;
+
+        switch (conversion) {
+        case 'd':
+        case 'i': {
+            int64_t value;
+            if (length == LENGTH_LLONG) value = va_arg(args, long long);
+            else if (length == LENGTH_LONG) value = va_arg(args, long);
+            else if (length == LENGTH_SIZE) value = (int64_t)(ptrdiff_t)va_arg(args, size_t);
+            else value = va_arg(args, int);
+            if (length == LENGTH_SHORT) value = (short)value;
+            else if (length == LENGTH_CHAR) value = (signed char)value;
+
+            bool negative = value < 0;
+            uint64_t magnitude = negative ? 0 - (uint64_t)value : (uint64_t)value;
+            start = magnitude <= UINT32_MAX ? convert_u32(end, (uint32_t)magnitude) : convert_u64(end, magnitude);
+            if (precision == 0 && magnitude == 0) start = end;
+            int zeros = precision > end - start ? precision - (int)(end - start) : 0;
+            if (precision >= 0) flags &= ~FLAG_ZERO;
+            out_field(&o, flags, width, sign_prefix(negative, flags), zeros, start, (size_t)(end - start));
+            break;
+        }
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o': {
+            uint64_t value;
+            if (length == LENGTH_LLONG) value = va_arg(args, unsigned long long);
+            else if (length == LENGTH_LONG) value = va_arg(args, unsigned long);
+            else if (length == LENGTH_SIZE) value = va_arg(args, size_t);
+            else value = va_arg(args, unsigned int);
+            if (length == LENGTH_SHORT) value = (unsigned short)value;
+            else if (length == LENGTH_CHAR) value = (unsigned char)value;
+
+            const char *prefix = "";
+            if (conversion == 'u') {
+                start = value <= UINT32_MAX ? convert_u32(end, (uint32_t)value) : convert_u64(end, value);
+            } else if (conversion == 'o') {
+                start = convert_octal(end, value);
+            } else {
+                start = convert_hex(end, value, conversion == 'X');
+                if ((flags & FLAG_ALT) && value) prefix = conversion == 'X' ? "0X" : "0x";
+            }
+            if (precision == 0 && value == 0) start = end;
+            int zeros = precision > end - start ? precision - (int)(end - start) : 0;
+            // Alternate octal starts with a zero, unless the precision already adds one
+            if (conversion == 'o' && (flags & FLAG_ALT) && zeros == 0 && (start == end || *start != '0')) prefix = "0";
+            if (precision >= 0) flags &= ~FLAG_ZERO;
+            out_field(&o, flags, width, prefix, zeros, start, (size_t)(end - start));
+            break;
+        }
+        case 'p': {
+            uintptr_t value = (uintptr_t)va_arg(args, void *);
+            start = convert_hex(end, value, false);
+            out_field(&o, flags, width, "0x", 0, start, (size_t)(end - start));
+            break;
+        }
+        case 'c': {
+            char c = (char)va_arg(args, int);
+            out_field(&o, flags & ~FLAG_ZERO, width, "", 0, &c, 1);
+            break;
+        }
+        case 's': {
+            const char *s = va_arg(args, const char *);
+            if (s == NULL) s = "(null)";
+            size_t n = 0;
+            if (precision >= 0) {
+                while (n < (size_t)precision && s[n]) n++;
+            } else {
+                n = strlen(s);
+            }
+            out_field(&o, flags & ~FLAG_ZERO, width, "", 0, s, n);
+            break;
+        }
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G': {
+            double value = va_arg(args, double);
+            bool upper = conversion == 'F' || conversion == 'E' || conversion == 'G';
+            uint64_t raw;
+            memcpy(&raw, &value, sizeof(raw));
+            bool negative = raw >> 63; // Also -0.0, printed with its sign
+            if (negative) value = -value;
+
+            if (value != value) {
+                start = upper ? "NAN" : "nan";
+                flags &= ~FLAG_ZERO;
+                out_field(&o, flags, width, "", 0, start, 3);
+            } else if (value >= 18446744073709551616.0) {
+                // Beyond the 64-bit integer part, also infinity
+                start = upper ? "INF" : "inf";
+                flags &= ~FLAG_ZERO;
+                out_field(&o, flags, width, sign_prefix(negative, flags), 0, start, 3);
+            } else {
+                if (precision < 0) precision = 6;
+                if (precision > FMT_MAX_PRECISION) precision = FMT_MAX_PRECISION;
+                start = convert_fixed(end, value, precision, flags & FLAG_ALT);
+                out_field(&o, flags, width, sign_prefix(negative, flags), 0, start, (size_t)(end - start));
+            }
+            break;
+        }
+        case '%':
+            out(&o, "%", 1);
+            break;
+        default:
+            // Unknown conversion, printed as written
+            out(&o, "%", 1);
+            out(&o, p - 1, 1);
+            break;
+        }
+    }
+    return o.count;
+}
+
+// -----------------------------------------------------------------------------
+// Buffer Output
+// -----------------------------------------------------------------------------
+
+static void buffer_write(void *context, const char *data, size_t length) {
+    fmt_buffer_t *b = context;
+    size_t space = b->size - b->length;
+    if (length > space) length = space;
+    memcpy(b->buffer + b->length, data, length);
+    b->length += length;
+}
+
+int fmt_vsnprintf(char *buffer, size_t size, const char *format, va_list args) {
+    fmt_buffer_t b = { buffer, size ? size - 1 : 0, 0 };
+    int count = fmt_format(buffer_write, &b, format, args);
+    if (size) buffer[b.length] = '\0';
+    return count;
+}
+
+int fmt_snprintf(char *buffer, size_t size, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int count = fmt_vsnprintf(buffer, size, format, args);
+    va_end(args);
+    return count;
+}
+
+// -----------------------------------------------------------------------------
+// Chunked Output
+// -----------------------------------------------------------------------------
+
+static void fmt_stdout(const char *data, size_t length) {
+    fwrite(data, 1, length, stdout);
+}
+
+static void chunk_write(void *context, const char *data, size_t length) {
+    fmt_chunk_t *c = context;
+    fmt_output_t output = fmt_output;
+
+    // A piece larger than the chunk skips the copy
+    if (c->length == 0 && length >= sizeof(c->data)) {
+        output(data, length);
+        return;
+    }
+    while (length) {
+        size_t n = sizeof(c->data) - c->length;
+        if (n > length) n = length;
+        memcpy(c->data + c->length, data, n);
+        c->length += n;
+        data += n;
+        length -= n;
+        if (c->length == sizeof(c->data)) {
+            output(c->data, c->length);
+            c->length = 0;
+        }
+    }
+}
+
+int fmt_vprintf(const char *format, va_list args) {
+    fmt_chunk_t c;
+    c.length = 0;
+    int count = fmt_format(chunk_write, &c, format, args);
+    if (c.length) fmt_output(c.data, c.length);
+    return count;
+}
+
+int fmt_printf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int count = fmt_vprintf(format, args);
+    va_end(args);
+    return count;
+}
+
+void fmt_set_output(fmt_output_t output) {
+    fmt_output = output ? output : fmt_stdout;
+}
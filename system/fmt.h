@@ -0,0 +1,54 @@
+#ifndef FMT_H
+#define FMT_H
+
+#include <stdarg.h>
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define FMT_CHUNK_SIZE      64 // Stack buffer of fmt_printf, flushed to the output when full
+#define FMT_MAX_PRECISION   9  // Fraction digits of %f, one 32-bit scaled integer
+
+// Lets the compiler check the arguments against the format string
+#define FMT_PRINTF(format_index, first_arg) __attribute__((format(printf, format_index, first_arg)))
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// Receives the formatted text in pieces, not NUL-terminated
+typedef void (*fmt_write_t)(void *context, const char *data, size_t length);
+
+// Destination of fmt_printf
+typedef void (*fmt_output_t)(const char *data, size_t length);
+
+// -----------------------------------------------------------------------------
+// Formatter API
+// -----------------------------------------------------------------------------
+// A printf subset without stdio, locks, heap or float library:
+//   flags - 0 + space #, width and precision (also *), length hh h l ll z j t,
+//   conversions d i u x X o c s p f F %.
+// Integers that fit 32 bits take a 32-bit path, 64-bit values one division
+// per nine digits. %f is fixed point: the integer part and the fraction
+// scaled by 10^precision, precision at most FMT_MAX_PRECISION, rounded from
+// the exact binary value so the digits (and -0.0) match the C library.
+// %e and %g print as %f. All state is on the caller's stack, so the functions are
+// reentrant and callable from interrupt handlers when the output is.
+
+// Formats to a writer, returns the number of characters produced
+int fmt_format(fmt_write_t write, void *context, const char *format, va_list args);
+
+// Formats to a buffer like vsnprintf: always NUL-terminated, returns the untruncated length
+int fmt_vsnprintf(char *buffer, size_t size, const char *format, va_list args);
+int fmt_snprintf(char *buffer, size_t size, const char *format, ...) FMT_PRINTF(3, 4);
+
+// Formats to the output in FMT_CHUNK_SIZE pieces, returns the number of characters
+int fmt_vprintf(const char *format, va_list args);
+int fmt_printf(const char *format, ...) FMT_PRINTF(1, 2);
+
+// Sets the destination of fmt_printf, NULL restores stdout
+// The default output goes through stdio and is not safe in interrupt handlers.
+void fmt_set_output(fmt_output_t output);
+
+#endif // FMT_H
@@ -0,0 +1,103 @@
+#include "hardware/gpio.h"
+
+#include "gpio_trace.h"
+#include "scheduler.h"
+#include "fmt.h"
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+uint32_t gpio_trace_value[MAX_TASKS]; // Precomputed pin values, the hooks only load them
+uint32_t gpio_trace_mask = 0;         // Trace pins, 0 if none assigned
+static int pin_base = -1;             // First trace pin
+static int pin_count = 0;             // Number of trace pins
+static gpio_trace_mode_t trace_mode = GPIO_TRACE_PULSE;
+static uint32_t traced_tasks = 0;     // Bitmask of traced tasks
+
+// Recomputes the value driven for every task
+static void update_values(void) {
+    uint32_t id_mask = (1u << pin_count) - 1;
+    for (int i = 0; i < MAX_TASKS; i++) {
+        uint32_t value = 0;
+        if ((traced_tasks & (1u << i)) && gpio_trace_mask) {
+            value = trace_mode == GPIO_TRACE_ID ? ((uint32_t)(i + 1) & id_mask) << pin_base : gpio_trace_mask;
+        }
+        gpio_trace_value[i] = value;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// GPIO Trace API
+// -----------------------------------------------------------------------------
+
+static bool pins_in_range(int base, int count) {
+    return base >= 0 && count >= 1 && count <= GPIO_TRACE_MAX_PINS && base + count <= GPIO_TRACE_NUM_GPIOS;
+}
+
+int gpio_trace_busy_pin(int base, int count) {
+    if (!pins_in_range(base, count)) return -2; // gpio_get_function would read past the bank
+    for (int pin = base; pin < base + count; pin++) {
+        if (gpio_trace_mask & (1u << pin)) continue;
+        if (gpio_get_function(pin) != GPIO_FUNC_NULL) return pin;
+    }
+    return -1;
+}
+
+bool gpio_trace_set_pins(int base, int count) {
+    // gpio_init would take a busy pin from its driver
+    if (gpio_trace_busy_pin(base, count) != -1) return false;
+
+    // The old pins are released to other drivers
+    for (int pin = pin_base; pin < pin_base + pin_count; pin++) {
+        gpio_set_function(pin, GPIO_FUNC_NULL);
+    }
+    for (int pin = base; pin < base + count; pin++) {
+        gpio_init(pin);
+        gpio_set_dir(pin, GPIO_OUT);
+    }
+    pin_base = base;
+    pin_count = count;
+    gpio_trace_mask = ((1u << count) - 1) << base;
+    sio_hw->gpio_clr = gpio_trace_mask;
+    update_values();
+    return true;
+}
+
+bool gpio_trace_has_pins(void) {
+    return gpio_trace_mask != 0;
+}
+
+void gpio_trace_set_mode(gpio_trace_mode_t mode) {
+    if (gpio_trace_mask) sio_hw->gpio_clr = gpio_trace_mask;
+    trace_mode = mode;
+    update_values();
+}
+
+bool gpio_trace_enable_task(int task_id, bool enable) {
+    if (task_id < 0 || task_id >= MAX_TASKS) return false;
+    if (enable) {
+        traced_tasks |= 1u << task_id;
+    } else {
+        traced_tasks &= ~(1u << task_id);
+    }
+    update_values();
+    return true;
+}
+
+void gpio_trace_print_status(void) {
+    fmt_printf("\n--- GPIO Trace ---\n");
+    if (!gpio_trace_mask) {
+        fmt_printf("Pins: none\n");
+    } else {
+        fmt_printf("Pins: GPIO%d-GPIO%d, mode %s\n", pin_base, pin_base + pin_count - 1,
+                   trace_mode == GPIO_TRACE_ID ? "ID" : "PULSE");
+    }
+    fmt_printf("%-5s %-10s %-10s %-10s\n", "PID", "Name", "Traced", "Pins");
+    for (int i = 0; i < scheduler_get_task_count(); i++) {
+        fmt_printf("%-5d %-10s %-10s 0x%08lx\n", i, scheduler_get_task(i)->name,
+                   (traced_tasks & (1u << i)) ? "YES" : "NO", (unsigned long)gpio_trace_value[i]);
+    }
+    if (gpio_trace_mask && trace_mode == GPIO_TRACE_ID && scheduler_get_task_count() >= (1 << pin_count)) {
+        fmt_printf("Warning: %d pins encode IDs up to %d, higher tasks alias\n", pin_count, (1 << pin_count) - 1);
+    }
+}
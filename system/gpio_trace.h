@@ -0,0 +1,68 @@
+#ifndef GPIO_TRACE_H
+#define GPIO_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hardware/structs/sio.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define GPIO_TRACE_MAX_PINS 8  // Pins of the ID bus
+#define GPIO_TRACE_NUM_GPIOS 30 // User GPIOs of the RP2040
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// What the trace pins show while a selected task runs
+typedef enum {
+    GPIO_TRACE_PULSE, // All trace pins high from dispatch to completion
+    GPIO_TRACE_ID     // Task index + 1 in binary on the trace pins, 0 between tasks
+} gpio_trace_mode_t;
+
+// State shared with the inline hooks
+extern uint32_t gpio_trace_value[]; // Pins to set when each task starts, 0 if not traced
+extern uint32_t gpio_trace_mask;    // All trace pins
+
+// -----------------------------------------------------------------------------
+// Dispatch Hooks
+// -----------------------------------------------------------------------------
+// Called by the scheduler around each task: one SIO register write each, so the
+// edges are a few cycles from the real start and end of the task.
+
+static inline void gpio_trace_task_start(int task) {
+    uint32_t value = gpio_trace_value[task];
+    if (value) sio_hw->gpio_set = value;
+}
+
+static inline void gpio_trace_task_end(int task) {
+    if (gpio_trace_value[task]) sio_hw->gpio_clr = gpio_trace_mask;
+}
+
+// -----------------------------------------------------------------------------
+// GPIO Trace API
+// -----------------------------------------------------------------------------
+
+// Returns the first of count GPIOs from base taken by another driver, -1 if all are free
+// and -2 if the pins are out of range. A pin is free while its function is still
+// GPIO_FUNC_NULL, or if it is already a trace pin.
+int gpio_trace_busy_pin(int base, int count);
+
+// Uses count consecutive GPIOs from base as trace pins, driven low
+// Fails if a pin is out of range or gpio_trace_busy_pin() finds one in use.
+bool gpio_trace_set_pins(int base, int count);
+
+// Returns true once trace pins are assigned
+bool gpio_trace_has_pins(void);
+
+// Selects what the pins show
+void gpio_trace_set_mode(gpio_trace_mode_t mode);
+
+// Enables or disables tracing of one task
+bool gpio_trace_enable_task(int task_id, bool enable);
+
+// Prints the pins, the mode and the traced tasks
+void gpio_trace_print_status(void);
+
+#endif // GPIO_TRACE_H
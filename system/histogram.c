@@ -0,0 +1,44 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "histogram.h"
+#include "fmt.h"
+
+#define HISTOGRAM_BAR_WIDTH 40 // Width of the longest bar in characters
+
+// Clears all buckets
+void histogram_reset(histogram_t *hist) {
+    memset(hist->buckets, 0, sizeof(hist->buckets));
+}
+
+// Prints the non-empty buckets with a proportional bar
+void histogram_print(const histogram_t *hist, const char *unit) {
+    histogram_print_scaled(hist, unit, 0);
+}
+
+// Same as histogram_print, with the bucket bound in cycles after the unit
+void histogram_print_scaled(const histogram_t *hist, const char *unit, uint32_t cycles_per_unit) {
+    uint32_t max_count = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (hist->buckets[i] > max_count) max_count = hist->buckets[i];
+    }
+    if (max_count == 0) {
+        fmt_printf("  (no samples)\n");
+        return;
+    }
+
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (hist->buckets[i] == 0) continue;
+        char bar[HISTOGRAM_BAR_WIDTH + 1];
+        int len = (int)(((uint64_t)hist->buckets[i] * HISTOGRAM_BAR_WIDTH + max_count - 1) / max_count);
+        memset(bar, '#', len);
+        bar[len] = '\0';
+        bool last = i == HISTOGRAM_BUCKETS - 1;
+        uint32_t bound = histogram_bucket_floor(last ? i : i + 1);
+        fmt_printf("  %s %-8lu %-3s ", last ? ">=" : "< ", (unsigned long)bound, unit);
+        if (cycles_per_unit) {
+            fmt_printf("%-12llu cyc ", (unsigned long long)bound * cycles_per_unit);
+        }
+        fmt_printf("%-10lu %s\n", (unsigned long)hist->buckets[i], bar);
+    }
+}
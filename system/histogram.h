@@ -0,0 +1,45 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define HISTOGRAM_BUCKETS 16 // Bucket i holds values in [2^(i-1), 2^i), the last bucket is open-ended
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// Logarithmic (power of two) histogram, cheap enough to update on every dispatch
+typedef struct {
+    uint32_t buckets[HISTOGRAM_BUCKETS]; // Number of samples per bucket
+} histogram_t;
+
+// -----------------------------------------------------------------------------
+// Histogram API
+// -----------------------------------------------------------------------------
+
+// Records a sample: one count-leading-zeros and one increment
+static inline void histogram_record(histogram_t *hist, uint32_t value) {
+    int bucket = value ? 32 - __builtin_clz(value) : 0;
+    if (bucket >= HISTOGRAM_BUCKETS) bucket = HISTOGRAM_BUCKETS - 1;
+    hist->buckets[bucket]++;
+}
+
+// Returns the lower bound of a bucket
+static inline uint32_t histogram_bucket_floor(int bucket) {
+    return bucket == 0 ? 0 : (1u << (bucket - 1));
+}
+
+// Clears all buckets
+void histogram_reset(histogram_t *hist);
+
+// Prints the non-empty buckets with a proportional bar
+void histogram_print(const histogram_t *hist, const char *unit);
+
+// Prints a histogram with the bucket bounds also converted to cycles (0 omits the column)
+void histogram_print_scaled(const histogram_t *hist, const char *unit, uint32_t cycles_per_unit);
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,23 @@
+#ifndef HOT_PATH_H
+#define HOT_PATH_H
+
+#include "pico/types.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+// Functions on the dispatch path and interrupt handlers are defined with
+// __hot_path_func(name). With RAM_HOT_PATH=1 (CMake option RT_RAM_HOT_PATH) they
+// are linked in the .time_critical section, which crt0 copies to SRAM, so their
+// timing no longer depends on XIP cache hits. Otherwise they stay in flash.
+#ifndef RAM_HOT_PATH
+#define RAM_HOT_PATH 0
+#endif
+
+#if RAM_HOT_PATH
+#define __hot_path_func(func_name) __not_in_flash_func(func_name)
+#else
+#define __hot_path_func(func_name) func_name
+#endif
+
+#endif // HOT_PATH_H
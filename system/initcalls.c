@@ -1,12 +1,197 @@
+#include <string.h>
+
+#include "pico/time.h"
 #include "initcalls.h"
+#include "fmt.h"
+#if INITCALL_PARALLEL
+#include "pico/multicore.h"
+#endif
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+// Bounds of the linker section, generated by the linker for section names that are C identifiers
+extern const initcall_t *const __start_initcalls[];
+extern const initcall_t *const __stop_initcalls[];
+
+static uint32_t boot_start_us = 0; // Start of initcalls()
+static uint32_t boot_end_us = 0;   // End of initcalls()
+static bool core1_busy = false;    // An initcall is running on core1
+static uint16_t started_count = 0; // Initcalls started so far
+
+static const char *level_names[INITCALL_LEVELS] = { "EARLY", "CORE", "DRIVER", "APP" };
+
+#define INITCALL_COUNT ((int)(__stop_initcalls - __start_initcalls))
+
+// -----------------------------------------------------------------------------
+// Ordering
+// -----------------------------------------------------------------------------
+
+static const initcall_t *find_initcall(const char *name, size_t length) {
+    for (int i = 0; i < INITCALL_COUNT; i++) {
+        const initcall_t *c = __start_initcalls[i];
+        if (strlen(c->name) == length && strncmp(c->name, name, length) == 0) return c;
+    }
+    return NULL;
+}
+
+// Returns true once all dependencies of an initcall have completed
+// Dependencies that cannot be honoured are recorded in the state and skipped.
+static bool dependencies_done(const initcall_t *c) {
+    const char *p = c->deps;
+    while (*p) {
+        while (*p == ',' || *p == ' ') p++;
+        const char *name = p;
+        while (*p && *p != ',' && *p != ' ') p++;
+        if (p == name) break;
+
+        const initcall_t *dep = find_initcall(name, (size_t)(p - name));
+        if (!dep) {
+            c->state->problems |= INITCALL_DEP_MISSING;
+        } else if (dep->level > c->level) {
+            c->state->problems |= INITCALL_DEP_LEVEL;
+        } else if (!dep->state->done) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Execution
+// -----------------------------------------------------------------------------
+
+static void run_initcall(const initcall_t *c, uint8_t core) {
+    c->state->core = core;
+    c->state->start_us = time_us_32();
+    c->func();
+    c->state->duration_us = time_us_32() - c->state->start_us;
+    c->state->done = true;
+}
+
+#if INITCALL_PARALLEL
+// Runs the initcalls sent by core0 until it sends NULL
+static void core1_worker(void) {
+    const initcall_t *c;
+    while ((c = (const initcall_t *)(uintptr_t)multicore_fifo_pop_blocking()) != NULL) {
+        run_initcall(c, 1);
+        multicore_fifo_push_blocking((uint32_t)(uintptr_t)c);
+    }
+}
+
+// Collects the completion of the core1 initcall, waiting for it if requested
+static void core1_collect(bool wait) {
+    if (!core1_busy || (!wait && !multicore_fifo_rvalid())) return;
+    (void)multicore_fifo_pop_blocking();
+    core1_busy = false;
+}
+#else
+static void core1_collect(bool wait) {
+    (void)wait;
+}
+#endif
+
+static void mark_started(const initcall_t *c) {
+    c->state->started = true;
+    c->state->order = started_count++;
+}
+
+// Starts an initcall on a free core, returns false if none can take it
+static bool dispatch_initcall(const initcall_t *c) {
+#if INITCALL_PARALLEL
+    if (c->flags & INITCALL_CORE1) {
+        if (core1_busy) return false;
+        mark_started(c);
+        core1_busy = true;
+        multicore_fifo_push_blocking((uint32_t)(uintptr_t)c);
+        return true;
+    }
+#endif
+    mark_started(c);
+    run_initcall(c, 0);
+    return true;
+}
+
+// Runs the initcalls of one level
+// Core0 repeatedly starts every initcall whose dependencies are done; core1 initcalls
+// go to core1 when it is free. If nothing can start and core1 is idle, the remaining
+// initcalls form a cycle: the first one runs anyway.
+static void run_level(int level) {
+    while (true) {
+        bool pending = false;
+        bool progress = false;
+        core1_collect(false);
+
+        for (int i = 0; i < INITCALL_COUNT; i++) {
+            const initcall_t *c = __start_initcalls[i];
+            if (c->level != level || c->state->started) continue;
+            pending = true;
+            if (dependencies_done(c) && dispatch_initcall(c)) progress = true;
+        }
+
+        if (!pending) break;
+        if (progress) continue;
+        if (core1_busy) {
+            core1_collect(true);
+            continue;
+        }
 
-// Initializes the head of the list to NULL
-initcall_node_t initcall_list[MAX_INITCALLS];
-int initcall_count = 0;
+        for (int i = 0; i < INITCALL_COUNT; i++) {
+            const initcall_t *c = __start_initcalls[i];
+            if (c->level != level || c->state->started) continue;
+            c->state->problems |= INITCALL_DEP_CYCLE;
+            mark_started(c);
+            run_initcall(c, 0);
+            break;
+        }
+    }
+    core1_collect(true); // The next level may depend on anything of this one
+}
+
+// -----------------------------------------------------------------------------
+// Initcalls API
+// -----------------------------------------------------------------------------
 
-// Executes all registered initialization functions
 void initcalls(void) {
-    for (int i = 0; i < initcall_count; i++) {
-        initcall_list[i].init_func(); // Execute each initialization function
+    boot_start_us = time_us_32();
+#if INITCALL_PARALLEL
+    multicore_launch_core1(core1_worker);
+#endif
+
+    for (int level = 0; level < INITCALL_LEVELS; level++) {
+        run_level(level);
+    }
+
+#if INITCALL_PARALLEL
+    multicore_fifo_push_blocking(0);
+    multicore_reset_core1(); // Leaves core1 free for the application
+#endif
+    boot_end_us = time_us_32();
+}
+
+// Prints the initcalls in execution order
+void initcalls_print_report(void) {
+    fmt_printf("\n--- Boot Timing ---\n");
+    fmt_printf("Initcalls: %d, from %lu us to %lu us after reset (%lu us), core1 %s\n", INITCALL_COUNT,
+               (unsigned long)boot_start_us, (unsigned long)boot_end_us, (unsigned long)(boot_end_us - boot_start_us),
+               INITCALL_PARALLEL ? "parallel" : "unused");
+    fmt_printf("%-7s %-28s %-5s %-10s %-10s %s\n", "Level", "Name", "Core", "Start(us)", "Time(us)", "Notes");
+
+    // Linear search per position, the table holds a few dozen entries
+    for (int n = 0; n < started_count; n++) {
+        const initcall_t *next = NULL;
+        for (int i = 0; i < INITCALL_COUNT && !next; i++) {
+            const initcall_t *c = __start_initcalls[i];
+            if (c->state->done && c->state->order == n) next = c;
+        }
+        if (!next) continue;
+
+        const initcall_state_t *s = next->state;
+        fmt_printf("%-7s %-28s %-5u %-10lu %-10lu %s%s%s\n", level_names[next->level], next->name, s->core,
+                   (unsigned long)(s->start_us - boot_start_us), (unsigned long)s->duration_us,
+                   (s->problems & INITCALL_DEP_MISSING) ? "missing-dep " : "",
+                   (s->problems & INITCALL_DEP_LEVEL) ? "dep-level " : "",
+                   (s->problems & INITCALL_DEP_CYCLE) ? "cycle" : "");
     }
+    fmt_printf("\n");
 }
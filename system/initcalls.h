@@ -1,27 +1,86 @@
 #ifndef INITCALLS_H
 #define INITCALLS_H
 
-#define MAX_INITCALLS 32
-
-// Structure for initialization functions
-typedef struct initcall_node {
-    void (*init_func)(void); // Pointer to the initialization function
-} initcall_node_t;
-
-// Array of initialization calls and counter
-extern initcall_node_t initcall_list[MAX_INITCALLS];
-extern int initcall_count;
-
-// Macro to register an initialization function
-#define REGISTER_INITCALL(func) \
-    static void __attribute__((constructor)) register_##func(void) { \
-        if (initcall_count < MAX_INITCALLS) { \
-            initcall_list[initcall_count++].init_func = func; \
-        } \
-    }
-
-// Executes all registered initialization functions
+#include <stdbool.h>
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+
+// Levels, run in increasing order; an initcall may depend on any lower level
+#define INITCALL_EARLY  0 // Clocks, counters and trace
+#define INITCALL_CORE   1 // System services and metric registrations
+#define INITCALL_DRIVER 2 // Peripherals and interrupt handlers
+#define INITCALL_APP    3 // Tasks, added to the scheduler in registration order
+#define INITCALL_LEVELS 4
+
+// Initcall flags
+#define INITCALL_CORE1  (1u << 0) // May run on core1: touches no IRQ, no registry and no other initcall state
+
+// Run INITCALL_CORE1 initcalls on core1, in parallel with core0
+#ifndef INITCALL_PARALLEL
+#if defined(PICO_ON_DEVICE) && PICO_ON_DEVICE
+#define INITCALL_PARALLEL 1
+#else
+#define INITCALL_PARALLEL 0
+#endif
+#endif
+
+// Problems found while ordering, shown by the boot report
+#define INITCALL_DEP_MISSING (1u << 0) // A dependency is not registered
+#define INITCALL_DEP_LEVEL   (1u << 1) // A dependency has a higher level, ignored
+#define INITCALL_DEP_CYCLE   (1u << 2) // Run to break a dependency cycle
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// Run-time state of an initcall
+typedef struct {
+    bool started;
+    volatile bool done;       // Set by the core that ran it
+    uint8_t core;             // Core that ran it
+    uint8_t problems;         // INITCALL_DEP_* bits
+    uint16_t order;           // Position in the start order
+    uint32_t start_us;        // Timer value at the start
+    uint32_t duration_us;     // Execution time
+} initcall_state_t;
+
+// Initcall descriptor, referenced from the "initcalls" linker section
+typedef struct {
+    const char *name;         // Function name
+    void (*func)(void);       // Initialization function
+    const char *deps;         // Names of the initcalls that must run first, comma separated
+    uint8_t level;            // INITCALL_EARLY ... INITCALL_APP
+    uint8_t flags;            // INITCALL_CORE1
+    initcall_state_t *state;
+} initcall_t;
+
+// Defines an initcall; the variadic arguments are the function names it depends on
+// The section only holds pointers, so entries stay contiguous whatever the descriptor alignment.
+#define INITCALL_DEFINE(func, lvl, flg, ...) \
+    static initcall_state_t initcall_state_##func; \
+    static const initcall_t initcall_##func = { #func, func, #__VA_ARGS__, lvl, flg, &initcall_state_##func }; \
+    static const initcall_t *const initcall_ptr_##func __attribute__((used, section("initcalls"))) = &initcall_##func
+
+// Registers an application initcall (INITCALL_APP, no dependencies)
+#define REGISTER_INITCALL(func) INITCALL_DEFINE(func, INITCALL_APP, 0)
+
+// Registers an initcall at a level, after the listed initcalls of the same level
+#define REGISTER_INITCALL_LEVEL(func, lvl, ...) INITCALL_DEFINE(func, lvl, 0, __VA_ARGS__)
+
+// Same, allowed to run on core1 in parallel with the other initcalls
+#define REGISTER_INITCALL_CORE1(func, lvl, ...) INITCALL_DEFINE(func, lvl, INITCALL_CORE1, __VA_ARGS__)
+
+// -----------------------------------------------------------------------------
+// Initcalls API
+// -----------------------------------------------------------------------------
+
+// Executes all registered initialization functions, level by level in dependency order
 void initcalls(void);
 
-#endif // INITCALLS_H
+// Prints the order, core and duration of every initcall
+void initcalls_print_report(void);
 
+#endif // INITCALLS_H
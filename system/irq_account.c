@@ -0,0 +1,100 @@
+#include <string.h>
+
+#include "pico/types.h"
+#include "irq_account.h"
+#include "metrics.h"
+#include "initcalls.h"
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+irq_stats_t irq_stats[IRQ_ACCOUNT_MAX_IRQS]; // Indexed by IRQ number
+volatile uint32_t irq_busy_cycles = 0;       // Outermost handler time, read by the scheduler
+volatile uint8_t irq_nesting = 0;            // Handlers currently active
+static uint64_t irq_busy_time = 0;           // Outermost handler time in microseconds
+
+// -----------------------------------------------------------------------------
+// Accounting Hooks
+// -----------------------------------------------------------------------------
+
+// Runs from RAM with the handlers that call it
+void __not_in_flash_func(irq_account_exit)(uint8_t irq) {
+    irq_stats_t *s = &irq_stats[irq];
+    uint32_t end_cycles = cycles_now();
+    uint32_t elapsed_us = time_us_32() - s->start_us;
+
+    s->count++;
+    s->total_time += elapsed_us;
+    if (elapsed_us > s->max_time) s->max_time = elapsed_us;
+
+    // A nested handler is already part of the one it preempted
+    if (--irq_nesting == 0) {
+        irq_busy_time += elapsed_us;
+        irq_busy_cycles += cycles_elapsed(s->start_cycles, end_cycles, elapsed_us);
+    }
+    trace_irq_exit(irq);
+}
+
+// -----------------------------------------------------------------------------
+// Interrupt Accounting API
+// -----------------------------------------------------------------------------
+
+void irq_account_register(uint8_t irq, const char *name) {
+    if (irq >= IRQ_ACCOUNT_MAX_IRQS) return;
+    irq_stats[irq].name = name;
+}
+
+const irq_stats_t *irq_account_get(uint8_t irq) {
+    if (irq >= IRQ_ACCOUNT_MAX_IRQS || irq_stats[irq].name == NULL) return NULL;
+    return &irq_stats[irq];
+}
+
+uint64_t irq_account_total_time(void) {
+    return irq_busy_time;
+}
+
+void irq_account_reset(void) {
+    for (int i = 0; i < IRQ_ACCOUNT_MAX_IRQS; i++) {
+        irq_stats_t *s = &irq_stats[i];
+        s->count = 0;
+        s->total_time = 0;
+        s->max_time = 0;
+        s->max_latency = 0;
+    }
+    irq_busy_time = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Metrics
+// -----------------------------------------------------------------------------
+
+static void collect_irq_runs(metrics_sink_t *sink) {
+    for (int i = 0; i < IRQ_ACCOUNT_MAX_IRQS; i++) {
+        if (irq_stats[i].name) metrics_sample(sink, irq_stats[i].name, irq_stats[i].count);
+    }
+}
+
+static void collect_irq_time(metrics_sink_t *sink) {
+    for (int i = 0; i < IRQ_ACCOUNT_MAX_IRQS; i++) {
+        if (irq_stats[i].name) metrics_sample(sink, irq_stats[i].name, (int64_t)irq_stats[i].total_time);
+    }
+}
+
+static void collect_irq_max_latency(metrics_sink_t *sink) {
+    for (int i = 0; i < IRQ_ACCOUNT_MAX_IRQS; i++) {
+        if (irq_stats[i].name && irq_stats[i].has_latency) metrics_sample(sink, irq_stats[i].name, irq_stats[i].max_latency);
+    }
+}
+
+static metric_t irq_metrics[] = {
+    { .name = "irq_handler_runs_total", .help = "Interrupt handler invocations", .type = METRIC_COUNTER, .label = "irq", .collect = collect_irq_runs },
+    { .name = "irq_handler_time_us_total", .help = "Time spent in each interrupt handler", .type = METRIC_COUNTER, .label = "irq", .collect = collect_irq_time },
+    { .name = "irq_latency_max_us", .help = "Longest interrupt entry latency", .type = METRIC_GAUGE, .label = "irq", .collect = collect_irq_max_latency },
+};
+
+static void irq_account_metrics_init(void) {
+    for (size_t i = 0; i < sizeof(irq_metrics) / sizeof(irq_metrics[0]); i++) {
+        metrics_register(&irq_metrics[i]);
+    }
+}
+REGISTER_INITCALL_LEVEL(irq_account_metrics_init, INITCALL_CORE);
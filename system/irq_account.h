@@ -0,0 +1,85 @@
+#ifndef IRQ_ACCOUNT_H
+#define IRQ_ACCOUNT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/time.h"
+#include "cycles.h"
+#include "trace.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define IRQ_ACCOUNT_MAX_IRQS 32 // RP2040 interrupt lines (26 used)
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// Per-interrupt statistics, shown as pseudo-task rows by scheduler_print_task_list
+typedef struct {
+    const char *name;         // Name given at registration, NULL if not accounted
+    uint32_t count;           // Handler invocations
+    uint64_t total_time;      // Cumulative handler time in microseconds
+    uint32_t max_time;        // Longest handler execution in microseconds
+    uint32_t max_latency;     // Longest delay between the event and the handler entry (us)
+    bool has_latency;         // The handler measures its entry latency
+    uint32_t start_us;        // Entry time of the running invocation
+    uint32_t start_cycles;    // Entry cycle counter of the running invocation
+} irq_stats_t;
+
+// State shared with the inline hooks
+extern irq_stats_t irq_stats[IRQ_ACCOUNT_MAX_IRQS];
+extern volatile uint32_t irq_busy_cycles;   // Cycles spent in interrupt handlers, wraps
+extern volatile uint8_t irq_nesting;        // Handlers currently active
+
+// -----------------------------------------------------------------------------
+// Accounting Hooks
+// -----------------------------------------------------------------------------
+// Called at the very start and end of an interrupt handler. Nested handlers are
+// counted in their own row and in the row of the handler they preempted, but only
+// once in irq_busy_cycles, the time the scheduler subtracts from the running task.
+
+// Handler entry
+static inline void irq_account_enter(uint8_t irq) {
+    irq_stats_t *s = &irq_stats[irq];
+    s->start_cycles = cycles_now();
+    s->start_us = time_us_32();
+    irq_nesting++;
+    trace_irq_enter(irq);
+}
+
+// Handler entry of an interrupt whose event time is known (a timer alarm);
+// latency_us is the delay since the event. Other interrupts report no latency.
+static inline void irq_account_enter_latency(uint8_t irq, uint32_t latency_us) {
+    irq_stats_t *s = &irq_stats[irq];
+    s->has_latency = true;
+    if (latency_us > s->max_latency) s->max_latency = latency_us;
+    irq_account_enter(irq);
+}
+
+// Handler exit
+void irq_account_exit(uint8_t irq);
+
+// -----------------------------------------------------------------------------
+// Interrupt Accounting API
+// -----------------------------------------------------------------------------
+
+// Gives a name to an interrupt, its row appears in the task list
+void irq_account_register(uint8_t irq, const char *name);
+
+// Returns the cycles spent in interrupt handlers so far (wrapping counter)
+static inline uint32_t irq_account_busy_cycles(void) {
+    return irq_busy_cycles;
+}
+
+// Returns the statistics of an interrupt, or NULL if it is not registered
+const irq_stats_t *irq_account_get(uint8_t irq);
+
+// Returns the total time spent in interrupt handlers, nested ones counted once (us)
+uint64_t irq_account_total_time(void);
+
+// Clears all counters, keeping the registrations
+void irq_account_reset(void);
+
+#endif // IRQ_ACCOUNT_H
@@ -0,0 +1,143 @@
+#include <string.h>
+
+#include "pico/time.h"
+#include "metrics.h"
+#include "fmt.h"
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static metric_t *metric_list[MAX_METRICS]; // Registered metrics, in registration order
+static int metric_count = 0;               // Number of registered metrics
+
+static const char *type_names[] = { "counter", "gauge", "histogram" };
+
+// -----------------------------------------------------------------------------
+// Metrics API
+// -----------------------------------------------------------------------------
+
+bool metrics_register(metric_t *metric) {
+    if (metric_count >= MAX_METRICS) return false;
+    metric_list[metric_count++] = metric;
+    return true;
+}
+
+int metrics_get_count(void) {
+    return metric_count;
+}
+
+const metric_t *metrics_find(const char *name) {
+    for (int i = 0; i < metric_count; i++) {
+        if (strcmp(metric_list[i]->name, name) == 0) return metric_list[i];
+    }
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------
+// Export
+// -----------------------------------------------------------------------------
+
+// Prints a quoted label value, escaping backslashes, quotes and newlines as JSON and Prometheus both expect
+static void print_label_value(const char *value) {
+    fmt_printf("\"");
+    const char *start = value;
+    for (const char *c = value; *c; c++) {
+        if (*c != '"' && *c != '\\' && *c != '\n') continue;
+        fmt_printf("%.*s\\%c", (int)(c - start), start, *c == '\n' ? 'n' : *c);
+        start = c + 1;
+    }
+    fmt_printf("%s\"", start);
+}
+
+void metrics_sample(metrics_sink_t *sink, const char *label_value, int64_t value) {
+    const metric_t *m = sink->metric;
+    if (sink->format == METRICS_FORMAT_JSON) {
+        if (label_value) {
+            if (sink->samples) fmt_printf(",");
+            print_label_value(label_value);
+            fmt_printf(":%lld", (long long)value);
+        } else if (sink->samples == 0) {
+            fmt_printf("%lld", (long long)value);
+        }
+    } else if (label_value && m->label) {
+        fmt_printf("%s{%s=", m->name, m->label);
+        print_label_value(label_value);
+        fmt_printf("} %lld\n", (long long)value);
+    } else {
+        fmt_printf("%s %lld\n", m->name, (long long)value);
+    }
+    sink->samples++;
+}
+
+// Bucket i counts the integer values up to 2^i - 1, the last one is unbounded
+static void export_histogram(const metric_t *m, metrics_format_t format) {
+    uint64_t count = 0;
+    if (format == METRICS_FORMAT_JSON) {
+        fmt_printf("{\"buckets\":[");
+        for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+            fmt_printf("%s%lu", i ? "," : "", (unsigned long)m->histogram->buckets[i]);
+            count += m->histogram->buckets[i];
+        }
+        fmt_printf("],\"count\":%llu}", (unsigned long long)count);
+        return;
+    }
+
+    // Prometheus buckets are cumulative; histogram_t keeps no sum, so only _count follows
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        count += m->histogram->buckets[i];
+        if (i < HISTOGRAM_BUCKETS - 1) {
+            fmt_printf("%s_bucket{le=\"%lu\"} %llu\n", m->name, (unsigned long)((1u << i) - 1), (unsigned long long)count);
+        } else {
+            fmt_printf("%s_bucket{le=\"+Inf\"} %llu\n", m->name, (unsigned long long)count);
+        }
+    }
+    fmt_printf("%s_count %llu\n", m->name, (unsigned long long)count);
+}
+
+// Prints one metric, the first of a JSON export without the separator
+static void export_metric(const metric_t *m, metrics_format_t format, bool first) {
+    bool json = format == METRICS_FORMAT_JSON;
+    metrics_sink_t sink = { format, m, 0 };
+
+    if (json) {
+        fmt_printf("%s\"%s\":", first ? "" : ",", m->name);
+    } else {
+        fmt_printf("# HELP %s %s\n# TYPE %s %s\n", m->name, m->help, m->name, type_names[m->type]);
+    }
+
+    if (m->type == METRIC_HISTOGRAM) {
+        export_histogram(m, format);
+    } else if (m->collect) {
+        if (json && m->label) fmt_printf("{");
+        m->collect(&sink);
+        if (json && m->label) fmt_printf("}");
+        if (json && !m->label && sink.samples == 0) fmt_printf("0");
+    } else {
+        metrics_sample(&sink, NULL, m->value);
+    }
+}
+
+void metrics_export_begin(metrics_export_t *progress, metrics_format_t format) {
+    progress->format = format;
+    progress->next = 0;
+}
+
+// JSON: {"uptime_us":N,"metrics":{"name":value,"labelled":{"label value":value},...}}
+bool metrics_export_step(metrics_export_t *progress) {
+    bool json = progress->format == METRICS_FORMAT_JSON;
+    if (progress->next == 0 && json) fmt_printf("{\"uptime_us\":%llu,\"metrics\":{", (unsigned long long)time_us_64());
+    if (progress->next < metric_count) {
+        export_metric(metric_list[progress->next], progress->format, progress->next == 0);
+        if (++progress->next < metric_count) return true;
+    }
+    if (json) fmt_printf("}}\n");
+    return false;
+}
+
+// Prints all metrics
+void metrics_export(metrics_format_t format) {
+    metrics_export_t progress;
+    metrics_export_begin(&progress, format);
+    while (metrics_export_step(&progress)) {
+    }
+}
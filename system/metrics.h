@@ -0,0 +1,102 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "histogram.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#ifndef MAX_METRICS
+#define MAX_METRICS 48 // Registered metrics (a collector counts once)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+typedef enum {
+    METRIC_COUNTER,  // Monotonic count, name ends in _total
+    METRIC_GAUGE,    // Current value
+    METRIC_HISTOGRAM // Power of two histogram_t
+} metric_type_t;
+
+typedef enum {
+    METRICS_FORMAT_JSON,      // One compact JSON object
+    METRICS_FORMAT_PROMETHEUS // Prometheus text exposition format
+} metrics_format_t;
+
+// Export state passed to collectors
+typedef struct {
+    metrics_format_t format;
+    const struct metric *metric; // Metric being exported
+    int samples;                 // Samples emitted for it so far
+} metrics_sink_t;
+
+// Emits the samples of a collector metric with metrics_sample()
+typedef void (*metric_collect_t)(metrics_sink_t *sink);
+
+// Position of an export printed in steps
+typedef struct {
+    metrics_format_t format;
+    int next;                    // Next metric to print
+} metrics_export_t;
+
+// A metric, statically allocated by its owner and registered once
+// Counters and gauges owned by the metric are updated with the inline functions
+// below; a collector instead reads existing state at export time (one sample per
+// task, per interrupt...) and costs nothing on the hot path.
+typedef struct metric {
+    const char *name;             // Prometheus name, with the unit (_us, _bytes, _total)
+    const char *help;             // One line description
+    metric_type_t type;
+    int64_t value;                // Value of counters and gauges without collector
+    const histogram_t *histogram; // Histogram of METRIC_HISTOGRAM
+    const char *label;            // Label name of the collected samples, NULL if unlabelled
+    metric_collect_t collect;     // Collector, NULL to export value
+} metric_t;
+
+// -----------------------------------------------------------------------------
+// Update Functions
+// -----------------------------------------------------------------------------
+// A few instructions, no locking: each metric must be updated from a single
+// context (one task, or one interrupt handler).
+
+static inline void metric_inc(metric_t *m) {
+    m->value++;
+}
+
+static inline void metric_add(metric_t *m, int64_t n) {
+    m->value += n;
+}
+
+static inline void metric_set(metric_t *m, int64_t v) {
+    m->value = v;
+}
+
+// -----------------------------------------------------------------------------
+// Metrics API
+// -----------------------------------------------------------------------------
+
+// Adds a metric to the registry, returns false if it is full
+bool metrics_register(metric_t *metric);
+
+// Emits one sample from a collector; label_value is NULL for unlabelled metrics
+void metrics_sample(metrics_sink_t *sink, const char *label_value, int64_t value);
+
+// Prints all metrics in the given format
+void metrics_export(metrics_format_t format);
+
+// The same export one metric per step; each metrics_export_step returns false
+// once the export is complete
+void metrics_export_begin(metrics_export_t *progress, metrics_format_t format);
+bool metrics_export_step(metrics_export_t *progress);
+
+// Returns the number of registered metrics
+int metrics_get_count(void);
+
+// Returns the metric with the given name, or NULL if it is not registered
+const metric_t *metrics_find(const char *name);
+
+#endif // METRICS_H
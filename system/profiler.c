@@ -0,0 +1,183 @@
+#include <string.h>
+
+#include "hardware/timer.h"
+#include "hardware/irq.h"
+#include "hardware/structs/timer.h"
+
+#include "profiler.h"
+#include "scheduler.h"
+#include "irq_account.h"
+#include "fmt.h"
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static profiler_slot_t slots[PROFILER_SLOTS]; // Open-addressing hash table of (PC, task)
+static volatile bool running = false;         // Sampling enabled
+static int alarm_num = -1;                    // Hardware alarm, claimed on first start
+static uint32_t period_us = 0;                // Sampling period
+static uint32_t sample_count = 0;             // Samples taken
+static uint32_t dropped_count = 0;            // Samples lost to a full histogram
+static uint32_t sample_hz = 0;                // Sampling rate of the last start
+
+_Static_assert((PROFILER_SLOTS & (PROFILER_SLOTS - 1)) == 0, "PROFILER_SLOTS must be a power of two");
+
+// -----------------------------------------------------------------------------
+// Sampling
+// -----------------------------------------------------------------------------
+
+// Adds one sample to the histogram
+static inline void record_sample(uint32_t pc, uint8_t task_id) {
+    // Multiplicative hash of the PC, Thumb instructions are 2-byte aligned
+    uint32_t index = ((pc >> 1) * 2654435761u + task_id) >> (32 - __builtin_ctz(PROFILER_SLOTS));
+    for (int probe = 0; probe < PROFILER_MAX_PROBES; probe++) {
+        profiler_slot_t *s = &slots[(index + probe) & (PROFILER_SLOTS - 1)];
+        if (s->pc == pc && s->task == task_id) {
+            if (s->count < UINT16_MAX) s->count++;
+            return;
+        }
+        if (s->pc == 0) {
+            s->pc = pc;
+            s->task = task_id;
+            s->count = 1;
+            return;
+        }
+    }
+    dropped_count++;
+}
+
+// Records one sample
+// Called by the alarm handler with the exception frame: r0-r3, r12, lr, pc, xpsr.
+void __not_in_flash_func(profiler_sample)(const uint32_t *frame) {
+    uint32_t now = timer_hw->timerawl;
+    irq_account_enter_latency(TIMER_IRQ_0 + alarm_num, now - timer_hw->alarm[alarm_num]);
+    timer_hw->intr = 1u << alarm_num;                  // Acknowledge the alarm
+    timer_hw->alarm[alarm_num] = now + period_us;      // Re-arm, drift is irrelevant for sampling
+
+    int task = scheduler_get_current_task();
+    sample_count++;
+    record_sample(frame[6], task < 0 ? PROFILER_NO_TASK : (uint8_t)task);
+    irq_account_exit(TIMER_IRQ_0 + alarm_num);
+}
+
+// Alarm interrupt entry
+// The exception frame is on the main or process stack depending on EXC_RETURN
+// bit 2; the handler passes it to profiler_sample and returns through it.
+static void __attribute__((naked)) profiler_irq_handler(void) {
+    __asm volatile(
+        "movs r0, #4        \n"
+        "mov  r1, lr        \n"
+        "tst  r0, r1        \n"
+        "beq  1f            \n"
+        "mrs  r0, psp       \n"
+        "b    2f            \n"
+        "1:                 \n"
+        "mrs  r0, msp       \n"
+        "2:                 \n"
+        "ldr  r1, =profiler_sample \n"
+        "bx   r1            \n"
+    );
+}
+
+// -----------------------------------------------------------------------------
+// Profiler API
+// -----------------------------------------------------------------------------
+
+bool profiler_start(uint32_t hz) {
+    if (hz == 0) return false;
+    if (hz > PROFILER_MAX_HZ) hz = PROFILER_MAX_HZ;
+
+    if (alarm_num < 0) {
+        alarm_num = hardware_alarm_claim_unused(false);
+        if (alarm_num < 0) return false;
+        irq_set_exclusive_handler(TIMER_IRQ_0 + alarm_num, profiler_irq_handler);
+        irq_set_priority(TIMER_IRQ_0 + alarm_num, PICO_HIGHEST_IRQ_PRIORITY);
+        irq_account_register(TIMER_IRQ_0 + alarm_num, "PROF");
+    }
+
+    profiler_stop();
+    memset(slots, 0, sizeof(slots));
+    sample_count = 0;
+    dropped_count = 0;
+    sample_hz = hz;
+    period_us = 1000000u / hz;
+
+    running = true;
+    timer_hw->intr = 1u << alarm_num;
+    hw_set_bits(&timer_hw->inte, 1u << alarm_num);
+    irq_set_enabled(TIMER_IRQ_0 + alarm_num, true);
+    timer_hw->alarm[alarm_num] = timer_hw->timerawl + period_us;
+    return true;
+}
+
+void profiler_stop(void) {
+    if (alarm_num < 0) return;
+    irq_set_enabled(TIMER_IRQ_0 + alarm_num, false);
+    hw_clear_bits(&timer_hw->inte, 1u << alarm_num);
+    timer_hw->armed = 1u << alarm_num; // Disarms a pending alarm
+    running = false;
+}
+
+bool profiler_is_running(void) {
+    return running;
+}
+
+// Prints the number of samples per task
+void profiler_print_summary(void) {
+    uint32_t per_task[MAX_TASKS + 1] = {0};
+    for (int i = 0; i < PROFILER_SLOTS; i++) {
+        if (slots[i].pc == 0) continue;
+        int t = slots[i].task == PROFILER_NO_TASK ? MAX_TASKS : slots[i].task;
+        if (t <= MAX_TASKS) per_task[t] += slots[i].count;
+    }
+
+    fmt_printf("\n--- Profiler ---\n");
+    fmt_printf("State: %s, %lu Hz, %lu samples, %lu dropped\n", running ? "running" : "stopped",
+               (unsigned long)sample_hz, (unsigned long)sample_count, (unsigned long)dropped_count);
+    fmt_printf("%-5s %-10s %-10s %-8s\n", "PID", "Name", "Samples", "Share");
+    for (int i = 0; i <= scheduler_get_task_count(); i++) {
+        // The last row collects the scheduler loop and idle time
+        int t = i < scheduler_get_task_count() ? i : MAX_TASKS;
+        uint32_t permille = sample_count ? (uint32_t)((uint64_t)per_task[t] * 1000 / sample_count) : 0;
+        fmt_printf("%-5d %-10s %-10lu %lu.%lu%%\n", t == MAX_TASKS ? -1 : t, t == MAX_TASKS ? "(sched)" : scheduler_get_task(t)->name,
+                   (unsigned long)per_task[t], (unsigned long)(permille / 10), (unsigned long)(permille % 10));
+    }
+}
+
+void profiler_dump_begin(profiler_dump_t *dump) {
+    profiler_stop();
+    dump->line = 0;
+    dump->slot = 0;
+}
+
+// Lines: PROF BEGIN, one TASK per task, one S per used slot, PROF END
+bool profiler_dump_step(profiler_dump_t *dump) {
+    if (dump->line == 0) {
+        fmt_printf("PROF BEGIN samples=%lu dropped=%lu hz=%lu\n",
+                   (unsigned long)sample_count, (unsigned long)dropped_count, (unsigned long)sample_hz);
+        dump->line = scheduler_get_task_count() > 0 ? 1 : -1;
+        return true;
+    }
+    if (dump->line > 0) {
+        fmt_printf("TASK %d %s\n", dump->line - 1, scheduler_get_task(dump->line - 1)->name);
+        dump->line = dump->line < scheduler_get_task_count() ? dump->line + 1 : -1;
+        return true;
+    }
+
+    while (dump->slot < PROFILER_SLOTS && slots[dump->slot].pc == 0) dump->slot++;
+    if (dump->slot == PROFILER_SLOTS) {
+        fmt_printf("PROF END\n");
+        return false;
+    }
+    const profiler_slot_t *s = &slots[dump->slot++];
+    fmt_printf("S %08lx %d %u\n", (unsigned long)s->pc, s->task == PROFILER_NO_TASK ? -1 : s->task, s->count);
+    return true;
+}
+
+// Prints the histogram, one slot per line
+void profiler_dump(void) {
+    profiler_dump_t dump;
+    profiler_dump_begin(&dump);
+    while (profiler_dump_step(&dump)) {
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define PROFILER_SLOTS          512   // (PC, task) pairs held by the histogram, power of two
+#define PROFILER_MAX_PROBES     8     // Hash probes before a sample is dropped
+#define PROFILER_DEFAULT_HZ     1000  // Default sampling rate
+#define PROFILER_MAX_HZ         10000 // Upper bound of the sampling rate, keeps the overhead below ~1%
+#define PROFILER_NO_TASK        0xFF  // Task index of samples taken outside of a dispatch
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// Histogram slot: number of samples of one PC while one task was running
+typedef struct {
+    uint32_t pc;     // Interrupted program counter, 0 for a free slot
+    uint16_t count;  // Samples, saturating
+    uint8_t task;    // Task index, PROFILER_NO_TASK for the scheduler loop and idle time
+} profiler_slot_t;
+
+// Position of a dump printed in steps
+typedef struct {
+    int line;        // Next header line, then -1
+    int slot;        // Next histogram slot to print
+} profiler_dump_t;
+
+// -----------------------------------------------------------------------------
+// Profiler API
+// -----------------------------------------------------------------------------
+// A hardware timer alarm interrupts the CPU at the sampling rate. The handler reads
+// the program counter from the exception stack frame, so the sample is the code that
+// was running, including other interrupt handlers (the alarm has the highest priority).
+
+// Clears the histogram and starts sampling at hz (clamped to PROFILER_MAX_HZ)
+bool profiler_start(uint32_t hz);
+
+// Stops sampling, the histogram is kept
+void profiler_stop(void);
+
+// Returns true while sampling
+bool profiler_is_running(void);
+
+// Prints a summary (samples per task)
+void profiler_print_summary(void);
+
+// Stops sampling and prints the histogram between PROF BEGIN and PROF END
+// The output is mapped to functions by tools/prof_symbolize.py with the RT ELF.
+void profiler_dump(void);
+
+// The same dump one line per step: profiler_dump_begin stops sampling, each
+// profiler_dump_step prints the next line and returns false after PROF END
+void profiler_dump_begin(profiler_dump_t *dump);
+bool profiler_dump_step(profiler_dump_t *dump);
+
+#endif // PROFILER_H
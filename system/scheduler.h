@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "pico/time.h"
+#include "histogram.h"
 
 // -----------------------------------------------------------------------------
 // Macros and Constants
@@ -11,8 +12,16 @@
 #define RP2040_TOTAL_RAM        (264 * 1024) // Total RAM of RP2040 (264 KB = 270336 bytes)
 #define STACK_FILL_VALUE        (0xAA)       // Value used to fill task stacks for usage monitoring
 #define TASK_STACK_SIZE         1024         // Stack size for each task in bytes
-#define MAX_TASKS               10           // Maximum number of tasks supported
+#ifndef MAX_TASKS
+#define MAX_TASKS               10           // Maximum number of tasks supported (overridable by the build)
+#endif
 #define PRIORITY_NORMALIZATION_INTERVAL 100  // Interval for priority normalization (in iterations)
+#define MAX_CHAINS              4            // Maximum number of task chains
+#define CHAIN_NONE              (-1)         // Chain index of a task that is not part of a chain
+
+#if MAX_TASKS > 32
+#error "MAX_TASKS must not exceed 32: chain and release sets are 32-bit task masks"
+#endif
 
 // -----------------------------------------------------------------------------
 // Definitions and Types
@@ -29,7 +38,8 @@ typedef enum {
     SCHED_ERR_OK = 0,          // No error
     SCHED_ERR_FULL,            // Maximum number of tasks reached
     SCHED_ERR_INVALID_INDEX,   // Invalid task index provided
-    SCHED_ERR_INVALID_PARAMS   // Invalid parameters for task or function
+    SCHED_ERR_INVALID_PARAMS,  // Invalid parameters for task or function
+    SCHED_ERR_CHAIN            // Invalid chain topology (cycle, foreign task or head as successor)
 } sched_error_t;
 
 // Scheduling algorithms
@@ -38,12 +48,33 @@ typedef enum {
     SCHED_ALGO_ROUND_ROBIN,            // Round-robin scheduling
     SCHED_ALGO_EARLIEST_DEADLINE_FIRST, // Earliest deadline first
     SCHED_ALGO_LEAST_EXECUTED,         // Least executed task scheduling
-    SCHED_ALGO_LONGEST_WAITING         // Longest waiting task scheduling
+    SCHED_ALGO_LONGEST_WAITING,        // Longest waiting task scheduling
+    SCHED_ALGO_AUTO                    // Adaptive selection among the algorithms above
 } sched_algorithm_t;
 
+#define SCHED_ALGO_COUNT SCHED_ALGO_AUTO // Number of concrete (non-adaptive) algorithms
+
 // Task function type
 typedef void (*task_func_t)(void); // Function pointer type for task functions
 
+// Per-algorithm statistics of a task
+typedef struct {
+    int exec_count;                  // Executions while the algorithm was active
+    int64_t total_exec_time;         // Cumulative execution time
+    int64_t max_exec_time;           // Maximum execution time
+    int64_t min_exec_time;           // Minimum execution time
+    int64_t total_jitter;            // Cumulative jitter
+    int64_t max_jitter;              // Maximum jitter
+    int deadline_misses;             // Deadline misses
+} task_stats_t;
+
+// Epoch statistics of an algorithm (an epoch is a period in which the algorithm is active)
+typedef struct {
+    int epochs;                      // Number of epochs in which the algorithm was active
+    int64_t active_time;             // Duration of the closed epochs in microseconds
+    int64_t busy_time;               // Task execution time while the algorithm was active
+} sched_epoch_stats_t;
+
 // Task structure
 typedef struct {
     const char *name;                // Name of the task
@@ -60,9 +91,48 @@ typedef struct {
     int64_t max_jitter;              // Maximum recorded jitter
     int64_t min_exec_time;           // Minimum recorded execution time
     int64_t total_jitter;            // Cumulative jitter across executions
+    int deadline_misses;             // Executions completed after their implicit deadline (release + interval)
     size_t memory_allocated;         // Static memory allocated to the task
+    int64_t max_exec_budget;         // Supervision: maximum allowed execution time (0 = unsupervised)
+    int64_t max_release_gap;         // Supervision: maximum allowed time between executions (0 = unsupervised)
+    int chain_id;                    // Chain the task belongs to (CHAIN_NONE if independent)
+    uint32_t successors;             // Bitmask of tasks released when this task completes
+    int predecessors;                // Number of predecessors in the chain
+    int pending_predecessors;        // Predecessors still to complete in the current chain activation
+    bool released;                   // Successor released by its predecessors, ready to run
+    absolute_time_t release_time;    // Time at which the successor was released
+    int input_from;                  // Predecessor whose completion released this task
+    const void *output;              // Buffer handed over to the successors
+    size_t output_size;              // Size of the handed over buffer
+    task_stats_t epoch_stats[SCHED_ALGO_COUNT]; // Statistics bucketed by active algorithm
+    uint64_t total_exec_cycles;      // Cycle timing: cumulative execution time in CPU cycles
+    uint32_t min_exec_cycles;        // Cycle timing: minimum execution time in CPU cycles
+    uint32_t max_exec_cycles;        // Cycle timing: maximum execution time in CPU cycles
+    int cycle_count;                 // Cycle timing: executions measured in cycles
+    histogram_t exec_cycles_histogram; // Cycle timing: distribution of the execution time (cycles)
 } task_t;
 
+// Task chain structure
+// The head task is released periodically, every other member is released as soon as
+// all its predecessors have completed. Latency is measured from the start of the head
+// to the completion of the last sink (member without successors).
+typedef struct {
+    const char *name;                // Name of the chain
+    int head;                        // Index of the periodic head task
+    uint32_t members;                // Bitmask of member tasks
+    int sink_count;                  // Number of members without successors
+    int64_t deadline;                // End-to-end deadline in microseconds
+    bool active;                     // True while an activation is in progress
+    absolute_time_t start_time;      // Start of the current activation
+    int sinks_pending;               // Sinks still to complete in the current activation
+    int activations;                 // Number of completed activations
+    int deadline_misses;             // Activations that exceeded the deadline
+    int64_t total_latency;           // Cumulative end-to-end latency
+    int64_t max_latency;             // Maximum end-to-end latency
+    int64_t min_latency;             // Minimum end-to-end latency
+    histogram_t latency_histogram;   // Distribution of the end-to-end latency (us)
+} task_chain_t;
+
 // -----------------------------------------------------------------------------
 // Scheduler API
 // -----------------------------------------------------------------------------
@@ -76,18 +146,99 @@ sched_error_t scheduler_set_task_priority(int task_index, int new_priority);
 // Sets the interval of a specific task
 sched_error_t scheduler_set_task_interval(int task_index, int64_t new_interval);
 
+// Sets the supervision limits of a specific task (0 disables the corresponding check)
+sched_error_t scheduler_set_task_supervision(int task_index, int64_t max_exec_budget, int64_t max_release_gap);
+
 // Pauses a specific task
 sched_error_t scheduler_pause_task(int task_index);
 
 // Resumes a specific task
 sched_error_t scheduler_resume_task(int task_index);
 
-// Changes the active scheduling algorithm
+// Changes the active scheduling algorithm, applied atomically between two dispatches
 sched_error_t scheduler_set_algorithm(sched_algorithm_t algorithm);
 
-// Retrieves the currently active scheduling algorithm
+// Clears all task statistics and per-algorithm epochs
+void scheduler_reset_statistics(void);
+
+// Returns the epoch statistics of an algorithm
+const sched_epoch_stats_t *scheduler_get_epoch_stats(sched_algorithm_t algorithm);
+
+// Prints the per-algorithm statistics of every task
+void scheduler_print_epoch_comparison(void);
+
+// Retrieves the selected scheduling algorithm (may be SCHED_ALGO_AUTO)
 sched_algorithm_t scheduler_get_algorithm(void);
 
+// Retrieves the algorithm actually used for task selection (never SCHED_ALGO_AUTO)
+sched_algorithm_t scheduler_get_active_algorithm(void);
+
+// Switches the active algorithm between two dispatches, without pausing tasks or
+// resetting statistics. Used by the AUTO mode.
+sched_error_t scheduler_switch_algorithm(sched_algorithm_t algorithm);
+
+// Converts an algorithm to a readable string
+const char *scheduler_algorithm_to_string(sched_algorithm_t algorithm);
+
+// Returns the index of the task with the given name, or -1 if not found
+int scheduler_find_task(const char *name);
+
+// Creates a task chain whose head is released periodically
+sched_error_t scheduler_chain_create(const char *name, int head_task, int64_t deadline, int *chain_id);
+
+// Adds an edge to a chain: to_task is released when from_task (and its other predecessors) complete
+sched_error_t scheduler_chain_link(int chain_id, int from_task, int to_task);
+
+// Publishes the output buffer of the running chain task to its successors (zero-copy)
+void scheduler_chain_handoff(const void *data, size_t size);
+
+// Returns the buffer handed over by the predecessor that released the running task
+const void *scheduler_chain_input(size_t *size);
+
+// Returns the number of chains and a read-only view of a chain
+int scheduler_get_chain_count(void);
+const task_chain_t *scheduler_get_chain(int chain_id);
+
+// Prints end-to-end latency statistics for all chains
+void scheduler_print_chain_list(void);
+
+// Returns the cumulative execution time of all tasks in microseconds
+int64_t scheduler_get_busy_time(void);
+
+// Returns the minimum deadline slack observed since the previous call and restarts the measurement
+// (INT64_MAX if no periodic task has run in the meantime)
+int64_t scheduler_take_min_slack(void);
+
+// Returns the number of registered tasks
+int scheduler_get_task_count(void);
+
+// Returns a read-only view of a task, or NULL for an invalid index
+const task_t *scheduler_get_task(int task_index);
+
+// Enables or disables cycle-resolution timing (SysTick), clearing the cycle statistics
+void scheduler_set_cycle_timing(bool enabled);
+
+// Returns true if execution times are also measured in CPU cycles
+bool scheduler_get_cycle_timing(void);
+
+// Prints the execution time histogram of every task in CPU cycles
+void scheduler_print_cycle_histograms(void);
+
+// Returns the index of the task being executed, or -1 outside of a dispatch
+int scheduler_get_current_task(void);
+
+// Returns the task an algorithm would dispatch now, without dispatching it (used by benchmarks)
+int scheduler_peek_next_task(sched_algorithm_t algorithm);
+
+// Returns the time until the next periodic release of another task (us), 0 if one is ready
+int64_t scheduler_get_idle_window(void);
+
+// Prepares the scheduler loop (watchdog, first epoch), called by scheduler_run
+void scheduler_start(void);
+
+// Runs one iteration of the scheduler loop. Returns the dispatched task index, or -1 if idle.
+int scheduler_run_once(void);
+
 // Main loop of the scheduler that manages task execution
 void scheduler_run(void);
 
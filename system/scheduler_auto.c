@@ -0,0 +1,196 @@
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+
+#include "scheduler_auto.h"
+#include "hot_path.h"
+#include "fmt.h"
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static absolute_time_t window_start;                 // Start of the current window
+static int dwell_windows = 0;                        // Windows spent on the active algorithm
+static int score[SCHED_ALGO_COUNT];                  // Smoothed score per algorithm, -1 if never observed
+static int score_age[SCHED_ALGO_COUNT];              // Windows since the score was last updated
+static sched_auto_window_t last_window;               // Observations of the last window
+static sched_auto_decision_t decision_log[SCHED_AUTO_LOG_SIZE]; // Ring buffer of decisions
+static int decision_count = 0;                       // Total number of decisions
+
+// Counters at the start of the window, used to compute deltas
+static int prev_exec_count[MAX_TASKS];
+static int prev_misses[MAX_TASKS];
+static int64_t prev_jitter[MAX_TASKS];
+
+// Algorithms AUTO chooses from, in the order they are first tried.
+// LONGEST_WAITING and LEAST_EXECUTED ignore the task intervals and starve the
+// periodic tasks under load, so they are never explored.
+static const sched_algorithm_t candidates[] = {
+    SCHED_ALGO_EARLIEST_DEADLINE_FIRST,
+    SCHED_ALGO_PRIORITY,
+    SCHED_ALGO_ROUND_ROBIN
+};
+#define CANDIDATE_COUNT ((int)(sizeof(candidates) / sizeof(candidates[0])))
+
+// Takes a snapshot of the task counters at the start of a window
+static void snapshot_counters(void) {
+    for (int i = 0; i < scheduler_get_task_count(); i++) {
+        const task_t *t = scheduler_get_task(i);
+        prev_exec_count[i] = t->exec_count;
+        prev_misses[i] = t->deadline_misses;
+        prev_jitter[i] = t->total_jitter;
+    }
+}
+
+// Restarts the evaluation, keeping the task statistics
+void scheduler_auto_reset(void) {
+    for (int i = 0; i < SCHED_ALGO_COUNT; i++) {
+        score[i] = -1;
+        score_age[i] = 0;
+    }
+    dwell_windows = 0;
+    memset(&last_window, 0, sizeof(last_window));
+    window_start = get_absolute_time();
+    snapshot_counters();
+}
+
+// Computes the observations of the window that just elapsed
+// PS RESET can clear the statistics mid-window, in which case the deltas
+// would be negative and the task is skipped for this window.
+static void evaluate_window(absolute_time_t current_time, sched_auto_window_t *w) {
+    int jitter_tasks = 0;
+    int64_t jitter_sum = 0;
+
+    memset(w, 0, sizeof(*w));
+    for (int i = 0; i < scheduler_get_task_count(); i++) {
+        const task_t *t = scheduler_get_task(i);
+        int execs = t->exec_count - prev_exec_count[i];
+        int misses = t->deadline_misses - prev_misses[i];
+        int64_t jitter = t->total_jitter - prev_jitter[i];
+        if (t->state == TASK_PAUSED || execs < 0 || misses < 0 || jitter < 0) continue;
+
+        w->deadline_misses += misses;
+
+        // Event-driven chain members have no interval to starve against
+        bool periodic = t->chain_id == CHAIN_NONE || scheduler_get_chain(t->chain_id)->head == i;
+        if (periodic && absolute_time_diff_us(t->last_execution, current_time) > SCHED_AUTO_STARVATION_RATIO * t->interval) {
+            w->starved_tasks++;
+        }
+
+        if (execs > 0 && t->interval > 0) {
+            jitter_sum += (jitter / execs) * 1000 / t->interval;
+            jitter_tasks++;
+        }
+    }
+
+    w->jitter_permille = jitter_tasks > 0 ? (int)(jitter_sum / jitter_tasks) : 0;
+    w->score = w->deadline_misses * SCHED_AUTO_WEIGHT_MISS +
+               w->starved_tasks * SCHED_AUTO_WEIGHT_STARVED +
+               w->jitter_permille;
+}
+
+// Appends a decision to the log
+static void log_decision(absolute_time_t current_time, sched_algorithm_t from, sched_algorithm_t to, const sched_auto_window_t *w) {
+    sched_auto_decision_t *d = &decision_log[decision_count % SCHED_AUTO_LOG_SIZE];
+    d->time_ms = (uint32_t)(to_us_since_boot(current_time) / 1000);
+    d->from = from;
+    d->to = to;
+    d->window = *w;
+    decision_count++;
+}
+
+// Returns true if AUTO may choose an algorithm
+static bool is_candidate(sched_algorithm_t algorithm) {
+    for (int i = 0; i < CANDIDATE_COUNT; i++) {
+        if (candidates[i] == algorithm) return true;
+    }
+    return false;
+}
+
+// Picks the algorithm to use for the next window
+// A healthy algorithm (no misses, no starvation) is kept, and so is any algorithm
+// for the minimum dwell time. Never observed candidates are explored first, then
+// the candidate with the best score is chosen if it beats the active one by the
+// hysteresis margin. Scores only change while their algorithm runs, so once every
+// candidate has been measured the choice settles instead of cycling, until a score
+// older than SCHED_AUTO_SCORE_MAX_AGE windows expires and its candidate is explored
+// again under the current load mix.
+static sched_algorithm_t choose_algorithm(sched_algorithm_t current, const sched_auto_window_t *w) {
+    if (w->deadline_misses == 0 && w->starved_tasks == 0) return current;
+    if (dwell_windows < SCHED_AUTO_MIN_DWELL) return current;
+
+    for (int i = 0; i < CANDIDATE_COUNT; i++) {
+        if (score[candidates[i]] < 0) return candidates[i];
+    }
+
+    sched_algorithm_t best = candidates[0];
+    for (int i = 1; i < CANDIDATE_COUNT; i++) {
+        if (score[candidates[i]] < score[best]) best = candidates[i];
+    }
+    if (!is_candidate(current)) return best;
+    if (best != current && score[best] * 100 < score[current] * (100 - SCHED_AUTO_HYSTERESIS_PCT)) {
+        return best;
+    }
+    return current;
+}
+
+// Evaluates a window when it has elapsed and switches algorithm if needed
+void __hot_path_func(scheduler_auto_poll)(absolute_time_t current_time) {
+    if (absolute_time_diff_us(window_start, current_time) < SCHED_AUTO_WINDOW_US) {
+        return;
+    }
+
+    sched_algorithm_t current = scheduler_get_active_algorithm();
+    evaluate_window(current_time, &last_window);
+
+    // Smooth the score of the active algorithm; the others keep their last measurement
+    // until it is too old to describe the current load
+    score[current] = score[current] < 0 ? last_window.score : (score[current] + last_window.score) / 2;
+    score_age[current] = 0;
+    for (int i = 0; i < SCHED_ALGO_COUNT; i++) {
+        if (score[i] >= 0 && i != (int)current && ++score_age[i] >= SCHED_AUTO_SCORE_MAX_AGE) score[i] = -1;
+    }
+    dwell_windows++;
+
+    sched_algorithm_t next = choose_algorithm(current, &last_window);
+    if (next != current) {
+        log_decision(current_time, current, next, &last_window);
+        scheduler_switch_algorithm(next);
+        dwell_windows = 0;
+    }
+
+    window_start = current_time;
+    snapshot_counters();
+}
+
+// Prints the per-algorithm scores and the decision log
+void scheduler_auto_print_log(void) {
+    fmt_printf("\n--- Adaptive Scheduling ---\n");
+    fmt_printf("Selected: %s, active: %s\n",
+               scheduler_algorithm_to_string(scheduler_get_algorithm()),
+               scheduler_algorithm_to_string(scheduler_get_active_algorithm()));
+    fmt_printf("Last window: misses %d, starved %d, jitter %d permille, score %d\n\n",
+               last_window.deadline_misses, last_window.starved_tasks, last_window.jitter_permille, last_window.score);
+
+    fmt_printf("%-25s %-10s\n", "Algorithm", "Score");
+    for (int i = 0; i < SCHED_ALGO_COUNT; i++) {
+        if (score[i] < 0) {
+            fmt_printf("%-25s %-10s\n", scheduler_algorithm_to_string((sched_algorithm_t)i), "-");
+        } else {
+            fmt_printf("%-25s %-10d\n", scheduler_algorithm_to_string((sched_algorithm_t)i), score[i]);
+        }
+    }
+
+    fmt_printf("\n%-10s %-25s %-25s %-8s %-8s %-8s %-8s\n", "Time(ms)", "From", "To", "Misses", "Starved", "Jitter", "Score");
+    int first = decision_count > SCHED_AUTO_LOG_SIZE ? decision_count - SCHED_AUTO_LOG_SIZE : 0;
+    for (int n = first; n < decision_count; n++) {
+        const sched_auto_decision_t *d = &decision_log[n % SCHED_AUTO_LOG_SIZE];
+        fmt_printf("%-10lu %-25s %-25s %-8d %-8d %-8d %-8d\n",
+                   (unsigned long)d->time_ms,
+                   scheduler_algorithm_to_string(d->from),
+                   scheduler_algorithm_to_string(d->to),
+                   d->window.deadline_misses, d->window.starved_tasks,
+                   d->window.jitter_permille, d->window.score);
+    }
+    fmt_printf("\n");
+}
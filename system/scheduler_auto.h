@@ -0,0 +1,57 @@
+#ifndef SCHEDULER_AUTO_H
+#define SCHEDULER_AUTO_H
+
+#include <stdint.h>
+#include "pico/time.h"
+#include "scheduler.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define SCHED_AUTO_WINDOW_US        1000000 // Length of an evaluation window
+#define SCHED_AUTO_MIN_DWELL        3       // Windows to stay on an algorithm before switching again
+#define SCHED_AUTO_STARVATION_RATIO 4       // A ready task waiting this many intervals is starving
+#define SCHED_AUTO_HYSTERESIS_PCT   20      // An alternative must score this much better to be chosen
+#define SCHED_AUTO_LOG_SIZE         16      // Number of decisions kept in the log
+#define SCHED_AUTO_SCORE_MAX_AGE    30      // Windows after which an inactive algorithm's score expires
+
+// Score weights: one miss or one starving task weighs as much as 10% average jitter
+#define SCHED_AUTO_WEIGHT_MISS      100
+#define SCHED_AUTO_WEIGHT_STARVED   100
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// Observations of one evaluation window
+typedef struct {
+    int deadline_misses;      // Deadline misses of all tasks
+    int starved_tasks;        // Ready tasks that did not run for SCHED_AUTO_STARVATION_RATIO intervals
+    int jitter_permille;      // Average jitter relative to the task interval (1/1000)
+    int score;                // Weighted cost, lower is better
+} sched_auto_window_t;
+
+// Entry of the decision log
+typedef struct {
+    uint32_t time_ms;         // Uptime of the decision
+    sched_algorithm_t from;   // Algorithm before the decision
+    sched_algorithm_t to;     // Algorithm after the decision
+    sched_auto_window_t window; // Observations that triggered the decision
+} sched_auto_decision_t;
+
+// -----------------------------------------------------------------------------
+// Adaptive Selection API
+// -----------------------------------------------------------------------------
+
+// Forgets all scores and restarts the evaluation (called when AUTO is selected)
+// The active algorithm is kept until the first window shows misses or starvation.
+void scheduler_auto_reset(void);
+
+// Evaluates a window when it has elapsed and switches algorithm if needed.
+// Called from the scheduler loop, costs a single time comparison between windows.
+void scheduler_auto_poll(absolute_time_t current_time);
+
+// Prints the per-algorithm scores and the decision log
+void scheduler_auto_print_log(void);
+
+#endif // SCHEDULER_AUTO_H
@@ -1,4 +1,3 @@
-#include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
@@ -7,6 +6,16 @@
 #include "pico/stdlib.h"
 #include "pico/time.h"
 #include "scheduler.h"
+#include "supervisor.h"
+#include "trace.h"
+#include "cycles.h"
+#include "irq_account.h"
+#include "gpio_trace.h"
+#include "metrics.h"
+#include "initcalls.h"
+#include "hot_path.h"
+#include "scheduler_auto.h"
+#include "fmt.h"
 
 // -----------------------------------------------------------------------------
 // Variables for State and Statistics
@@ -14,8 +23,21 @@
 static task_t task_list[MAX_TASKS]; // List of all tasks
 static int task_count = 0; // Total number of tasks
 static sched_algorithm_t selected_algorithm = SCHED_ALGO_ROUND_ROBIN; // Current scheduling algorithm
+static sched_algorithm_t active_algorithm = SCHED_ALGO_ROUND_ROBIN; // Algorithm used for selection (resolves AUTO)
+static volatile int pending_algorithm = -1; // Algorithm to activate before the next dispatch, -1 if none
+static sched_epoch_stats_t epoch_list[SCHED_ALGO_COUNT] = { [SCHED_ALGO_ROUND_ROBIN] = { .epochs = 1 } }; // Epochs per algorithm
+static absolute_time_t epoch_start; // Start of the current epoch
 static int priority_normalization_counter = 0; // Counter for priority normalization
 static int64_t global_total_task_time = 0; // Total execution time of all tasks
+static absolute_time_t last_supervision_check; // Timestamp of the last release-gap check
+static int64_t min_slack = INT64_MAX; // Minimum deadline slack since the last scheduler_take_min_slack()
+static task_chain_t chain_list[MAX_CHAINS]; // List of all task chains
+static int chain_count = 0; // Total number of chains
+static metric_t metric_dispatches = { .name = "sched_dispatch_total", .help = "Task dispatches", .type = METRIC_COUNTER };
+static metric_t metric_idle = { .name = "sched_idle_total", .help = "Scheduler passes without a ready task", .type = METRIC_COUNTER };
+static uint32_t released_tasks = 0; // Bitmask of chain successors released and waiting to run
+static bool cycle_timing = false; // Execution times also measured in CPU cycles (SysTick)
+static int current_task_index = -1; // Task being executed, -1 outside of a dispatch
 
 // Stack for each task
 static uint8_t task_stacks[MAX_TASKS][TASK_STACK_SIZE];
@@ -27,6 +49,7 @@ static int find_round_robin_task(absolute_time_t current_time);
 static int find_earliest_deadline_task(absolute_time_t current_time);
 static int find_least_executed_task(absolute_time_t current_time);
 static int find_longest_waiting_task(absolute_time_t current_time);
+static void chain_abort(task_chain_t *chain);
 
 // Array of scheduling algorithm functions indexed by the algorithm type
 // Used dynamically to invoke the correct algorithm based on configuration
@@ -59,6 +82,37 @@ static int calculate_stack_usage(const uint8_t *stack, size_t size) {
     return used;
 }
 
+// Per-algorithm statistics buckets:
+// Every dispatch is also accounted in the bucket of the active algorithm.
+
+// Clears the statistics buckets of a task
+static void reset_task_stats(task_stats_t *stats) {
+    memset(stats, 0, sizeof(task_stats_t) * SCHED_ALGO_COUNT);
+    for (int a = 0; a < SCHED_ALGO_COUNT; a++) {
+        stats[a].min_exec_time = INT64_MAX;
+    }
+}
+
+// Clears the cycle statistics of a task
+static void reset_cycle_stats(task_t *t) {
+    t->total_exec_cycles = 0;
+    t->min_exec_cycles = UINT32_MAX;
+    t->max_exec_cycles = 0;
+    t->cycle_count = 0;
+    histogram_reset(&t->exec_cycles_histogram);
+}
+
+// Accounts one execution in a statistics bucket
+static inline void update_task_stats(task_stats_t *stats, int64_t exec_time, int64_t jitter, bool missed) {
+    stats->exec_count++;
+    stats->total_exec_time += exec_time;
+    if (exec_time > stats->max_exec_time) stats->max_exec_time = exec_time;
+    if (exec_time < stats->min_exec_time) stats->min_exec_time = exec_time;
+    stats->total_jitter += jitter;
+    if (jitter > stats->max_jitter) stats->max_jitter = jitter;
+    if (missed) stats->deadline_misses++;
+}
+
 // -----------------------------------------------------------------------------
 // Task Management Functions
 // -----------------------------------------------------------------------------
@@ -84,6 +138,10 @@ sched_error_t scheduler_add_task(const char *name, task_func_t task, int priorit
     t->name = name;
     t->min_exec_time = INT64_MAX; // Initialize to track the minimum execution time
     t->memory_allocated = static_memory_size; // Record allocated memory
+    t->chain_id = CHAIN_NONE; // Independent until linked into a chain
+    reset_task_stats(t->epoch_stats);
+    reset_cycle_stats(t);
+    t->input_from = -1;
 
     initialize_task_stack(task_stacks[task_count], TASK_STACK_SIZE); // Prepare the task stack
 
@@ -106,12 +164,64 @@ sched_error_t scheduler_set_task_interval(int task_index, int64_t new_interval)
     return SCHED_ERR_OK;
 }
 
+// Sets the supervision limits of a task
+// A task exceeding its execution budget, or not dispatched within its release gap,
+// stops the watchdog from being fed and causes a reset.
+sched_error_t scheduler_set_task_supervision(int task_index, int64_t max_exec_budget, int64_t max_release_gap) {
+    if (task_index < 0 || task_index >= task_count) return SCHED_ERR_INVALID_INDEX;
+    if (max_exec_budget < 0 || max_release_gap < 0) return SCHED_ERR_INVALID_PARAMS;
+    task_list[task_index].max_exec_budget = max_exec_budget;
+    task_list[task_index].max_release_gap = max_release_gap;
+    return SCHED_ERR_OK;
+}
+
+// Returns the index of the task with the given name
+int scheduler_find_task(const char *name) {
+    for (int i = 0; i < task_count; i++) {
+        if (task_list[i].name && strcmp(task_list[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+// Returns the cumulative execution time of all tasks
+int64_t scheduler_get_busy_time(void) {
+    return global_total_task_time;
+}
+
+// Returns the minimum deadline slack and restarts the measurement
+int64_t scheduler_take_min_slack(void) {
+    int64_t slack = min_slack;
+    min_slack = INT64_MAX;
+    return slack;
+}
+
+// Returns the index of the task being executed
+int scheduler_get_current_task(void) {
+    return current_task_index;
+}
+
+// Returns the number of registered tasks
+int scheduler_get_task_count(void) {
+    return task_count;
+}
+
+// Returns a read-only view of a task
+const task_t *scheduler_get_task(int task_index) {
+    if (task_index < 0 || task_index >= task_count) return NULL;
+    return &task_list[task_index];
+}
+
 // Pauses a task
 // When paused, the task's statistics are reset to avoid incorrect jitter calculations.
 sched_error_t scheduler_pause_task(int task_index) {
     if (task_index < 0 || task_index >= task_count) return SCHED_ERR_INVALID_INDEX;
     task_list[task_index].state = TASK_PAUSED;
 
+    // A paused member would block its chain forever, abort the current activation
+    if (task_list[task_index].chain_id != CHAIN_NONE) {
+        chain_abort(&chain_list[task_list[task_index].chain_id]);
+    }
+
     task_list[task_index].total_jitter = 0; // Reset jitter statistics
     task_list[task_index].max_jitter = 0;
     task_list[task_index].last_execution = get_absolute_time(); // Update last execution time
@@ -133,18 +243,48 @@ sched_error_t scheduler_resume_task(int task_index) {
 }
 
 // Changes the active scheduling algorithm
-// This function pauses all tasks, updates the scheduler algorithm, resets statistics,
-// and resumes tasks in a consistent state.
+// The change is only requested here and applied by the scheduler loop between two
+// dispatches, so it is atomic even when requested from an interrupt (terminal commands).
+// Tasks keep running and statistics are kept: each algorithm accumulates its own
+// per-task statistics bucket, so policies can be compared on the same workload.
 sched_error_t scheduler_set_algorithm(sched_algorithm_t algorithm) {
-    // Pause all tasks to avoid conflicts during algorithm change
-    for (int i = 0; i < task_count; i++) {
-        task_list[i].state = TASK_PAUSED;
+    if (algorithm < 0 || algorithm > SCHED_ALGO_AUTO) return SCHED_ERR_INVALID_PARAMS;
+
+    // AUTO keeps the current algorithm and its history, the adaptive logic takes over
+    if (algorithm == SCHED_ALGO_AUTO) {
+        scheduler_auto_reset();
+        selected_algorithm = SCHED_ALGO_AUTO;
+        return SCHED_ERR_OK;
     }
 
-    // Change the scheduler's algorithm
     selected_algorithm = algorithm;
+    pending_algorithm = algorithm;
+    return SCHED_ERR_OK;
+}
+
+// Switches the active algorithm without touching task states or statistics
+// Used by the AUTO mode; applied between two dispatches like scheduler_set_algorithm.
+sched_error_t scheduler_switch_algorithm(sched_algorithm_t algorithm) {
+    if (algorithm < 0 || algorithm >= SCHED_ALGO_COUNT) return SCHED_ERR_INVALID_PARAMS;
+    pending_algorithm = algorithm;
+    return SCHED_ERR_OK;
+}
 
-    // Reset all task statistics to ensure accurate data under the new algorithm
+// Closes the epoch of the active algorithm and opens one for the pending algorithm
+static void __hot_path_func(apply_pending_algorithm)(absolute_time_t current_time) {
+    int next = pending_algorithm;
+    pending_algorithm = -1;
+    if (next < 0 || next == (int)active_algorithm) return;
+
+    epoch_list[active_algorithm].active_time += absolute_time_diff_us(epoch_start, current_time);
+    epoch_start = current_time;
+    active_algorithm = (sched_algorithm_t)next;
+    epoch_list[active_algorithm].epochs++;
+    trace_event(TRACE_ALGO_SWITCH, (uint8_t)next, 0);
+}
+
+// Clears all task statistics and epochs, keeping task states and timing
+void scheduler_reset_statistics(void) {
     for (int i = 0; i < task_count; i++) {
         task_t *t = &task_list[i];
         t->exec_count = 0;            // Reset execution count
@@ -154,17 +294,227 @@ sched_error_t scheduler_set_algorithm(sched_algorithm_t algorithm) {
         t->min_exec_time = INT64_MAX; // Reset minimum execution time
         t->total_jitter = 0;          // Reset total jitter
         t->max_jitter = 0;            // Reset maximum jitter
-        t->last_execution = get_absolute_time(); // Update the last execution timestamp
+        t->deadline_misses = 0;       // Reset deadline misses
+        reset_task_stats(t->epoch_stats);
+        reset_cycle_stats(t);
+    }
+    irq_account_reset();
+    memset(epoch_list, 0, sizeof(epoch_list));
+    epoch_list[active_algorithm].epochs = 1;
+    epoch_start = get_absolute_time();
+}
+
+// Enables or disables cycle-resolution timing
+// Cycle statistics restart from zero so they cover a single measurement period.
+void scheduler_set_cycle_timing(bool enabled) {
+    for (int i = 0; i < task_count; i++) {
+        reset_cycle_stats(&task_list[i]);
+    }
+    cycle_timing = enabled;
+}
+
+bool scheduler_get_cycle_timing(void) {
+    return cycle_timing;
+}
+
+// Returns the epoch statistics of an algorithm
+const sched_epoch_stats_t *scheduler_get_epoch_stats(sched_algorithm_t algorithm) {
+    if (algorithm < 0 || algorithm >= SCHED_ALGO_COUNT) return NULL;
+    return &epoch_list[algorithm];
+}
+
+// Retrieves the selected scheduling algorithm
+sched_algorithm_t scheduler_get_algorithm(void) {
+    return selected_algorithm;
+}
+
+// Retrieves the algorithm used for task selection
+sched_algorithm_t scheduler_get_active_algorithm(void) {
+    return active_algorithm;
+}
+
+// -----------------------------------------------------------------------------
+// Task Chains
+// -----------------------------------------------------------------------------
+// A chain is a DAG of tasks. Only the head is periodic: every other member is
+// released as soon as all its predecessors have completed, so the end-to-end
+// latency of a pipeline is close to the sum of the execution times of its stages
+// instead of the sum of their phase offsets. The head is not released again until
+// the previous activation has completed, so handed over buffers stay valid.
+
+// Returns true if to_task can reach from_task through the successor edges
+static bool chain_reaches(int from_task, int to_task) {
+    uint32_t visited = 0;
+    uint32_t frontier = 1u << from_task;
+    while (frontier) {
+        int i = __builtin_ctz(frontier);
+        frontier &= frontier - 1;
+        if (i == to_task) return true;
+        if (visited & (1u << i)) continue;
+        visited |= 1u << i;
+        frontier |= task_list[i].successors & ~visited;
     }
+    return false;
+}
 
-    // Resume all tasks after reconfiguration
+// Abandons the current activation of a chain and clears pending releases
+static void chain_abort(task_chain_t *chain) {
+    chain->active = false;
+    released_tasks &= ~chain->members;
     for (int i = 0; i < task_count; i++) {
-        task_list[i].state = TASK_RUNNING;
+        if (chain->members & (1u << i)) task_list[i].released = false;
     }
+}
 
+// Creates a task chain
+sched_error_t scheduler_chain_create(const char *name, int head_task, int64_t deadline, int *chain_id) {
+    if (chain_count >= MAX_CHAINS) return SCHED_ERR_FULL;
+    if (head_task < 0 || head_task >= task_count) return SCHED_ERR_INVALID_INDEX;
+    if (deadline <= 0) return SCHED_ERR_INVALID_PARAMS;
+    if (task_list[head_task].chain_id != CHAIN_NONE) return SCHED_ERR_CHAIN;
+
+    task_chain_t *chain = &chain_list[chain_count];
+    memset(chain, 0, sizeof(task_chain_t));
+    chain->name = name;
+    chain->head = head_task;
+    chain->members = 1u << head_task;
+    chain->sink_count = 1; // The head alone is both source and sink
+    chain->deadline = deadline;
+    chain->min_latency = INT64_MAX;
+
+    task_list[head_task].chain_id = chain_count;
+    if (chain_id) *chain_id = chain_count;
+    chain_count++;
+    return SCHED_ERR_OK;
+}
+
+// Adds an edge between two tasks of a chain
+// to_task joins the chain if it is not yet a member. Edges creating a cycle,
+// or pointing back to the head, are rejected.
+sched_error_t scheduler_chain_link(int chain_id, int from_task, int to_task) {
+    if (chain_id < 0 || chain_id >= chain_count) return SCHED_ERR_INVALID_INDEX;
+    if (from_task < 0 || from_task >= task_count || to_task < 0 || to_task >= task_count) return SCHED_ERR_INVALID_INDEX;
+
+    task_chain_t *chain = &chain_list[chain_id];
+    task_t *from = &task_list[from_task];
+    task_t *to = &task_list[to_task];
+    if (from->chain_id != chain_id) return SCHED_ERR_CHAIN;
+    if (to->chain_id != CHAIN_NONE && to->chain_id != chain_id) return SCHED_ERR_CHAIN;
+    if (to_task == chain->head || from_task == to_task) return SCHED_ERR_CHAIN;
+    if (from->successors & (1u << to_task)) return SCHED_ERR_OK; // Edge already present
+    if (chain_reaches(to_task, from_task)) return SCHED_ERR_CHAIN; // Would create a cycle
+
+    chain_abort(chain);
+    from->successors |= 1u << to_task;
+    to->chain_id = chain_id;
+    to->predecessors++;
+    chain->members |= 1u << to_task;
+
+    // Recount the sinks
+    chain->sink_count = 0;
+    for (int i = 0; i < task_count; i++) {
+        if ((chain->members & (1u << i)) && task_list[i].successors == 0) chain->sink_count++;
+    }
     return SCHED_ERR_OK;
 }
 
+// Publishes the output buffer of the running task
+// The buffer must stay valid until the chain activation completes.
+void scheduler_chain_handoff(const void *data, size_t size) {
+    if (current_task_index < 0) return;
+    task_list[current_task_index].output = data;
+    task_list[current_task_index].output_size = size;
+}
+
+// Returns the buffer handed over by the predecessor that released the running task
+const void *scheduler_chain_input(size_t *size) {
+    if (current_task_index < 0 || task_list[current_task_index].input_from < 0) {
+        if (size) *size = 0;
+        return NULL;
+    }
+    const task_t *producer = &task_list[task_list[current_task_index].input_from];
+    if (size) *size = producer->output_size;
+    return producer->output;
+}
+
+// Returns the number of chains
+int scheduler_get_chain_count(void) {
+    return chain_count;
+}
+
+// Returns a read-only view of a chain
+const task_chain_t *scheduler_get_chain(int chain_id) {
+    if (chain_id < 0 || chain_id >= chain_count) return NULL;
+    return &chain_list[chain_id];
+}
+
+// Updates the chain state after a member has completed
+// Starts the activation when the head completes, releases the successors whose
+// predecessors have all completed, and records the latency when the last sink completes.
+static void __hot_path_func(chain_on_complete)(int task_index, absolute_time_t start_time, absolute_time_t end_time) {
+    task_t *t = &task_list[task_index];
+    task_chain_t *chain = &chain_list[t->chain_id];
+
+    if (task_index == chain->head) {
+        chain->active = true;
+        chain->start_time = start_time;
+        chain->sinks_pending = chain->sink_count;
+        for (int i = 0; i < task_count; i++) {
+            if (chain->members & (1u << i)) task_list[i].pending_predecessors = task_list[i].predecessors;
+        }
+    } else if (!chain->active) {
+        return; // Activation aborted while the task was running
+    }
+
+    t->released = false;
+    released_tasks &= ~(1u << task_index);
+
+    uint32_t successors = t->successors;
+    while (successors) {
+        int i = __builtin_ctz(successors);
+        successors &= successors - 1;
+        if (--task_list[i].pending_predecessors == 0) {
+            task_list[i].released = true;
+            task_list[i].release_time = end_time;
+            task_list[i].input_from = task_index;
+            released_tasks |= 1u << i;
+        }
+    }
+
+    if (t->successors == 0 && --chain->sinks_pending == 0) {
+        int64_t latency = absolute_time_diff_us(chain->start_time, end_time);
+        chain->active = false;
+        chain->activations++;
+        chain->total_latency += latency;
+        if (latency > chain->max_latency) chain->max_latency = latency;
+        if (latency < chain->min_latency) chain->min_latency = latency;
+        if (latency > chain->deadline) chain->deadline_misses++;
+        histogram_record(&chain->latency_histogram, (uint32_t)latency);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Task Readiness
+// -----------------------------------------------------------------------------
+
+// Returns true if a task cannot run regardless of time: paused, a chain successor
+// not yet released, or the head of a chain whose previous activation is in progress.
+static inline bool task_is_blocked(const task_t *t) {
+    if (t->state == TASK_PAUSED || !t->task) return true;
+    if (t->chain_id != CHAIN_NONE) {
+        const task_chain_t *chain = &chain_list[t->chain_id];
+        if (t == &task_list[chain->head]) return chain->active;
+        return !t->released;
+    }
+    return false;
+}
+
+// Returns true if a task is ready: released by its chain, or its interval has elapsed
+static inline bool task_is_ready(const task_t *t, absolute_time_t current_time) {
+    if (task_is_blocked(t)) return false;
+    if (t->released) return true;
+    return absolute_time_diff_us(t->last_execution, current_time) >= t->interval;
+}
 
 // -----------------------------------------------------------------------------
 // Dynamic Priority Normalization
@@ -176,7 +526,7 @@ sched_error_t scheduler_set_algorithm(sched_algorithm_t algorithm) {
 // with inherently lower priorities to suffer from starvation. By resetting all dynamic
 // priorities to their static values periodically, this mechanism prevents such issues
 // and maintains fairness among tasks.
-static void normalize_dynamic_priorities(void) {
+static void __hot_path_func(normalize_dynamic_priorities)(void) {
     for (int i = 0; i < task_count; i++) {
         task_list[i].dynamic_priority = task_list[i].priority; // Reset to static priority
     }
@@ -191,14 +541,12 @@ static void normalize_dynamic_priorities(void) {
 // This algorithm is well-suited for systems where tasks have clearly defined
 // priority levels. However, without periodic normalization, lower-priority
 // tasks could experience starvation.
-static int find_highest_priority_task(absolute_time_t current_time) {
+static int __hot_path_func(find_highest_priority_task)(absolute_time_t current_time) {
     int highest_priority_index = -1;
     int highest_priority = -1;
 
     for (int i = 0; i < task_count; i++) {
-        if (task_list[i].state == TASK_PAUSED) continue;
-        int64_t since_last = absolute_time_diff_us(task_list[i].last_execution, current_time);
-        if (task_list[i].task && since_last >= task_list[i].interval) {
+        if (task_is_ready(&task_list[i], current_time)) {
             if (task_list[i].dynamic_priority > highest_priority) {
                 highest_priority = task_list[i].dynamic_priority;
                 highest_priority_index = i;
@@ -219,13 +567,11 @@ static int find_highest_priority_task(absolute_time_t current_time) {
 // Cycles through tasks in a fixed order, ensuring all tasks get a turn to run.
 // This algorithm is simple and fair but does not account for task priority
 // or varying workloads, making it less suitable for real-time systems.
-static int find_round_robin_task(absolute_time_t current_time) {
+static int __hot_path_func(find_round_robin_task)(absolute_time_t current_time) {
     static int last_task_index = -1;
     for (int i = 0; i < task_count; i++) {
         int current_index = (last_task_index + 1 + i) % task_count;
-        if (task_list[current_index].state == TASK_PAUSED) continue;
-        int64_t since_last = absolute_time_diff_us(task_list[current_index].last_execution, current_time);
-        if (task_list[current_index].task && since_last >= task_list[current_index].interval) {
+        if (task_is_ready(&task_list[current_index], current_time)) {
             last_task_index = current_index;
             return current_index;
         }
@@ -237,15 +583,13 @@ static int find_round_robin_task(absolute_time_t current_time) {
 // Prioritizes tasks based on their deadlines, executing the task with the
 // earliest deadline first. This algorithm is ideal for systems with hard
 // deadlines, but requires accurate deadline tracking and scheduling.
-static int find_earliest_deadline_task(absolute_time_t current_time) {
+static int __hot_path_func(find_earliest_deadline_task)(absolute_time_t current_time) {
     int earliest_index = -1;
     int64_t earliest_deadline = INT64_MAX;
 
     for (int i = 0; i < task_count; i++) {
-        if (task_list[i].state == TASK_PAUSED) continue;
         int64_t deadline = to_us_since_boot(task_list[i].last_execution) + task_list[i].interval;
-        int64_t since_last = absolute_time_diff_us(task_list[i].last_execution, current_time);
-        if (task_list[i].task && since_last >= task_list[i].interval && deadline < earliest_deadline) {
+        if (task_is_ready(&task_list[i], current_time) && deadline < earliest_deadline) {
             earliest_deadline = deadline;
             earliest_index = i;
         }
@@ -258,13 +602,13 @@ static int find_earliest_deadline_task(absolute_time_t current_time) {
 // Executes the task with the lowest execution count, balancing workload
 // distribution across tasks. This approach is effective for systems where
 // all tasks are of equal importance and should share CPU time equally.
-static int find_least_executed_task(absolute_time_t current_time) {
+static int __hot_path_func(find_least_executed_task)(absolute_time_t current_time) {
     (void)current_time; // Not required for this algorithm
     int least_executed_index = -1;
     int min_exec_count = INT_MAX;
 
     for (int i = 0; i < task_count; i++) {
-        if (task_list[i].state == TASK_PAUSED) continue;
+        if (task_is_blocked(&task_list[i])) continue;
         if (task_list[i].exec_count < min_exec_count) {
             min_exec_count = task_list[i].exec_count;
             least_executed_index = i;
@@ -278,12 +622,12 @@ static int find_least_executed_task(absolute_time_t current_time) {
 // Executes the task that has been waiting the longest since its last execution.
 // This algorithm is effective for reducing task latency but may not suit systems
 // where task priority or deadlines are critical.
-static int find_longest_waiting_task(absolute_time_t current_time) {
+static int __hot_path_func(find_longest_waiting_task)(absolute_time_t current_time) {
     int longest_waiting_index = -1;
     int64_t max_wait_time = -1;
 
     for (int i = 0; i < task_count; i++) {
-        if (task_list[i].state == TASK_PAUSED) continue;
+        if (task_is_blocked(&task_list[i])) continue;
         int64_t wait_time = absolute_time_diff_us(task_list[i].last_execution, current_time);
         if (wait_time > max_wait_time) {
             max_wait_time = wait_time;
@@ -294,14 +638,71 @@ static int find_longest_waiting_task(absolute_time_t current_time) {
     return longest_waiting_index;
 }
 
-static int select_next_task(absolute_time_t current_time) {
-    int algo_index = (int)selected_algorithm;
+// -----------------------------------------------------------------------------
+// Task Supervision
+// -----------------------------------------------------------------------------
+
+// Checks the release gap of every supervised task and feeds the watchdog.
+// Runs at most once per SUPERVISOR_CHECK_INTERVAL_US, so the per-dispatch cost is a
+// single time comparison. Paused tasks are not supervised.
+static void __hot_path_func(supervise_tasks)(absolute_time_t current_time) {
+    if (absolute_time_diff_us(last_supervision_check, current_time) < SUPERVISOR_CHECK_INTERVAL_US) {
+        return;
+    }
+    last_supervision_check = current_time;
+
+    for (int i = 0; i < task_count; i++) {
+        task_t *t = &task_list[i];
+        if (t->state == TASK_PAUSED || t->max_release_gap == 0) continue;
+        int64_t gap = absolute_time_diff_us(t->last_execution, current_time);
+        if (gap > t->max_release_gap) {
+            supervisor_report_fault(SUPERVISOR_FAULT_RELEASE_GAP, i, gap, t->max_release_gap);
+        }
+    }
+
+    supervisor_feed();
+}
+
+// Chain successors released by a completed predecessor run first, so a pipeline
+// completes back to back without waiting for the next scheduling decision.
+static int __hot_path_func(select_next_task)(absolute_time_t current_time) {
+    uint32_t pending = released_tasks;
+    while (pending) {
+        int i = __builtin_ctz(pending);
+        pending &= pending - 1;
+        if (task_list[i].state != TASK_PAUSED) return i;
+    }
+
+    int algo_index = (int)active_algorithm;
     if (algo_index < 0 || algo_index >= (int)(sizeof(sched_algorithms)/sizeof(sched_algorithms[0]))) {
         return -1;
     }
     return sched_algorithms[algo_index](current_time);
 }
 
+// Returns the task an algorithm would dispatch now, without dispatching it
+// Measures the cost of a scheduling decision. Like a real decision it may advance
+// the round-robin position and the priority normalization counter.
+int scheduler_peek_next_task(sched_algorithm_t algorithm) {
+    if (algorithm < 0 || algorithm >= SCHED_ALGO_COUNT) return -1;
+    return sched_algorithms[algorithm](get_absolute_time());
+}
+
+// Returns the time until the next periodic release of a task other than the caller
+// Background work such as flash writes uses it to run only when it delays no task.
+int64_t scheduler_get_idle_window(void) {
+    absolute_time_t now = get_absolute_time();
+    int64_t window = INT64_MAX;
+    for (int i = 0; i < task_count; i++) {
+        const task_t *t = &task_list[i];
+        if (i == current_task_index || task_is_blocked(t)) continue;
+        if (t->released) return 0;
+        int64_t until = t->interval - absolute_time_diff_us(t->last_execution, now);
+        if (until < window) window = until < 0 ? 0 : until;
+    }
+    return window;
+}
+
 // -----------------------------------------------------------------------------
 // Scheduler Core Function: scheduler_run
 // -----------------------------------------------------------------------------
@@ -314,47 +715,136 @@ static int select_next_task(absolute_time_t current_time) {
 // 2. Select the next task to execute using the active algorithm.
 // 3. If a task is selected, calculate jitter, update execution metrics, and execute the task.
 // 4. If no task is executable, the scheduler idles momentarily.
+// 5. Supervised tasks are checked against their limits before feeding the watchdog.
+//
+// One iteration is exposed as scheduler_run_once() so the loop can also be driven
+// step by step, e.g. by the host simulator against a virtual clock.
 
-void scheduler_run(void) {
-    while (1) {
-        absolute_time_t current_time = get_absolute_time();
-        int task_index = select_next_task(current_time);
+// Prepares the scheduler loop: enables the watchdog and opens the first epoch
+void scheduler_start(void) {
+    last_supervision_check = get_absolute_time();
+    epoch_start = last_supervision_check;
+    supervisor_start();
+}
+
+// Runs one iteration of the scheduler loop
+int __hot_path_func(scheduler_run_once)(void) {
+    absolute_time_t current_time = get_absolute_time();
+    supervise_tasks(current_time);
+    if (selected_algorithm == SCHED_ALGO_AUTO) {
+        scheduler_auto_poll(current_time);
+    }
+    if (pending_algorithm >= 0) {
+        apply_pending_algorithm(current_time);
+    }
+    int task_index = select_next_task(current_time);
 
-        if (task_index != -1) {
-            task_t *t = &task_list[task_index];
+    if (task_index != -1) {
+        task_t *t = &task_list[task_index];
 
-            // Calculate time since last execution
+        // Calculate jitter: deviation from the ideal interval, or for a chain
+        // successor the delay between its release and its start
+        int64_t lateness;
+        if (t->released) {
+            lateness = absolute_time_diff_us(t->release_time, current_time);
+        } else {
             int64_t since_last = absolute_time_diff_us(t->last_execution, current_time);
-            
-            // Calculate jitter (deviation from the ideal interval)
-            int64_t jitter = since_last - t->interval;
-            if (jitter < 0) jitter = -jitter;
-            t->total_jitter += jitter;
-            if (jitter > t->max_jitter) {
-                t->max_jitter = jitter;
-            }
+            lateness = since_last - t->interval;
+        }
+        int64_t jitter = lateness < 0 ? -lateness : lateness;
+        t->total_jitter += jitter;
+        if (jitter > t->max_jitter) {
+            t->max_jitter = jitter;
+        }
+
+        // Execute the task and measure execution time
+        absolute_time_t start_time = current_time;
+        uint32_t start_us = (uint32_t)to_us_since_boot(start_time);
+        // A task dispatched before its interval elapsed (RR, LEAST_EXECUTED, LONGEST_WAITING)
+        // is released at its start, so the release never follows it
+        trace_event_at(start_us - (uint32_t)(lateness > 0 ? lateness : 0), TRACE_TASK_RELEASE, (uint8_t)task_index, 0);
+        trace_event_at(start_us, TRACE_TASK_START, (uint8_t)task_index, (uint16_t)active_algorithm);
+        supervisor_mark_dispatch(task_index); // Identifies the task if it never returns
+        current_task_index = task_index;
+        uint32_t start_irq_cycles = irq_account_busy_cycles();
+        uint32_t start_cycles = cycle_timing ? cycles_now() : 0;
+        gpio_trace_task_start(task_index);
+        t->task(); // Task execution
+        gpio_trace_task_end(task_index);
+        uint32_t end_cycles = cycle_timing ? cycles_now() : 0;
+        uint32_t irq_cycles = irq_account_busy_cycles() - start_irq_cycles;
+        current_task_index = -1;
+        supervisor_mark_idle();
+        absolute_time_t end_time = get_absolute_time();
+        trace_event_at((uint32_t)to_us_since_boot(end_time), TRACE_TASK_END, (uint8_t)task_index, 0);
 
-            // Execute the task and measure execution time
-            absolute_time_t start_time = current_time;
-            t->task(); // Task execution
-            absolute_time_t end_time = get_absolute_time();
+        t->last_execution = end_time; // Update last execution time
+        t->dynamic_priority = t->priority; // Reset dynamic priority
+        t->exec_count++; // Increment execution count
+        metric_inc(&metric_dispatches);
 
-            t->last_execution = end_time; // Update last execution time
-            t->dynamic_priority = t->priority; // Reset dynamic priority
-            t->exec_count++; // Increment execution count
+        // Calculate execution time for the task, without the interrupt handlers that preempted it
+        int64_t elapsed_time = absolute_time_diff_us(start_time, end_time);
+        int64_t exec_time = elapsed_time;
+        if (irq_cycles > 0) {
+            exec_time -= irq_cycles / cycles_per_us();
+            if (exec_time < 0) exec_time = 0;
+        }
+        t->total_time += exec_time;
+        t->total_exec_time += exec_time;
+        if (exec_time > t->max_exec_time) t->max_exec_time = exec_time;
+        if (exec_time < t->min_exec_time) t->min_exec_time = exec_time;
 
-            // Calculate execution time for the task
-            int64_t exec_time = absolute_time_diff_us(start_time, end_time);
-            t->total_time += exec_time;
-            t->total_exec_time += exec_time;
-            if (exec_time > t->max_exec_time) t->max_exec_time = exec_time;
-            if (exec_time < t->min_exec_time) t->min_exec_time = exec_time;
+        // Same interval in CPU cycles, for tasks shorter than the microsecond resolution
+        if (cycle_timing) {
+            uint32_t cycles = cycles_elapsed(start_cycles, end_cycles, elapsed_time);
+            cycles = cycles > irq_cycles ? cycles - irq_cycles : 0;
+            t->total_exec_cycles += cycles;
+            t->cycle_count++;
+            if (cycles > t->max_exec_cycles) t->max_exec_cycles = cycles;
+            if (cycles < t->min_exec_cycles) t->min_exec_cycles = cycles;
+            histogram_record(&t->exec_cycles_histogram, cycles);
+        }
 
-            global_total_task_time += exec_time; // Update global task time
-        } else {
-            // No executable task, introduce a small idle delay
-            // sleep_us(100);
+        // Check the implicit deadline: the task must complete within one interval of its release
+        bool missed = false;
+        if (!t->released) {
+            int64_t slack = t->interval - (lateness + exec_time);
+            missed = slack < 0;
+            if (slack < min_slack) min_slack = slack;
         }
+        if (missed) {
+            t->deadline_misses++;
+        }
+
+        // Account the execution in the bucket of the active algorithm
+        update_task_stats(&t->epoch_stats[active_algorithm], exec_time, jitter, missed);
+        epoch_list[active_algorithm].busy_time += exec_time;
+
+        // Check the execution budget of supervised tasks
+        if (t->max_exec_budget > 0 && exec_time > t->max_exec_budget) {
+            supervisor_report_fault(SUPERVISOR_FAULT_EXEC_BUDGET, task_index, exec_time, t->max_exec_budget);
+        }
+
+        global_total_task_time += exec_time; // Update global task time
+
+        // Release the successors of chain members
+        if (t->chain_id != CHAIN_NONE) {
+            chain_on_complete(task_index, start_time, end_time);
+        }
+    } else {
+        // No executable task, introduce a small idle delay
+        // sleep_us(100);
+        metric_inc(&metric_idle);
+    }
+
+    return task_index;
+}
+
+void __hot_path_func(scheduler_run)(void) {
+    scheduler_start();
+    while (1) {
+        scheduler_run_once();
     }
 }
 
@@ -376,7 +866,8 @@ void scheduler_run(void) {
 // 9. **AvgTime:** Average execution time per run.
 // 10. **MaxJitter:** The maximum observed jitter (difference from ideal interval).
 // 11. **AvgJitter:** The average jitter over all executions.
-// 12. **MemUsed:** Combined stack usage and statically allocated memory for the task.
+// 12. **Misses:** Executions completed after their implicit deadline (release + interval).
+// 13. **MemUsed:** Combined stack usage and statically allocated memory for the task.
 //
 // These metrics are useful for identifying performance bottlenecks, ensuring tasks
 // meet timing constraints, and analyzing resource utilization.
@@ -388,26 +879,58 @@ const char* scheduler_algorithm_to_string(sched_algorithm_t algorithm) {
         case SCHED_ALGO_EARLIEST_DEADLINE_FIRST: return "EARLIEST_DEADLINE_FIRST";
         case SCHED_ALGO_LEAST_EXECUTED: return "LEAST_EXECUTED";
         case SCHED_ALGO_LONGEST_WAITING: return "LONGEST_WAITING";
+        case SCHED_ALGO_AUTO: return "AUTO";
         default: return "UNKNOWN";
     }
 }
 
 static void print_task_info(int index, const task_t *task, int stack_used) {
-    printf("%-5d %-10s %-10s %-10d %-10d %-10lld %-10lld %-10lld %-10lld %-10lld %-10lld %-10zu\n",
-           index, // PID
-           task->name,
-           task->state == TASK_RUNNING ? "RUNNING" : "PAUSED",
-           task->priority, // Static Priority
-           task->exec_count, // Execution Count
-           task->total_time, // Total Execution Time
-           (task->min_exec_time == INT64_MAX) ? 0 : task->min_exec_time, // Min Execution Time
-           task->max_exec_time, // Max Execution Time
-           task->exec_count > 0 ? (task->total_exec_time / task->exec_count) : 0, // Average Execution Time
-           task->max_jitter,
-           task->exec_count > 0 ? (task->total_jitter / task->exec_count) : 0,
-           stack_used + task->memory_allocated); // Memory Used
+    fmt_printf("%-5d %-10s %-10s %-10d %-10d %-10lld %-10lld %-10lld %-10lld %-10lld %-10lld %-10d %-10zu",
+               index, // PID
+               task->name,
+               task->state == TASK_RUNNING ? "RUNNING" : "PAUSED",
+               task->priority, // Static Priority
+               task->exec_count, // Execution Count
+               (long long)task->total_time, // Total Execution Time
+               (long long)((task->min_exec_time == INT64_MAX) ? 0 : task->min_exec_time), // Min Execution Time
+               (long long)task->max_exec_time, // Max Execution Time
+               (long long)(task->exec_count > 0 ? (task->total_exec_time / task->exec_count) : 0), // Average Execution Time
+               (long long)task->max_jitter,
+               (long long)(task->exec_count > 0 ? (task->total_jitter / task->exec_count) : 0),
+               task->deadline_misses,
+               stack_used + task->memory_allocated); // Memory Used
+    if (cycle_timing) {
+        fmt_printf(" %-10lu %-10lu %-10lu",
+                   (unsigned long)(task->cycle_count > 0 ? task->min_exec_cycles : 0),
+                   (unsigned long)task->max_exec_cycles,
+                   (unsigned long)(task->cycle_count > 0 ? task->total_exec_cycles / task->cycle_count : 0));
+    }
+    fmt_printf("\n");
 }
 
+// Prints the accounted interrupts as pseudo-tasks
+// The PID column holds the IRQ number and MaxJitter the maximum entry latency,
+// "-" for interrupts that cannot tell when their event happened.
+static void print_irq_info(void) {
+    for (int irq = 0; irq < IRQ_ACCOUNT_MAX_IRQS; irq++) {
+        const irq_stats_t *s = irq_account_get((uint8_t)irq);
+        if (s == NULL) continue;
+        char latency[12] = "-";
+        if (s->has_latency) fmt_snprintf(latency, sizeof(latency), "%lu", (unsigned long)s->max_latency);
+        fmt_printf("%-5d %-10s %-10s %-10s %-10lu %-10llu %-10s %-10lu %-10llu %-10s %-10s %-10s %-10s\n",
+                   irq,
+                   s->name,
+                   "IRQ",
+                   "-",
+                   (unsigned long)s->count,
+                   (unsigned long long)s->total_time,
+                   "-",
+                   (unsigned long)s->max_time,
+                   (unsigned long long)(s->count > 0 ? s->total_time / s->count : 0),
+                   latency,
+                   "-", "-", "-");
+    }
+}
 
 void scheduler_print_task_list(void) {
     const char *algo_name = scheduler_algorithm_to_string(selected_algorithm);
@@ -424,19 +947,168 @@ void scheduler_print_task_list(void) {
     double memory_usage_percentage = ((double)total_memory_usage / (double)RP2040_TOTAL_RAM) * 100.0;
 
     // Print global statistics
-    printf("\n--- Global Task Statistics ---\n");
-    printf("Scheduler Algorithm: %s\n", algo_name);
-    printf("CPU Usage: %.2f%% (%lld us)\n", cpu_usage_percentage, global_total_task_time);
-    printf("Total System Time: %lld us\n", current_system_time);
-    printf("Total Memory Usage: %zu bytes (%.2f%% of total 264KB RAM)\n\n", total_memory_usage, memory_usage_percentage);
+    fmt_printf("\n--- Global Task Statistics ---\n");
+    if (selected_algorithm == SCHED_ALGO_AUTO) {
+        fmt_printf("Scheduler Algorithm: %s (active: %s)\n", algo_name, scheduler_algorithm_to_string(active_algorithm));
+    } else {
+        fmt_printf("Scheduler Algorithm: %s\n", algo_name);
+    }
+    fmt_printf("CPU Usage: %.2f%% (%lld us)\n", cpu_usage_percentage, (long long)global_total_task_time);
+    fmt_printf("IRQ Usage: %.2f%% (%llu us)\n", ((double)irq_account_total_time() / (double)current_system_time) * 100.0,
+               (unsigned long long)irq_account_total_time());
+    fmt_printf("Total System Time: %lld us\n", (long long)current_system_time);
+    fmt_printf("Total Memory Usage: %zu bytes (%.2f%% of total 264KB RAM)\n\n", total_memory_usage, memory_usage_percentage);
 
-    printf("%-5s %-10s %-10s %-10s %-10s %-10s %-10s %-10s %-10s %-10s %-10s %-10s\n",
+    fmt_printf("%-5s %-10s %-10s %-10s %-10s %-10s %-10s %-10s %-10s %-10s %-10s %-10s %-10s",
        "PID", "Name", "State", "Priority", "ExecCount", "TotalTime",
-       "MinTime", "MaxTime", "AvgTime", "MaxJitter", "AvgJitter", "MemUsed");
+       "MinTime", "MaxTime", "AvgTime", "MaxJitter", "AvgJitter", "Misses", "MemUsed");
+    if (cycle_timing) {
+        fmt_printf(" %-10s %-10s %-10s", "MinCyc", "MaxCyc", "AvgCyc");
+    }
+    fmt_printf("\n");
 
     for (int i = 0; i < task_count; i++) {
         int stack_used = calculate_stack_usage(task_stacks[i], TASK_STACK_SIZE);
         print_task_info(i, &task_list[i], stack_used);
     }
-    printf("\n");
+    print_irq_info();
+    fmt_printf("\n");
+}
+
+// Prints end-to-end latency statistics and the latency histogram of every chain
+void scheduler_print_chain_list(void) {
+    fmt_printf("\n--- Task Chains ---\n");
+    fmt_printf("%-5s %-10s %-10s %-10s %-10s %-10s %-10s %-10s %-10s\n",
+               "CID", "Name", "Stages", "Runs", "MinLat", "MaxLat", "AvgLat", "Deadline", "Misses");
+
+    for (int c = 0; c < chain_count; c++) {
+        const task_chain_t *chain = &chain_list[c];
+        fmt_printf("%-5d %-10s %-10d %-10d %-10lld %-10lld %-10lld %-10lld %-10d\n",
+                   c,
+                   chain->name,
+                   __builtin_popcount(chain->members),
+                   chain->activations,
+                   (long long)((chain->min_latency == INT64_MAX) ? 0 : chain->min_latency),
+                   (long long)chain->max_latency,
+                   (long long)(chain->activations > 0 ? (chain->total_latency / chain->activations) : 0),
+                   (long long)chain->deadline,
+                   chain->deadline_misses);
+
+        // Print the topology as edges between task names
+        for (int i = 0; i < task_count; i++) {
+            if (!(chain->members & (1u << i))) continue;
+            uint32_t successors = task_list[i].successors;
+            while (successors) {
+                int j = __builtin_ctz(successors);
+                successors &= successors - 1;
+                fmt_printf("      %s -> %s\n", task_list[i].name, task_list[j].name);
+            }
+        }
+        fmt_printf("  End-to-end latency (us):\n");
+        histogram_print_scaled(&chain->latency_histogram, "us", cycle_timing ? cycles_per_us() : 0);
+    }
+    fmt_printf("\n");
+}
+
+// Prints the execution time distribution of every task in CPU cycles
+void scheduler_print_cycle_histograms(void) {
+    fmt_printf("\n--- Execution Time (cycles, %lu per us) ---\n", (unsigned long)cycles_per_us());
+    if (!cycle_timing) {
+        fmt_printf("Cycle timing disabled, use PS CYC EN\n\n");
+        return;
+    }
+    for (int i = 0; i < task_count; i++) {
+        fmt_printf("%d %s:\n", i, task_list[i].name);
+        histogram_print(&task_list[i].exec_cycles_histogram, "cyc");
+    }
+    fmt_printf("\n");
+}
+
+// Prints the per-algorithm statistics of every task
+// Each algorithm accumulates its own bucket across all the epochs in which it was active,
+// so the policies can be compared (A/B) on the same live workload.
+void scheduler_print_epoch_comparison(void) {
+    int64_t now_active = absolute_time_diff_us(epoch_start, get_absolute_time());
+
+    fmt_printf("\n--- Algorithm Comparison ---\n");
+    fmt_printf("%-25s %-8s %-12s %-8s\n", "Algorithm", "Epochs", "ActiveTime", "CPU%");
+    for (int a = 0; a < SCHED_ALGO_COUNT; a++) {
+        const sched_epoch_stats_t *e = &epoch_list[a];
+        int64_t active_time = e->active_time + (a == (int)active_algorithm ? now_active : 0);
+        if (e->epochs == 0) continue;
+        fmt_printf("%-25s %-8d %-12lld %-8.2f%s\n",
+                   scheduler_algorithm_to_string((sched_algorithm_t)a),
+                   e->epochs,
+                   (long long)active_time,
+                   active_time > 0 ? ((double)e->busy_time / (double)active_time) * 100.0 : 0.0,
+                   a == (int)active_algorithm ? " *" : "");
+    }
+
+    fmt_printf("\n%-5s %-10s %-25s %-10s %-10s %-10s %-10s %-10s %-10s %-10s\n",
+               "PID", "Name", "Algorithm", "ExecCount", "MinTime", "MaxTime", "AvgTime", "MaxJitter", "AvgJitter", "Misses");
+    for (int i = 0; i < task_count; i++) {
+        for (int a = 0; a < SCHED_ALGO_COUNT; a++) {
+            const task_stats_t *st = &task_list[i].epoch_stats[a];
+            if (st->exec_count == 0) continue;
+            fmt_printf("%-5d %-10s %-25s %-10d %-10lld %-10lld %-10lld %-10lld %-10lld %-10d\n",
+                       i,
+                       task_list[i].name,
+                       scheduler_algorithm_to_string((sched_algorithm_t)a),
+                       st->exec_count,
+                       (long long)st->min_exec_time,
+                       (long long)st->max_exec_time,
+                       (long long)(st->total_exec_time / st->exec_count),
+                       (long long)st->max_jitter,
+                       (long long)(st->total_jitter / st->exec_count),
+                       st->deadline_misses);
+        }
+    }
+    fmt_printf("\n");
+}
+
+// -----------------------------------------------------------------------------
+// Metrics
+// -----------------------------------------------------------------------------
+// Per-task metrics are collected from task_list at export time.
+
+static void collect_task_runs(metrics_sink_t *sink) {
+    for (int i = 0; i < task_count; i++) metrics_sample(sink, task_list[i].name, task_list[i].exec_count);
+}
+
+static void collect_task_exec_time(metrics_sink_t *sink) {
+    for (int i = 0; i < task_count; i++) metrics_sample(sink, task_list[i].name, task_list[i].total_exec_time);
+}
+
+static void collect_task_max_exec_time(metrics_sink_t *sink) {
+    for (int i = 0; i < task_count; i++) metrics_sample(sink, task_list[i].name, task_list[i].max_exec_time);
+}
+
+static void collect_task_max_jitter(metrics_sink_t *sink) {
+    for (int i = 0; i < task_count; i++) metrics_sample(sink, task_list[i].name, task_list[i].max_jitter);
+}
+
+static void collect_task_misses(metrics_sink_t *sink) {
+    for (int i = 0; i < task_count; i++) metrics_sample(sink, task_list[i].name, task_list[i].deadline_misses);
+}
+
+static void collect_busy_time(metrics_sink_t *sink) {
+    metrics_sample(sink, NULL, global_total_task_time);
+}
+
+static metric_t scheduler_metrics[] = {
+    { .name = "sched_task_runs_total", .help = "Executions per task", .type = METRIC_COUNTER, .label = "task", .collect = collect_task_runs },
+    { .name = "sched_task_exec_time_us_total", .help = "Execution time per task", .type = METRIC_COUNTER, .label = "task", .collect = collect_task_exec_time },
+    { .name = "sched_task_exec_time_max_us", .help = "Longest execution per task", .type = METRIC_GAUGE, .label = "task", .collect = collect_task_max_exec_time },
+    { .name = "sched_task_jitter_max_us", .help = "Largest release jitter per task", .type = METRIC_GAUGE, .label = "task", .collect = collect_task_max_jitter },
+    { .name = "sched_task_deadline_misses_total", .help = "Deadline misses per task", .type = METRIC_COUNTER, .label = "task", .collect = collect_task_misses },
+    { .name = "sched_busy_time_us_total", .help = "Time spent in tasks", .type = METRIC_COUNTER, .collect = collect_busy_time },
+};
+
+static void scheduler_metrics_init(void) {
+    metrics_register(&metric_dispatches);
+    metrics_register(&metric_idle);
+    for (size_t i = 0; i < sizeof(scheduler_metrics) / sizeof(scheduler_metrics[0]); i++) {
+        metrics_register(&scheduler_metrics[i]);
+    }
 }
+REGISTER_INITCALL_LEVEL(scheduler_metrics_init, INITCALL_CORE);
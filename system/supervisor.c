@@ -0,0 +1,119 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hardware/watchdog.h"
+#include "supervisor.h"
+#include "initcalls.h"
+#include "hot_path.h"
+#include "fmt.h"
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+static bool watchdog_started = false;   // Watchdog enabled by scheduler_run
+static bool fault_reported = false;     // Once set, the watchdog is no longer fed
+static supervisor_record_t last_reset;  // Fault record of the previous boot
+
+// Packs magic, fault type and task index into a scratch register value
+static uint32_t make_tag(supervisor_fault_t fault, int task_index) {
+    return ((uint32_t)SUPERVISOR_MAGIC << 16) | ((uint32_t)fault << 8) | (uint8_t)task_index;
+}
+
+// Checks that a scratch register value was written by the supervisor
+static bool is_valid_tag(uint32_t tag) {
+    return (tag >> 16) == SUPERVISOR_MAGIC;
+}
+
+// Recovers the fault record of the previous boot
+// The record is valid only if the reset was caused by the watchdog timing out,
+// not by an intentional watchdog_reboot().
+void supervisor_init(void) {
+    last_reset.valid = false;
+
+    if (watchdog_enable_caused_reboot()) {
+        uint32_t fault_tag = watchdog_hw->scratch[SUPERVISOR_SCRATCH_FAULT];
+        uint32_t dispatch_tag = watchdog_hw->scratch[SUPERVISOR_SCRATCH_DISPATCH];
+
+        if (is_valid_tag(fault_tag) && ((fault_tag >> 8) & 0xFF) != SUPERVISOR_FAULT_NONE) {
+            // Fault detected by the scheduler, the watchdog was starved on purpose
+            last_reset.valid = true;
+            last_reset.fault = (supervisor_fault_t)((fault_tag >> 8) & 0xFF);
+            last_reset.task_index = fault_tag & 0xFF;
+            last_reset.measured_us = watchdog_hw->scratch[SUPERVISOR_SCRATCH_MEASURED];
+            last_reset.limit_us = watchdog_hw->scratch[SUPERVISOR_SCRATCH_LIMIT];
+        } else if (is_valid_tag(dispatch_tag) && (dispatch_tag & 0xFF) != SUPERVISOR_NO_TASK) {
+            // A task never returned to the scheduler
+            last_reset.valid = true;
+            last_reset.fault = SUPERVISOR_FAULT_HUNG;
+            last_reset.task_index = dispatch_tag & 0xFF;
+            last_reset.measured_us = 0; // Unknown, at least the watchdog timeout
+            last_reset.limit_us = SUPERVISOR_WATCHDOG_TIMEOUT_MS * 1000u;
+        }
+    }
+
+    if (last_reset.valid) {
+        fmt_printf("[SUPERVISOR][ERROR] Last reset caused by task %d: %s (measured %lu us, limit %lu us)\n",
+                   last_reset.task_index, supervisor_fault_to_string(last_reset.fault),
+                   (unsigned long)last_reset.measured_us, (unsigned long)last_reset.limit_us);
+    }
+
+    supervisor_clear();
+}
+REGISTER_INITCALL_LEVEL(supervisor_init, INITCALL_CORE);
+
+// Enables the hardware watchdog
+// Pausing on debug allows breakpoints without triggering a reset.
+void supervisor_start(void) {
+    supervisor_mark_idle();
+    watchdog_enable(SUPERVISOR_WATCHDOG_TIMEOUT_MS, true);
+    watchdog_started = true;
+}
+
+// Feeds the watchdog while all supervised tasks are healthy
+void __hot_path_func(supervisor_feed)(void) {
+    if (watchdog_started && !fault_reported) {
+        watchdog_update();
+    }
+}
+
+// Records the first fault and stops feeding the watchdog.
+// The scheduler keeps running until the watchdog resets the system.
+void supervisor_report_fault(supervisor_fault_t fault, int task_index, int64_t measured_us, int64_t limit_us) {
+    if (fault_reported) {
+        return; // Keep the first fault, it is the root cause
+    }
+    fault_reported = true;
+
+    watchdog_hw->scratch[SUPERVISOR_SCRATCH_MEASURED] = measured_us > UINT32_MAX ? UINT32_MAX : (uint32_t)measured_us;
+    watchdog_hw->scratch[SUPERVISOR_SCRATCH_LIMIT] = limit_us > UINT32_MAX ? UINT32_MAX : (uint32_t)limit_us;
+    watchdog_hw->scratch[SUPERVISOR_SCRATCH_FAULT] = make_tag(fault, task_index);
+}
+
+// Returns true while no fault has been reported
+bool supervisor_is_healthy(void) {
+    return !fault_reported;
+}
+
+// Returns the fault record recovered at boot
+const supervisor_record_t *supervisor_get_last_reset(void) {
+    return &last_reset;
+}
+
+// Clears the scratch registers so an intentional reboot is not reported as a fault
+void supervisor_clear(void) {
+    watchdog_hw->scratch[SUPERVISOR_SCRATCH_DISPATCH] = make_tag(SUPERVISOR_FAULT_NONE, SUPERVISOR_NO_TASK);
+    watchdog_hw->scratch[SUPERVISOR_SCRATCH_FAULT] = make_tag(SUPERVISOR_FAULT_NONE, SUPERVISOR_NO_TASK);
+    watchdog_hw->scratch[SUPERVISOR_SCRATCH_MEASURED] = 0;
+    watchdog_hw->scratch[SUPERVISOR_SCRATCH_LIMIT] = 0;
+}
+
+// Converts a fault type to a readable string
+const char *supervisor_fault_to_string(supervisor_fault_t fault) {
+    switch (fault) {
+        case SUPERVISOR_FAULT_NONE: return "NONE";
+        case SUPERVISOR_FAULT_HUNG: return "HUNG";
+        case SUPERVISOR_FAULT_EXEC_BUDGET: return "EXEC_BUDGET";
+        case SUPERVISOR_FAULT_RELEASE_GAP: return "RELEASE_GAP";
+        default: return "UNKNOWN";
+    }
+}
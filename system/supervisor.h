@@ -0,0 +1,83 @@
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hardware/watchdog.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#define SUPERVISOR_WATCHDOG_TIMEOUT_MS 1000   // Hardware watchdog timeout
+#define SUPERVISOR_CHECK_INTERVAL_US   10000  // Interval between release-gap checks and watchdog feeds
+#define SUPERVISOR_MAGIC               0x5356 // Marks scratch registers written by the supervisor ("SV")
+#define SUPERVISOR_NO_TASK             0xFF   // Task index stored when no task is being dispatched
+
+// Watchdog scratch registers used by the supervisor.
+// Registers 4-7 are reserved by the Pico SDK for watchdog_reboot().
+#define SUPERVISOR_SCRATCH_DISPATCH    0 // Magic and index of the task being dispatched
+#define SUPERVISOR_SCRATCH_FAULT       1 // Magic, fault type and index of the offending task
+#define SUPERVISOR_SCRATCH_MEASURED    2 // Measured time that caused the fault (us)
+#define SUPERVISOR_SCRATCH_LIMIT       3 // Limit that was violated (us)
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// Supervision fault types
+typedef enum {
+    SUPERVISOR_FAULT_NONE = 0,    // No fault, all supervised tasks healthy
+    SUPERVISOR_FAULT_HUNG,        // Task never returned, the watchdog fired during its dispatch
+    SUPERVISOR_FAULT_EXEC_BUDGET, // Task exceeded its maximum execution time
+    SUPERVISOR_FAULT_RELEASE_GAP  // Task was not dispatched within its maximum release gap
+} supervisor_fault_t;
+
+// Fault record, recovered from the watchdog scratch registers after a reset
+typedef struct {
+    bool valid;                // True if the last reset was caused by the supervisor
+    supervisor_fault_t fault;  // Type of fault
+    int task_index;            // Index of the offending task
+    uint32_t measured_us;      // Measured execution time or release gap
+    uint32_t limit_us;         // Configured limit that was violated
+} supervisor_record_t;
+
+// -----------------------------------------------------------------------------
+// Supervisor API
+// -----------------------------------------------------------------------------
+
+// Recovers the fault record of the previous boot (registered as initcall)
+void supervisor_init(void);
+
+// Enables the hardware watchdog, called once when the scheduler starts
+void supervisor_start(void);
+
+// Feeds the watchdog, unless a fault has been reported
+void supervisor_feed(void);
+
+// Records a fault in the scratch registers and stops feeding the watchdog
+void supervisor_report_fault(supervisor_fault_t fault, int task_index, int64_t measured_us, int64_t limit_us);
+
+// Returns true while no fault has been reported
+bool supervisor_is_healthy(void);
+
+// Returns the fault record recovered at boot
+const supervisor_record_t *supervisor_get_last_reset(void);
+
+// Clears the fault record in the scratch registers
+// Called at boot once the record is reported, and by REBOOT before an intentional reboot.
+void supervisor_clear(void);
+
+// Converts a fault type to a readable string
+const char *supervisor_fault_to_string(supervisor_fault_t fault);
+
+// Marks the start and end of a task dispatch.
+// A single register write each, so a hung task can be identified after the watchdog reset.
+static inline void supervisor_mark_dispatch(int task_index) {
+    watchdog_hw->scratch[SUPERVISOR_SCRATCH_DISPATCH] = ((uint32_t)SUPERVISOR_MAGIC << 16) | (uint8_t)task_index;
+}
+
+static inline void supervisor_mark_idle(void) {
+    watchdog_hw->scratch[SUPERVISOR_SCRATCH_DISPATCH] = ((uint32_t)SUPERVISOR_MAGIC << 16) | SUPERVISOR_NO_TASK;
+}
+
+#endif // SUPERVISOR_H
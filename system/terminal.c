@@ -1,105 +1,318 @@
 #include "terminal.h"
-#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
+
+#include "pico/time.h"
+#include "metrics.h"
+#include "scheduler.h"
+#include "initcalls.h"
+#include "fmt.h"
+
+// Command index generated by tools/gen_commands.py and the section it indexes
+extern const terminal_command_index_t terminal_command_index;
+extern const terminal_command_t *const __start_commands[];
+extern const terminal_command_t *const __stop_commands[];
+
+// Metrics shared by all terminal contexts
+static histogram_t command_time_histogram; // Handler execution time (us)
+static metric_t metric_commands = { .name = "terminal_commands_total", .help = "Commands executed", .type = METRIC_COUNTER };
+static metric_t metric_unknown = { .name = "terminal_unknown_commands_total", .help = "Unknown commands", .type = METRIC_COUNTER };
+static metric_t metric_auth_rejected = { .name = "terminal_auth_rejected_total", .help = "Commands rejected before login", .type = METRIC_COUNTER };
+static metric_t metric_command_time = { .name = "terminal_command_time_us", .help = "Command handler execution time", .type = METRIC_HISTOGRAM,
+                                        .histogram = &command_time_histogram };
+
+static void terminal_metrics_init(void) {
+    metrics_register(&metric_commands);
+    metrics_register(&metric_unknown);
+    metrics_register(&metric_auth_rejected);
+    metrics_register(&metric_command_time);
+}
+REGISTER_INITCALL_LEVEL(terminal_metrics_init, INITCALL_CORE);
+
+// Reports commands of the linker section missing from the generated index
+// Happens when a source declaring commands is not passed to the generator.
+static void terminal_commands_check(void) {
+    size_t count = (size_t)(__stop_commands - __start_commands);
+    for (size_t i = 0; i < count; i++) {
+        if (terminal_find_command(__start_commands[i]->command) != __start_commands[i]) {
+            fmt_printf("[TERMINAL][ERROR] Command %s missing from the index.\n", __start_commands[i]->command);
+        }
+    }
+    if (count != terminal_command_index.count) {
+        fmt_printf("[TERMINAL][ERROR] %u commands linked, %u indexed.\n", (unsigned)count, (unsigned)terminal_command_index.count);
+    }
+}
+REGISTER_INITCALL_LEVEL(terminal_commands_check, INITCALL_CORE);
+
+// FNV-1a hash of a command name, same as tools/gen_commands.py
+static inline uint32_t command_hash(const char *name) {
+    uint32_t h = 2166136261u;
+    while (*name) {
+        h = (h ^ (uint8_t)*name++) * 16777619u;
+    }
+    return h;
+}
 
 // Initializes the terminal context
 // Resets all fields and prepares the context for use.
 void terminal_init(terminal_context_t *context) {
-    context->command_count = 0;
     context->history_index = 0;
     context->authenticated = 0;
     context->enable_vt100_features = 0; // VT100 features are disabled by default
+    context->link = NULL;
     memset(context->command_history, 0, sizeof(context->command_history));
 }
 
-// Registers a command in the terminal context
-// Adds a command, description, and handler function to the command table.
-void terminal_register_command(terminal_context_t *context, const char *command, const char *description, terminal_command_handler_t handler) {
-    if (context->command_count < MAX_COMMANDS) {
-        context->command_table[context->command_count++] = (terminal_command_t){command, description, handler};
-    } else {
-        terminal_print_message("[SYSTEM][ERROR] Maximum number of commands reached.\n", COLOR_RED, context);
+// Executes a given command string, then shows the prompt
+void terminal_execute_command(terminal_context_t *context, const char *cmd) {
+    terminal_run_commands(context, cmd);
+
+    // Show the prompt if the command is not LOGIN
+    if (terminal_is_authenticated(context)) {
+        terminal_show_prompt(context);
     }
 }
 
-// Executes a given command string
-// Parses the command and its arguments, then invokes the appropriate handler.
-void terminal_execute_command(terminal_context_t *context, const char *cmd) {
-    char command_buffer[CMD_BUFFER_SIZE];
-    size_t cmd_len = strlen(cmd);
-
-    // Duplicate the string to avoid modifying the original
-    strncpy(command_buffer, cmd, CMD_BUFFER_SIZE - 1);
-    command_buffer[CMD_BUFFER_SIZE - 1] = '\0';
-
-    char *command = command_buffer;
-    char *next_command = NULL;
-
-    do {
-        // Find the next delimiter ";"
-        next_command = strchr(command, ';');
-        if (next_command) {
-            *next_command = '\0'; // Terminate the current command
-            next_command++;       // Move to the next command
-        }
+// Splits the next command of a line into arguments, in place
+// Arguments are separated by spaces; single or double quotes group words and
+// may hold ';', and \" or \\ inside double quotes stand for the character.
+// argv points into the line, which is rewritten without the quotes. Returns the
+// number of arguments, which may exceed max_args; *cursor moves past the ';' that
+// ends the command, or becomes NULL at the end of the line.
+size_t terminal_tokenize(char **cursor, char **argv, size_t max_args) {
+    char *p = *cursor;
+    size_t argc = 0;
 
-        // Trim leading and trailing spaces
-        while (*command == ' ') command++;
-        char *end = command + strlen(command) - 1;
-        while (end > command && *end == ' ') {
-            *end = '\0';
-            end--;
+    *cursor = NULL;
+    for (;;) {
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0') break;
+        if (*p == ';') {
+            *cursor = p + 1;
+            break;
         }
 
-        // Process the command if it is not empty
-        if (strlen(command) > 0) {
-            char cmd_copy[CMD_BUFFER_SIZE];
-            strncpy(cmd_copy, command, CMD_BUFFER_SIZE);
-
-            char *args[MAX_ARGS];
-            size_t argc = 0;
-            char *token = strtok(cmd_copy, " ");
-            while (token && argc < MAX_ARGS) {
-                args[argc++] = token;
-                token = strtok(NULL, " ");
+        // The unquoted text is never longer than the source, it is written over it
+        char *start = p, *out = p;
+        char quote = 0;
+        while (*p) {
+            char c = *p;
+            if (quote) {
+                if (c == quote) {
+                    quote = 0;
+                    p++;
+                    continue;
+                }
+                if (c == '\\' && quote == '"' && (p[1] == '"' || p[1] == '\\')) c = *++p;
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+                p++;
+                continue;
+            } else if (c == ' ' || c == '\t' || c == ';') {
+                break;
             }
+            *out++ = c;
+            p++;
+        }
+        char end = *p; // The terminator may overwrite the delimiter
+        *out = '\0';
+        if (argc < max_args) argv[argc] = start;
+        argc++;
+
+        if (end == '\0') break;
+        if (end == ';') {
+            *cursor = p + 1;
+            break;
+        }
+        p++;
+    }
+    return argc;
+}
 
-            if (argc == 0) {
-                terminal_print_message("[SYSTEM][ERROR] Empty command.\n", COLOR_RED, context);
+// Prints the accepted forms of a command
+void terminal_print_usage(const terminal_command_t *command) {
+    if (command->form_count == 0) {
+        fmt_printf("Usage: %s\n", command->command);
+    }
+    for (size_t f = 0; f < command->form_count; f++) {
+        const terminal_form_t *form = &command->forms[f];
+        fmt_printf("Usage: %s", command->command);
+        for (size_t i = 0; i < form->count; i++) {
+            const terminal_arg_t *a = &form->args[i];
+            bool optional = a->flags & TERMINAL_ARG_OPTIONAL;
+            fmt_printf(" %s", optional ? "[" : "");
+            if (a->type == TERMINAL_ARG_KEYWORD) {
+                fmt_printf("%s", a->name);
+            } else if (a->type == TERMINAL_ARG_ENUM) {
+                for (const char *const *w = a->choices; *w; w++) fmt_printf("%s%s", w == a->choices ? "" : "|", *w);
             } else {
-                if (!terminal_is_authenticated(context) && strcmp(args[0], "LOGIN") != 0) {
-                    terminal_print_message("[SYSTEM][ERROR] Authentication required. Use 'LOGIN <password>' to proceed.\n", COLOR_RED, context);
-                    return;
-                }
+                fmt_printf("<%s%s>", a->name, a->flags & TERMINAL_ARG_ALL ? "|ALL" : "");
+            }
+            fmt_printf("%s", optional ? "]" : "");
+        }
+        fmt_printf("\n");
+    }
+}
 
-                int found = 0;
-                for (size_t i = 0; i < context->command_count; i++) {
-                    if (strcmp(args[0], context->command_table[i].command) == 0) {
-                        context->command_table[i].handler(context, argc, args);
-                        found = 1;
-                        break;
-                    }
-                }
-                if (!found) {
-                    char error_message[CMD_BUFFER_SIZE];
-                    snprintf(error_message, CMD_BUFFER_SIZE, "[SYSTEM][ERROR] Unknown command '%s'. Use 'HELP'.\n", args[0]);
-                    terminal_print_message(error_message, COLOR_RED, context);
+// Converts one argument, returns false if the word does not fit its declaration
+bool terminal_convert_arg(const terminal_arg_t *a, const char *word, terminal_value_t *value) {
+    char *end;
+    switch (a->type) {
+        case TERMINAL_ARG_KEYWORD:
+            value->s = word;
+            return strcmp(word, a->name) == 0;
+        case TERMINAL_ARG_INT: {
+            bool hex = word[0] == '0' && (word[1] == 'x' || word[1] == 'X');
+            long v = strtol(word, &end, hex ? 16 : 10);
+            value->i = (int32_t)v;
+            return *word && !*end && v >= a->min && v <= a->max;
+        }
+        case TERMINAL_ARG_FLOAT:
+            value->f = strtof(word, &end);
+            return *word && !*end;
+        case TERMINAL_ARG_ENUM:
+            for (const char *const *w = a->choices; *w; w++) {
+                if (strcmp(word, *w) == 0) {
+                    value->i = (int32_t)(w - a->choices);
+                    return true;
                 }
             }
+            return false;
+        case TERMINAL_ARG_TASK: {
+            if ((a->flags & TERMINAL_ARG_ALL) && strcmp(word, "ALL") == 0) {
+                value->i = TERMINAL_ALL_TASKS;
+                return true;
+            }
+            long v = strtol(word, &end, 10);
+            value->i = *word && !*end ? (int32_t)v : scheduler_find_task(word);
+            return value->i >= 0 && value->i < scheduler_get_task_count();
+        }
+        default:
+            value->s = word;
+            return true;
+    }
+}
+
+// Matches the arguments against the forms of a command and converts them
+// A form applies when its keywords match the words given; the first applying
+// form whose arguments all convert is selected. Returns false after printing
+// the first problem of an applying form and the usage.
+static bool terminal_parse_args(terminal_context_t *context, const terminal_command_t *command, size_t argc, char **argv, terminal_args_t *args) {
+    static const terminal_form_t no_arguments = FORM_NONE;
+    const terminal_form_t *forms = command->form_count ? command->forms : &no_arguments;
+    size_t form_count = command->form_count ? command->form_count : 1;
+    const terminal_arg_t *failed = NULL; // Invalid or missing argument
+    const char *failed_word = NULL;      // NULL when missing
+    bool too_many = false;
+
+    for (size_t f = 0; f < form_count; f++) {
+        const terminal_form_t *form = &forms[f];
+        size_t given = argc < form->count ? argc : form->count;
+        bool applies = true;
+        for (size_t i = 0; i < given && applies; i++) {
+            if (form->args[i].type == TERMINAL_ARG_KEYWORD) applies = strcmp(argv[i], form->args[i].name) == 0;
+        }
+        if (!applies) continue;
+
+        size_t bad = given;
+        for (size_t i = 0; i < given && bad == given; i++) {
+            if (!terminal_convert_arg(&form->args[i], argv[i], &args->values[i])) bad = i;
+        }
+        bool missing = argc < form->count && !(form->args[argc].flags & TERMINAL_ARG_OPTIONAL);
+
+        if (bad == given && !missing && argc <= form->count) {
+            for (size_t i = argc; i < form->count; i++) {
+                args->values[i].i = form->args[i].fallback;
+                if (form->args[i].type == TERMINAL_ARG_STRING) args->values[i].s = NULL;
+            }
+            args->form = f;
+            args->count = argc;
+            return true;
+        }
 
-            // Add the current command to the history
-            strncpy(context->command_history[context->history_index], command, CMD_BUFFER_SIZE - 1);
-            context->command_history[context->history_index][CMD_BUFFER_SIZE - 1] = '\0';
-            context->history_index = (context->history_index + 1) % HISTORY_SIZE;
+        if (failed) continue;
+        if (bad < given) {
+            failed = &form->args[bad];
+            failed_word = argv[bad];
+        } else if (missing && form->args[argc].type != TERMINAL_ARG_KEYWORD) {
+            failed = &form->args[argc];
+        } else if (argc > form->count) {
+            too_many = true;
         }
+    }
 
-        command = next_command; // Move to the next command
+    char error_message[CMD_BUFFER_SIZE];
+    if (failed && failed_word && failed->type == TERMINAL_ARG_INT) {
+        fmt_snprintf(error_message, sizeof(error_message), "[SYSTEM][ERROR] Invalid %s '%s', expected %ld..%ld.\n",
+                     failed->name, failed_word, (long)failed->min, (long)failed->max);
+    } else if (failed && failed_word) {
+        fmt_snprintf(error_message, sizeof(error_message), "[SYSTEM][ERROR] Invalid %s '%s'.\n", failed->name, failed_word);
+    } else if (failed) {
+        fmt_snprintf(error_message, sizeof(error_message), "[SYSTEM][ERROR] Missing %s.\n", failed->name);
+    } else {
+        fmt_snprintf(error_message, sizeof(error_message), "[SYSTEM][ERROR] %s.\n", too_many ? "Too many arguments" : argc ? "Invalid arguments" : "Missing arguments");
+    }
+    terminal_print_message(error_message, COLOR_RED, context);
+    terminal_print_usage(command);
+    return false;
+}
 
-    } while (command != NULL);
+// Runs one command: login check, lookup, argument conversion and handler
+// Returns false if the command was rejected for missing authentication.
+static bool terminal_dispatch(terminal_context_t *context, size_t argc, char **argv) {
+    if (!terminal_is_authenticated(context) && strcmp(argv[0], "LOGIN") != 0) {
+        terminal_print_message("[SYSTEM][ERROR] Authentication required. Use 'LOGIN <password>' to proceed.\n", COLOR_RED, context);
+        metric_inc(&metric_auth_rejected);
+        return false;
+    }
 
-    // Show the prompt if the command is not LOGIN
-    if (terminal_is_authenticated(context)) {
-        terminal_show_prompt(context);
+    const terminal_command_t *c = terminal_find_command(argv[0]);
+    if (!c) {
+        metric_inc(&metric_unknown);
+        char error_message[CMD_BUFFER_SIZE];
+        fmt_snprintf(error_message, CMD_BUFFER_SIZE, "[SYSTEM][ERROR] Unknown command '%s'. Use 'HELP'.\n", argv[0]);
+        terminal_print_message(error_message, COLOR_RED, context);
+        return true;
+    }
+
+    terminal_args_t args;
+    if (argc > MAX_ARGS) {
+        terminal_print_message("[SYSTEM][ERROR] Too many arguments.\n", COLOR_RED, context);
+    } else if (terminal_parse_args(context, c, argc - 1, argv + 1, &args)) {
+        uint32_t start_us = time_us_32();
+        c->handler(context, &args);
+        histogram_record(&command_time_histogram, time_us_32() - start_us);
+        metric_inc(&metric_commands);
+    }
+    return true;
+}
+
+// Executes the commands of a line separated by ";" without showing the prompt
+// The line is copied once and tokenized in place; the history keeps the text as typed.
+void terminal_run_commands(terminal_context_t *context, const char *cmd) {
+    char buffer[CMD_BUFFER_SIZE];
+    char *argv[MAX_ARGS];
+    size_t length = strnlen(cmd, CMD_BUFFER_SIZE - 1);
+
+    memcpy(buffer, cmd, length);
+    buffer[length] = '\0';
+
+    char *cursor = buffer;
+    while (cursor) {
+        size_t start = (size_t)(cursor - buffer);
+        size_t argc = terminal_tokenize(&cursor, argv, MAX_ARGS);
+        if (argc == 0) continue;
+        if (!terminal_dispatch(context, argc, argv)) return;
+
+        // Add the command, trimmed, to the history
+        size_t end = cursor ? (size_t)(cursor - buffer) - 1 : length;
+        while (cmd[start] == ' ' || cmd[start] == '\t') start++;
+        while (end > start && (cmd[end - 1] == ' ' || cmd[end - 1] == '\t')) end--;
+        size_t n = end - start < CMD_BUFFER_SIZE - 1 ? end - start : CMD_BUFFER_SIZE - 1;
+        memcpy(context->command_history[context->history_index], cmd + start, n);
+        context->command_history[context->history_index][n] = '\0';
+        context->history_index = (context->history_index + 1) % HISTORY_SIZE;
     }
 }
 
@@ -111,7 +324,7 @@ void terminal_show_history(terminal_context_t *context) {
         int idx = (context->history_index - i - 1 + HISTORY_SIZE) % HISTORY_SIZE;
         if (context->command_history[idx][0] != '\0') {
             char history_message[CMD_BUFFER_SIZE];
-            snprintf(history_message, CMD_BUFFER_SIZE, " %d: %s\n", HISTORY_SIZE - i, context->command_history[idx]);
+            fmt_snprintf(history_message, CMD_BUFFER_SIZE, " %d: %s\n", HISTORY_SIZE - i, context->command_history[idx]);
             terminal_print_message(history_message, COLOR_BLUE, context);
         }
     }
@@ -138,7 +351,7 @@ void terminal_show_prompt(terminal_context_t *context) {
     if (context->enable_vt100_features) {
         terminal_print_message("skeleton> ", COLOR_GREEN, context);
     } else {
-        printf("skeleton> "); // Standard prompt
+        fmt_printf("skeleton> "); // Standard prompt
     }
 }
 
@@ -146,8 +359,84 @@ void terminal_show_prompt(terminal_context_t *context) {
 // Uses VT100 colors if enabled.
 void terminal_print_message(const char *message, const char *color, terminal_context_t *context) {
     if (context->enable_vt100_features && color) {
-        printf("%s%s%s", color, message, COLOR_RESET);
+        fmt_printf("%s%s%s", color, message, COLOR_RESET);
     } else {
-        printf("%s", message);
+        fmt_printf("%s", message);
+    }
+}
+
+// Finds a command by its exact name
+// One hash of the name selects a bucket, its displacement selects the only slot
+// the name can occupy, and one compare confirms it.
+const terminal_command_t *terminal_find_command(const char *name) {
+    const terminal_command_index_t *index = &terminal_command_index;
+    uint32_t h = command_hash(name);
+    uint32_t d = index->displacements[h % index->bucket_count];
+    const terminal_command_t *c = index->slots[((h ^ d) * 2654435761u) >> (32 - index->slot_bits)];
+    return c && strcmp(c->command, name) == 0 ? c : NULL;
+}
+
+// Finds the commands starting with a prefix
+// Returns how many there are; they are contiguous in name order from *first.
+size_t terminal_find_prefix(const char *prefix, size_t length, size_t *first) {
+    const terminal_command_index_t *index = &terminal_command_index;
+    size_t low = 0, high = index->count;
+    while (low < high) { // First name not below the prefix
+        size_t mid = (low + high) / 2;
+        if (strncmp(index->sorted[mid]->command, prefix, length) < 0) low = mid + 1;
+        else high = mid;
+    }
+    size_t end = low;
+    while (end < index->count && strncmp(index->sorted[end]->command, prefix, length) == 0) end++;
+    *first = low;
+    return end - low;
+}
+
+const terminal_command_t *terminal_get_command(size_t index) {
+    return index < terminal_command_index.count ? terminal_command_index.sorted[index] : NULL;
+}
+
+size_t terminal_get_command_count(void) {
+    return terminal_command_index.count;
+}
+
+// Completes the command name being typed at the end of a line
+// Appends the part shared by all the matching names, plus a space when only one
+// matches; when nothing can be appended the matches are listed and the line is
+// shown again. Returns the number of characters appended to line.
+size_t terminal_complete(terminal_context_t *context, char *line, size_t length, size_t size) {
+    if (!terminal_is_authenticated(context)) return 0;
+
+    // Only the first word of the last command of the line is a command name
+    size_t start = length;
+    while (start > 0 && line[start - 1] != ';') start--;
+    while (start < length && line[start] == ' ') start++;
+    if (memchr(line + start, ' ', length - start)) return 0;
+
+    size_t first;
+    size_t count = terminal_find_prefix(line + start, length - start, &first);
+    if (count == 0) return 0;
+
+    // Names are sorted: the first and the last match share what all of them share
+    const char *name = terminal_get_command(first)->command;
+    const char *last = terminal_get_command(first + count - 1)->command;
+    size_t common = length - start;
+    while (name[common] && name[common] == last[common]) common++;
+
+    size_t added = 0;
+    for (size_t i = length - start; i < common && length + added < size - 1; i++) {
+        line[length + added++] = name[i];
+    }
+    if (count == 1 && length + added < size - 1) {
+        line[length + added++] = ' ';
+    } else if (count > 1 && added == 0) {
+        fmt_printf("\n");
+        for (size_t i = 0; i < count; i++) {
+            fmt_printf("%s  ", terminal_get_command(first + i)->command);
+        }
+        fmt_printf("\n");
+        terminal_show_prompt(context);
+        fmt_printf("%.*s", (int)length, line);
     }
+    return added;
 }
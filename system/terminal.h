@@ -1,13 +1,14 @@
 #ifndef TERMINAL_H
 #define TERMINAL_H
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 // Buffer and history sizes
 #define CMD_BUFFER_SIZE 128
 #define HISTORY_SIZE 15
 #define MAX_ARGS 10
-#define MAX_COMMANDS 20
 
 // VT100 color codes
 #define COLOR_RED "\033[31m"
@@ -16,37 +17,138 @@
 #define COLOR_YELLOW "\033[33m"
 #define COLOR_RESET "\033[0m"
 
+// VT100 screen control
+#define VT100_CLEAR_SCREEN "\033[2J"
+#define VT100_CLEAR_LINE "\033[K"
+#define VT100_CURSOR_HIDE "\033[?25l"
+#define VT100_CURSOR_SHOW "\033[?25h"
+#define VT100_CURSOR_TO "\033[%d;%dH" // Format of a move to row, column (from 1)
+
+// Argument types of a command form
+#define TERMINAL_ARG_KEYWORD 0 // Literal word selecting the form, e.g. PRIO in TASK PRIO
+#define TERMINAL_ARG_INT     1 // Decimal or 0x hexadecimal integer within [min, max]
+#define TERMINAL_ARG_FLOAT   2
+#define TERMINAL_ARG_ENUM    3 // One of choices, converted to its index
+#define TERMINAL_ARG_TASK    4 // Task ID or name, converted to a valid task index
+#define TERMINAL_ARG_STRING  5 // Any word, quoted if it contains spaces
+
+#define TERMINAL_ARG_OPTIONAL (1u << 0) // May be omitted, only at the end of a form
+#define TERMINAL_ARG_ALL      (1u << 1) // TERMINAL_ARG_TASK also accepts ALL, converted to TERMINAL_ALL_TASKS
+#define TERMINAL_ALL_TASKS    (-1)
+
 // Forward declaration of the terminal context structure for compatibility
 struct terminal_context_t;
 
+// Argument of a command form, kept in flash
+typedef struct {
+    uint8_t type;                 // TERMINAL_ARG_*
+    uint8_t flags;                // TERMINAL_ARG_OPTIONAL, TERMINAL_ARG_ALL
+    const char *name;             // The word of a keyword, the placeholder shown in the usage otherwise
+    int32_t min, max;             // Range of an integer
+    int32_t fallback;             // Value of an omitted optional integer or enum
+    const char *const *choices;   // Words of an enum, NULL terminated
+} terminal_arg_t;
+
+// One accepted argument list of a command
+typedef struct {
+    const terminal_arg_t *args;
+    size_t count;
+} terminal_form_t;
+
+// Converted arguments, one value per argument of the matched form
+typedef union {
+    int32_t i;                    // Integer, enum index or task index
+    float f;
+    const char *s;                // String or keyword, points into the command line
+} terminal_value_t;
+
+typedef struct {
+    size_t form;                  // Index of the matched form
+    size_t count;                 // Arguments given, omitted optionals hold their fallback
+    terminal_value_t values[MAX_ARGS];
+} terminal_args_t;
+
 // Function pointer type for terminal commands
-typedef void (*terminal_command_handler_t)(struct terminal_context_t *context, size_t argc, char **argv);
+typedef void (*terminal_command_handler_t)(struct terminal_context_t *context, const terminal_args_t *args);
 
 // Command structure
 typedef struct {
     const char *command;               // Command keyword
     const char *description;           // Description of the command
     terminal_command_handler_t handler; // Function handler for the command
+    const terminal_form_t *forms;      // Accepted argument lists, none: no arguments
+    size_t form_count;
 } terminal_command_t;
 
+// Argument declarations
+#define ARG_KEYWORD(word)                      { TERMINAL_ARG_KEYWORD, 0, word, 0, 0, 0, NULL }
+#define ARG_INT(name, lo, hi)                  { TERMINAL_ARG_INT, 0, name, lo, hi, 0, NULL }
+#define ARG_INT_OPTIONAL(name, lo, hi, def)    { TERMINAL_ARG_INT, TERMINAL_ARG_OPTIONAL, name, lo, hi, def, NULL }
+#define ARG_FLOAT(name)                        { TERMINAL_ARG_FLOAT, 0, name, 0, 0, 0, NULL }
+#define ARG_ENUM(name, words)                  { TERMINAL_ARG_ENUM, 0, name, 0, 0, 0, words }
+#define ARG_ENUM_OPTIONAL(name, words, def)    { TERMINAL_ARG_ENUM, TERMINAL_ARG_OPTIONAL, name, 0, 0, def, words }
+#define ARG_TASK(name)                         { TERMINAL_ARG_TASK, 0, name, 0, 0, 0, NULL }
+#define ARG_TASK_OR_ALL(name)                  { TERMINAL_ARG_TASK, TERMINAL_ARG_ALL, name, 0, 0, 0, NULL }
+#define ARG_STRING(name)                       { TERMINAL_ARG_STRING, 0, name, 0, 0, 0, NULL }
+#define ARG_STRING_OPTIONAL(name)              { TERMINAL_ARG_STRING, TERMINAL_ARG_OPTIONAL, name, 0, 0, 0, NULL }
+
+// Form declarations, FORM_NONE accepts a command without arguments
+#define FORM(...) { (const terminal_arg_t[]){ __VA_ARGS__ }, sizeof((const terminal_arg_t[]){ __VA_ARGS__ }) / sizeof(terminal_arg_t) }
+#define FORM_NONE { NULL, 0 }
+
+// Lookup tables generated from the REGISTER_COMMAND declarations by tools/gen_commands.py
+typedef struct {
+    const terminal_command_t *const *sorted;   // Commands sorted by name
+    size_t count;
+    const uint16_t *displacements;             // Hash-and-displace table: bucket -> displacement
+    size_t bucket_count;
+    const terminal_command_t *const *slots;    // 2^slot_bits slots, NULL when empty
+    uint8_t slot_bits;
+} terminal_command_index_t;
+
+// Declares a command, kept in flash in the "commands" linker section
+// The section only holds pointers, so entries stay contiguous whatever the descriptor alignment.
+// The build generates the lookup index from these declarations: name and description must be
+// string literals and each handler is registered once.
+#define COMMAND_DEFINE(name, description, handler, forms, form_count) \
+    const terminal_command_t terminal_command_##handler = { name, description, handler, forms, form_count }; \
+    static const terminal_command_t *const terminal_command_ptr_##handler __attribute__((used, section("commands"))) = &terminal_command_##handler
+
+// Registers a command without arguments
+#define REGISTER_COMMAND(name, description, handler) COMMAND_DEFINE(name, description, handler, NULL, 0)
+
+// Registers a command whose arguments are checked against an array of forms
+// The first form matching the arguments is passed to the handler, already converted.
+#define REGISTER_COMMAND_ARGS(name, description, handler, forms) \
+    COMMAND_DEFINE(name, description, handler, forms, sizeof(forms) / sizeof(forms[0]))
+
 // Terminal context structure
 typedef struct terminal_context_t {
-    terminal_command_t command_table[MAX_COMMANDS]; // Table of registered commands
-    size_t command_count;                           // Number of registered commands
     char command_history[HISTORY_SIZE][CMD_BUFFER_SIZE]; // Command history buffer
     int history_index;                              // Current index in the history buffer
     int authenticated;                              // Authentication state
     int enable_vt100_features;                     // Flag to enable/disable VT100 features
+    void *link;                                     // State of the link the terminal runs on, owned by its driver
 } terminal_context_t;
 
 // Terminal API
 void terminal_init(terminal_context_t *context);
-void terminal_register_command(terminal_context_t *context, const char *command, const char *description, terminal_command_handler_t handler);
 void terminal_execute_command(terminal_context_t *context, const char *cmd);
+void terminal_run_commands(terminal_context_t *context, const char *cmd);
+size_t terminal_tokenize(char **cursor, char **argv, size_t max_args);
+bool terminal_convert_arg(const terminal_arg_t *a, const char *word, terminal_value_t *value); // One word, as the parser does
+void terminal_print_usage(const terminal_command_t *command);
 void terminal_show_history(terminal_context_t *context);
 void terminal_set_authenticated(terminal_context_t *context, int state);
 int terminal_is_authenticated(terminal_context_t *context);
 void terminal_show_prompt(terminal_context_t *context);
 void terminal_print_message(const char *message, const char *color, terminal_context_t *context);
 
+// Command registry API
+const terminal_command_t *terminal_find_command(const char *name); // Exact name, O(1)
+size_t terminal_find_prefix(const char *prefix, size_t length, size_t *first); // Number of matches, first sorted index
+const terminal_command_t *terminal_get_command(size_t index); // Sorted by name
+size_t terminal_get_command_count(void);
+size_t terminal_complete(terminal_context_t *context, char *line, size_t length, size_t size);
+
 #endif // TERMINAL_H
@@ -0,0 +1,110 @@
+#include <string.h>
+
+#include "trace.h"
+#include "scheduler.h"
+#include "initcalls.h"
+#include "fmt.h"
+
+// -----------------------------------------------------------------------------
+// Variables for State
+// -----------------------------------------------------------------------------
+trace_record_t trace_ring[TRACE_BUFFER_SIZE]; // Ring of binary records
+volatile uint32_t trace_head = 0;             // Total records written since trace_start
+volatile bool trace_running = false;          // Recording enabled
+
+_Static_assert((TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0, "TRACE_BUFFER_SIZE must be a power of two");
+_Static_assert(sizeof(trace_record_t) == 8, "trace records must stay 8 bytes");
+
+// Records from boot, so the events before a glitch are available without setup
+static void trace_init(void) {
+    trace_start();
+}
+REGISTER_INITCALL_LEVEL(trace_init, INITCALL_EARLY);
+
+void trace_start(void) {
+    trace_running = false;
+    trace_head = 0;
+    memset(trace_ring, 0, sizeof(trace_ring));
+    trace_running = true;
+}
+
+void trace_stop(void) {
+    trace_running = false;
+}
+
+uint32_t trace_get_count(void) {
+    return trace_head < TRACE_BUFFER_SIZE ? trace_head : TRACE_BUFFER_SIZE;
+}
+
+// Interrupts are masked during the copy, so no record is overwritten meanwhile
+uint32_t trace_copy_tail(trace_record_t *out, uint32_t max) {
+    uint32_t irq_state = save_and_disable_interrupts();
+    uint32_t count = trace_get_count();
+    if (count > max) count = max;
+    uint32_t first = trace_head - count;
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = trace_ring[(first + i) & (TRACE_BUFFER_SIZE - 1)];
+    }
+    restore_interrupts(irq_state);
+    return count;
+}
+
+const char *trace_type_to_string(uint8_t type) {
+    switch (type) {
+        case TRACE_TASK_RELEASE: return "RELEASE";
+        case TRACE_TASK_START: return "START";
+        case TRACE_TASK_END: return "END";
+        case TRACE_IRQ_ENTER: return "IRQ_ENTER";
+        case TRACE_IRQ_EXIT: return "IRQ_EXIT";
+        case TRACE_MARKER: return "MARKER";
+        case TRACE_ALGO_SWITCH: return "ALGO";
+        default: return "?";
+    }
+}
+
+void trace_dump_begin(trace_dump_t *dump) {
+    trace_stop();
+    dump->count = trace_get_count();
+    dump->first = trace_head - dump->count;
+    dump->line = 0;
+}
+
+// Lines: TRACE BEGIN, one TASK per task, one ALGO per algorithm, the R records, TRACE END
+// Task and algorithm names are included so the host converter needs no other input.
+bool trace_dump_step(trace_dump_t *dump) {
+    uint32_t tasks = (uint32_t)scheduler_get_task_count();
+    uint32_t records = dump->line - 1 - tasks - SCHED_ALGO_COUNT; // Record line, once past the headers
+    uint32_t record_lines = (dump->count + TRACE_RECORDS_PER_LINE - 1) / TRACE_RECORDS_PER_LINE;
+
+    if (dump->line == 0) {
+        fmt_printf("TRACE BEGIN records=%lu overwritten=%lu clock_hz=1000000\n",
+                   (unsigned long)dump->count, (unsigned long)dump->first);
+    } else if (dump->line <= tasks) {
+        fmt_printf("TASK %lu %s\n", (unsigned long)(dump->line - 1), scheduler_get_task((int)dump->line - 1)->name);
+    } else if (dump->line <= tasks + SCHED_ALGO_COUNT) {
+        uint32_t a = dump->line - 1 - tasks;
+        fmt_printf("ALGO %lu %s\n", (unsigned long)a, scheduler_algorithm_to_string((sched_algorithm_t)a));
+    } else if (records < record_lines) {
+        uint32_t end = (records + 1) * TRACE_RECORDS_PER_LINE;
+        if (end > dump->count) end = dump->count;
+        fmt_printf("R ");
+        for (uint32_t i = records * TRACE_RECORDS_PER_LINE; i < end; i++) {
+            const trace_record_t *r = &trace_ring[(dump->first + i) & (TRACE_BUFFER_SIZE - 1)];
+            fmt_printf("%08lx%02x%02x%04x", (unsigned long)r->time, r->type, r->id, r->arg);
+        }
+        fmt_printf("\n");
+    } else {
+        fmt_printf("TRACE END\n");
+        return false;
+    }
+    dump->line++;
+    return true;
+}
+
+// Prints the ring, oldest record first
+void trace_dump(void) {
+    trace_dump_t dump;
+    trace_dump_begin(&dump);
+    while (trace_dump_step(&dump)) {
+    }
+}
@@ -0,0 +1,126 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/time.h"
+#include "hardware/sync.h"
+
+// -----------------------------------------------------------------------------
+// Macros and Constants
+// -----------------------------------------------------------------------------
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED        1    // Set to 0 to compile all trace points out
+#endif
+#define TRACE_BUFFER_SIZE    1024 // Records in the ring (8 bytes each), power of two
+#define TRACE_RECORDS_PER_LINE 8  // Records per line of the hex dump
+
+// -----------------------------------------------------------------------------
+// Definitions and Types
+// -----------------------------------------------------------------------------
+
+// Event types
+typedef enum {
+    TRACE_TASK_RELEASE = 1, // Task became ready (id: task, time: release time)
+    TRACE_TASK_START,       // Dispatch begins (id: task, arg: active algorithm)
+    TRACE_TASK_END,         // Task returned to the scheduler (id: task)
+    TRACE_IRQ_ENTER,        // Interrupt handler entry (id: IRQ number)
+    TRACE_IRQ_EXIT,         // Interrupt handler exit (id: IRQ number)
+    TRACE_MARKER,           // User marker (id and arg chosen by the caller)
+    TRACE_ALGO_SWITCH       // Active algorithm changed (id: new algorithm)
+} trace_event_type_t;
+
+// Compact binary record, 8 bytes
+typedef struct {
+    uint32_t time;  // Low 32 bits of the microsecond timer
+    uint8_t type;   // trace_event_type_t
+    uint8_t id;     // Task index, IRQ number or marker id
+    uint16_t arg;   // Event argument
+} trace_record_t;
+
+// Position of a dump printed in steps
+typedef struct {
+    uint32_t first;  // Ring index of the oldest record
+    uint32_t count;  // Records in the dump
+    uint32_t line;   // Next line, headers included
+} trace_dump_t;
+
+// Ring storage, written inline by the trace points
+extern trace_record_t trace_ring[TRACE_BUFFER_SIZE];
+extern volatile uint32_t trace_head;   // Total records written, the ring index is head % size
+extern volatile bool trace_running;    // Recording enabled
+
+// -----------------------------------------------------------------------------
+// Trace Points
+// -----------------------------------------------------------------------------
+// A disabled-check, a timer read and two stores with interrupts masked, so trace
+// points can be called from tasks and interrupt handlers alike. When the ring is
+// full the oldest records are overwritten: the ring always holds the latest events.
+
+static inline void trace_event_at(uint32_t time, trace_event_type_t type, uint8_t id, uint16_t arg) {
+#if TRACE_ENABLED
+    if (!trace_running) return;
+    uint32_t irq_state = save_and_disable_interrupts();
+    trace_record_t *r = &trace_ring[trace_head++ & (TRACE_BUFFER_SIZE - 1)];
+    r->time = time;
+    r->type = (uint8_t)type;
+    r->id = id;
+    r->arg = arg;
+    restore_interrupts(irq_state);
+#else
+    (void)time; (void)type; (void)id; (void)arg;
+#endif
+}
+
+static inline void trace_event(trace_event_type_t type, uint8_t id, uint16_t arg) {
+#if TRACE_ENABLED
+    if (!trace_running) return;
+    trace_event_at(time_us_32(), type, id, arg);
+#else
+    (void)type; (void)id; (void)arg;
+#endif
+}
+
+// Interrupt handler entry and exit
+static inline void trace_irq_enter(uint8_t irq) {
+    trace_event(TRACE_IRQ_ENTER, irq, 0);
+}
+
+static inline void trace_irq_exit(uint8_t irq) {
+    trace_event(TRACE_IRQ_EXIT, irq, 0);
+}
+
+// User marker, e.g. trace_marker(1, sample_count) around a suspect code path
+static inline void trace_marker(uint8_t id, uint16_t arg) {
+    trace_event(TRACE_MARKER, id, arg);
+}
+
+// -----------------------------------------------------------------------------
+// Trace API
+// -----------------------------------------------------------------------------
+
+// Clears the ring and starts recording
+void trace_start(void);
+
+// Stops recording, the ring content is kept
+void trace_stop(void);
+
+// Returns the number of records held by the ring
+uint32_t trace_get_count(void);
+
+// Copies up to max of the latest records, oldest first, and returns how many
+uint32_t trace_copy_tail(trace_record_t *out, uint32_t max);
+
+// Converts an event type to a short name
+const char *trace_type_to_string(uint8_t type);
+
+// Stops recording and prints the ring as hex records between TRACE BEGIN and TRACE END
+// The output is converted to Perfetto/Chrome JSON by tools/trace2perfetto.py.
+void trace_dump(void);
+
+// The same dump one line per step: trace_dump_begin stops recording, each
+// trace_dump_step prints the next line and returns false after TRACE END
+void trace_dump_begin(trace_dump_t *dump);
+bool trace_dump_step(trace_dump_t *dump);
+
+#endif // TRACE_H
@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+"""Compares two benchmark runs and fails on regressions.
+
+Input files are the CSV printed by sched_bench or by the BENCH terminal command;
+other lines (prompt, log messages of a terminal capture) are ignored.
+
+    tools/bench_compare.py baseline.csv current.csv [--threshold 10]
+"""
+
+import argparse
+import sys
+
+
+def load(path):
+    """Returns {(case, size): ns_per_op} for the bench rows of a file."""
+    rows = {}
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            fields = line.strip().split(",")
+            if len(fields) < 6 or fields[0] != "bench" or fields[1] == "case":
+                continue
+            rows[(fields[1], int(fields[2]))] = float(fields[5])
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0, help="allowed slowdown in percent (default 10)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    regressions = 0
+
+    print(f"{'Case':<45} {'Size':>5} {'Base ns':>10} {'Now ns':>10} {'Change':>8}")
+    for key in sorted(baseline.keys() & current.keys()):
+        base, now = baseline[key], current[key]
+        change = (now - base) / base * 100.0 if base > 0 else 0.0
+        flag = ""
+        if change > args.threshold and key[0] != "bench_overhead":
+            flag = "  REGRESSION"
+            regressions += 1
+        print(f"{key[0]:<45} {key[1]:>5} {base:>10.2f} {now:>10.2f} {change:>+7.1f}%{flag}")
+
+    for key in sorted(baseline.keys() - current.keys()):
+        print(f"{key[0]:<45} {key[1]:>5} missing from {args.current}")
+
+    if regressions:
+        print(f"{regressions} case(s) slower than {args.threshold:.0f}%")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""Generates the perfect-hash index of the terminal commands.
+
+Scans the sources of a target for REGISTER_COMMAND("NAME", "description", handler)
+and REGISTER_COMMAND_ARGS("NAME", "description", handler, forms) and writes a C file with the tables searched by system/terminal.c: the commands
+sorted by name (prefix lookup, HELP) and a hash-and-displace table, so a command
+is found with one hash of its name and one string compare whatever their number.
+The name must be a string literal, the description may be split into adjacent
+literals; any other REGISTER_COMMAND outside a #define fails the build.
+
+    tools/gen_commands.py -o commands_index.c app/terminal/cmd.c system/bench.c ...
+
+The hash must match command_hash() in system/terminal.c.
+"""
+
+import argparse
+import re
+import sys
+
+STRING = r'"(?:[^"\\\n]|\\.)*"'
+COMMAND_RE = re.compile(r'REGISTER_COMMAND(?:_ARGS)?\s*\(\s*"((?:[^"\\\n]|\\.)*)"\s*,\s*(?:%s\s*)+,\s*(\w+)\s*[,)]' % STRING)
+INVOCATION_RE = re.compile(r'\bREGISTER_COMMAND(?:_ARGS)?\s*\(')
+COMMENT_RE = re.compile(r"//[^\n]*|/\*.*?\*/|(%s|'(?:[^'\\\n]|\\.)*')" % STRING, re.S)
+MAX_DISPLACEMENT = 0xFFFF
+
+
+def fnv1a(name):
+    h = 2166136261
+    for b in name.encode():
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def slot_of(h, displacement, bits):
+    return (((h ^ displacement) * 2654435761) & 0xFFFFFFFF) >> (32 - bits)
+
+
+def strip_comments(text):
+    """Blanks the comments, keeping string literals and line numbers."""
+    return COMMENT_RE.sub(lambda m: m.group(1) or re.sub(r"[^\n]", " ", m.group(0)), text)
+
+
+def in_define(text, pos):
+    """True if pos is on a preprocessor line, continuation lines included."""
+    start = text.rfind("\n", 0, pos) + 1
+    while start > 1 and text[start - 2] == "\\":
+        start = text.rfind("\n", 0, start - 1) + 1
+    return text[start:pos].lstrip().startswith("#")
+
+
+def scan(paths):
+    """Returns [(name, handler)] in source order, raises ValueError on an unparsable registration."""
+    commands = []
+    for path in paths:
+        with open(path, encoding="utf-8") as f:
+            text = strip_comments(f.read())
+        for invocation in INVOCATION_RE.finditer(text):
+            if in_define(text, invocation.start()):
+                continue
+            match = COMMAND_RE.match(text, invocation.start())
+            if not match:
+                line = text.count("\n", 0, invocation.start()) + 1
+                raise ValueError("%s:%d: cannot parse the command registration" % (path, line))
+            commands.append(match.groups())
+    return commands
+
+
+def build(commands):
+    """Returns (bucket_count, bits, displacements, slots) of a collision-free table."""
+    hashes = {name: fnv1a(name) for name, _ in commands}
+    if len(set(hashes.values())) != len(hashes):
+        raise ValueError("two command names have the same hash, rename one")
+
+    bits = 1
+    while (1 << bits) < 2 * len(commands):
+        bits += 1
+    bucket_count = max(1, (len(commands) + 1) // 2)
+
+    buckets = [[] for _ in range(bucket_count)]
+    for name, _ in commands:
+        buckets[hashes[name] % bucket_count].append(name)
+
+    # Largest buckets first, each takes the first displacement that fits all its names
+    slots = [None] * (1 << bits)
+    displacements = [0] * bucket_count
+    for b in sorted(range(bucket_count), key=lambda i: -len(buckets[i])):
+        if not buckets[b]:
+            continue
+        for d in range(MAX_DISPLACEMENT + 1):
+            taken = [slot_of(hashes[name], d, bits) for name in buckets[b]]
+            if len(set(taken)) == len(taken) and all(slots[s] is None for s in taken):
+                for name, s in zip(buckets[b], taken):
+                    slots[s] = name
+                displacements[b] = d
+                break
+        else:
+            raise ValueError("no displacement found for bucket %d" % b)
+    return bucket_count, bits, displacements, slots
+
+
+def render(commands, bucket_count, bits, displacements, slots):
+    handlers = dict(commands)
+    ref = lambda name: "&terminal_command_%s" % handlers[name]
+    out = ["// Generated by tools/gen_commands.py, do not edit", "",
+           '#include "terminal.h"', ""]
+    for name, handler in commands:
+        out.append("extern const terminal_command_t terminal_command_%s;" % handler)
+    out.append("")
+
+    out.append("static const terminal_command_t *const sorted[] = {")
+    out += ["    %s, // %s" % (ref(name), name) for name in sorted(handlers)] or ["    NULL,"]
+    out.append("};")
+    out.append("")
+    out.append("static const uint16_t displacements[%d] = { %s };" % (bucket_count, ", ".join(map(str, displacements))))
+    out.append("")
+    out.append("static const terminal_command_t *const slots[%d] = {" % len(slots))
+    out += ["    [%d] = %s, // %s" % (i, ref(name), name) for i, name in enumerate(slots) if name]
+    out.append("};")
+    out.append("")
+    out.append("const terminal_command_index_t terminal_command_index = {")
+    out.append("    sorted, %d, displacements, %d, slots, %d," % (len(commands), bucket_count, bits))
+    out.append("};")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-o", "--output", required=True)
+    parser.add_argument("sources", nargs="+")
+    args = parser.parse_args()
+
+    try:
+        commands = scan(args.sources)
+    except ValueError as e:
+        sys.exit("gen_commands: %s" % e)
+    names = [name for name, _ in commands]
+    duplicates = sorted({name for name in names if names.count(name) > 1})
+    if duplicates:
+        sys.exit("gen_commands: duplicate commands: %s" % ", ".join(duplicates))
+    try:
+        table = build(commands)
+    except ValueError as e:
+        sys.exit("gen_commands: %s" % e)
+
+    with open(args.output, "w", encoding="utf-8") as f:
+        f.write(render(commands, *table))
+
+
+if __name__ == "__main__":
+    main()
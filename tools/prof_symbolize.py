@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Maps PROF DUMP samples to functions using the firmware ELF.
+
+The input is a terminal log containing the output of PROF DUMP; lines outside the
+PROF BEGIN / PROF END block are ignored. Symbols are read with nm from the ARM
+toolchain, so no Python packages are needed.
+
+    tools/prof_symbolize.py capture.txt build/RT.elf [--top 20] [--nm arm-none-eabi-nm]
+"""
+
+import argparse
+import bisect
+import collections
+import subprocess
+import sys
+
+
+def load_symbols(elf, nm):
+    """Returns sorted (start, size, name) tuples of the code symbols of the ELF."""
+    output = subprocess.run([nm, "-n", "-S", "--defined-only", elf], check=True,
+                            capture_output=True, text=True).stdout
+    symbols = []
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[2] in "tTwW":
+            symbols.append((int(fields[0], 16) & ~1, int(fields[1], 16), fields[3]))
+    symbols.sort()
+    return symbols
+
+
+def parse(lines):
+    """Returns (header, tasks, samples) of the PROF BEGIN/END block."""
+    header, tasks, samples = "", {}, []
+    inside = False
+    for line in lines:
+        line = line.strip()
+        if "PROF BEGIN" in line:
+            header, tasks, samples = line[line.find("PROF BEGIN") + 11:], {}, []
+            inside = True
+            continue
+        if not inside:
+            continue
+        if line.startswith("PROF END"):
+            return header, tasks, samples
+        fields = line.split(maxsplit=2)
+        if fields[0] == "TASK" and len(fields) == 3:
+            tasks[int(fields[1])] = fields[2]
+        elif fields[0] == "S":
+            pc, task, count = line.split()[1:4]
+            samples.append((int(pc, 16), int(task), int(count)))
+    raise ValueError("no complete PROF BEGIN ... PROF END block found")
+
+
+def symbolize(pc, symbols, starts):
+    """Returns the name of the function containing pc."""
+    i = bisect.bisect_right(starts, pc & ~1) - 1
+    if i < 0:
+        return f"?? 0x{pc:08x}"
+    start, size, name = symbols[i]
+    if size and pc >= start + size:
+        return f"?? 0x{pc:08x}"
+    return name
+
+
+def print_table(title, counts, total, top):
+    print(f"\n{title}")
+    print(f"  {'Samples':>8} {'Share':>7}  Function")
+    for name, count in counts.most_common(top):
+        print(f"  {count:>8} {100.0 * count / total:>6.1f}%  {name}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="terminal log with the PROF DUMP output ('-' for stdin)")
+    parser.add_argument("elf", help="firmware ELF (RT.elf of the build that was profiled)")
+    parser.add_argument("--top", type=int, default=20, help="functions listed per table")
+    parser.add_argument("--nm", default="arm-none-eabi-nm")
+    args = parser.parse_args()
+
+    source = sys.stdin if args.capture == "-" else open(args.capture, encoding="utf-8", errors="replace")
+    with source:
+        header, tasks, samples = parse(source)
+    symbols = load_symbols(args.elf, args.nm)
+    starts = [s[0] for s in symbols]
+
+    overall = collections.Counter()
+    per_task = collections.defaultdict(collections.Counter)
+    for pc, task, count in samples:
+        name = symbolize(pc, symbols, starts)
+        overall[name] += count
+        per_task[task][name] += count
+
+    total = sum(overall.values())
+    if total == 0:
+        print("No samples")
+        return 1
+    print(f"Profile: {header}")
+    print_table("All tasks", overall, total, args.top)
+    for task in sorted(per_task):
+        task_total = sum(per_task[task].values())
+        label = tasks.get(task, "(scheduler / idle)") if task >= 0 else "(scheduler / idle)"
+        print_table(f"Task {task} {label}: {task_total} samples", per_task[task], task_total, args.top)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,355 @@
+#!/usr/bin/env python3
+"""Client of the binary terminal protocol (app/terminal/rpc.h).
+
+A frame is COBS(opcode, request ID, payload, CRC-16/CCITT-FALSE) followed by a
+zero byte. The first zero byte switches the terminal from text to frames; it
+returns to text after 50 ms without input. Requests are pipelined: up to
+`window` requests are in flight and responses are matched by request ID.
+
+    tools/rpc_client.py /dev/ttyUSB0 stats
+    tools/rpc_client.py /dev/ttyUSB0 get 1
+    tools/rpc_client.py /dev/ttyUSB0 set 1 INT 42
+    tools/rpc_client.py /dev/ttyUSB0 bench --count 1000
+    tools/rpc_client.py /dev/ttyUSB0 stream --hz 50 --tasks 0,1 --metrics uart_rx_bytes_total
+
+As a library, RpcClient works on any object with read(n) and write(data)
+methods, for example a pyserial port.
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+OP_PING = 0x01
+OP_LOGIN = 0x02
+OP_SCHED_GET = 0x10
+OP_SCHED_SET_ALGO = 0x11
+OP_TASK_PRIORITY = 0x12
+OP_TASK_INTERVAL = 0x13
+OP_TASK_PAUSE = 0x14
+OP_TASK_RESUME = 0x15
+OP_PARAM_GET = 0x20
+OP_PARAM_SET = 0x21
+OP_STATS_SYSTEM = 0x30
+OP_STATS_TASK = 0x31
+OP_STREAM_START = 0x40
+OP_STREAM_STOP = 0x41
+OP_STREAM_RECORD = 0x42
+
+RESPONSE = 0x80
+STATUS = ["OK", "UNKNOWN_OP", "LENGTH", "AUTH", "INVALID", "RANGE"]
+PARAM_TYPES = ["INT", "FLOAT", "STRING"]
+ALGORITHMS = ["PRIORITY", "ROUND_ROBIN", "EARLIEST_DEADLINE_FIRST", "LEAST_EXECUTED", "LONGEST_WAITING", "AUTO"]
+TASK_STATES = ["RUNNING", "PAUSED"]
+
+
+class RpcError(Exception):
+    def __init__(self, op, status):
+        name = STATUS[status] if status < len(STATUS) else str(status)
+        super().__init__(f"opcode 0x{op:02x} failed: {name}")
+        self.status = status
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_index, code = 0, 1
+    for byte in data:
+        if byte:
+            out.append(byte)
+            code += 1
+        if not byte or code == 0xFF:
+            out[code_index] = code
+            code_index, code = len(out), 1
+            out.append(0)
+    out[code_index] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def read_varint(data, pos):
+    value = shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if byte < 0x80:
+            return value, pos
+
+
+class StreamDecoder:
+    """Rebuilds the values of STREAM records (app/terminal/stream.h).
+
+    Values are the low 32 bits of the firmware statistics, deltas are applied
+    modulo 2^32. After a sequence gap, records are skipped until a keyframe.
+    """
+
+    FIELDS = ["runs", "exec_us", "max_us", "max_jitter_us", "misses"]
+
+    def __init__(self):
+        self.expected = None
+        self.synced = False
+        self.lost = 0
+        self.tasks = []
+        self.metric_count = 0
+        self.values = []
+
+    def feed(self, sequence, payload):
+        """Returns the record as a dict, or None while waiting for a keyframe."""
+        if self.expected is not None and sequence != self.expected:
+            self.lost += (sequence - self.expected) & 0xFFFF
+            self.synced = False
+        self.expected = (sequence + 1) & 0xFFFF
+
+        flags, pos = payload[0], 1
+        if flags & 0x01:
+            mask, pos = read_varint(payload, pos)
+            self.tasks = [i for i in range(32) if mask >> i & 1]
+            self.metric_count = payload[pos]
+            pos += 1
+            self.values = [0] * (1 + len(self.tasks) * len(self.FIELDS) + self.metric_count)
+            self.synced = True
+        if not self.synced:
+            return None
+
+        for i in range(len(self.values)):
+            raw, pos = read_varint(payload, pos)
+            delta = (raw >> 1) ^ -(raw & 1)
+            self.values[i] = (self.values[i] + delta) & 0xFFFFFFFF
+
+        n = len(self.FIELDS)
+        tasks = {task: dict(zip(self.FIELDS, self.values[1 + k * n:1 + (k + 1) * n])) for k, task in enumerate(self.tasks)}
+        return {"sequence": sequence, "time_us": self.values[0], "keyframe": bool(flags & 0x01),
+                "tasks": tasks, "metrics": self.values[1 + len(self.tasks) * n:], "lost": self.lost}
+
+
+class RpcClient:
+    """Pipelined client; call() for one request, call_many() for a batch."""
+
+    def __init__(self, port, window=8, timeout=1.0):
+        self.port = port
+        self.window = window
+        self.timeout = timeout
+        self.next_id = 0
+        self.rx = bytearray()
+        self.records = []  # (sequence, payload) of STREAM records received meanwhile
+        self.port.write(b"\x00")  # Switches the terminal to binary frames
+
+    def _send(self, op, payload):
+        request_id = self.next_id
+        self.next_id = (self.next_id + 1) & 0xFFFF
+        frame = struct.pack("<BH", op, request_id) + payload
+        frame += struct.pack("<H", crc16(frame))
+        self.port.write(cobs_encode(frame) + b"\x00")
+        return request_id
+
+    def _receive(self, stream_only=False):
+        """Returns the next valid response frame; text and damaged frames are skipped.
+
+        STREAM records are queued in self.records; with stream_only the call
+        returns after the first one.
+        """
+        deadline = time.monotonic() + self.timeout
+        while True:
+            end = self.rx.find(b"\x00")
+            if end >= 0:
+                chunk = bytes(self.rx[:end])
+                del self.rx[:end + 1]
+                frame = cobs_decode(chunk) if chunk else None
+                if frame and len(frame) >= 6 and frame[0] & RESPONSE and \
+                        crc16(frame[:-2]) == struct.unpack("<H", frame[-2:])[0]:
+                    op, request_id, status = struct.unpack("<BHB", frame[:4])
+                    if op & ~RESPONSE == OP_STREAM_RECORD:
+                        self.records.append((request_id, frame[4:-2]))
+                        if stream_only:
+                            return None
+                        continue
+                    return op & ~RESPONSE, request_id, status, frame[4:-2]
+                continue
+            if time.monotonic() > deadline:
+                raise TimeoutError("no response from the device")
+            self.rx += self.port.read(max(1, getattr(self.port, "in_waiting", 0) or 1))
+
+    def call_many(self, requests):
+        """Sends (op, payload) pairs pipelined, returns the payloads in order."""
+        results = [None] * len(requests)
+        pending = {}
+        sent = 0
+        while sent < len(requests) or pending:
+            while sent < len(requests) and len(pending) < self.window:
+                op, payload = requests[sent]
+                pending[self._send(op, payload)] = sent
+                sent += 1
+            op, request_id, status, payload = self._receive()
+            index = pending.pop(request_id, None)
+            if index is None:
+                continue  # Response to an earlier, abandoned request
+            if status:
+                raise RpcError(op, status)
+            results[index] = payload
+        return results
+
+    def call(self, op, payload=b""):
+        return self.call_many([(op, payload)])[0]
+
+    # Typed operations
+
+    def ping(self, data=b""):
+        return self.call(OP_PING, data)
+
+    def login(self, password):
+        self.call(OP_LOGIN, password.encode())
+
+    def scheduler(self):
+        selected, active, count = struct.unpack("<BBB", self.call(OP_SCHED_GET))
+        return {"algorithm": ALGORITHMS[selected], "active": ALGORITHMS[active], "tasks": count}
+
+    def set_algorithm(self, name):
+        self.call(OP_SCHED_SET_ALGO, bytes([ALGORITHMS.index(name)]))
+
+    def set_priority(self, task, priority):
+        self.call(OP_TASK_PRIORITY, struct.pack("<Bi", task, priority))
+
+    def set_interval(self, task, interval_us):
+        self.call(OP_TASK_INTERVAL, struct.pack("<BI", task, interval_us))
+
+    def pause(self, task):
+        self.call(OP_TASK_PAUSE, bytes([task]))
+
+    def resume(self, task):
+        self.call(OP_TASK_RESUME, bytes([task]))
+
+    def get_param(self, key):
+        payload = self.call(OP_PARAM_GET, struct.pack("<i", key))
+        kind = PARAM_TYPES[payload[0]]
+        if kind == "INT":
+            return kind, struct.unpack("<i", payload[1:5])[0]
+        if kind == "FLOAT":
+            return kind, struct.unpack("<f", payload[1:5])[0]
+        return kind, payload[1:].decode(errors="replace")
+
+    def set_param(self, key, kind, value):
+        if kind == "INT":
+            data = struct.pack("<i", int(value))
+        elif kind == "FLOAT":
+            data = struct.pack("<f", float(value))
+        else:
+            data = str(value).encode()
+        self.call(OP_PARAM_SET, struct.pack("<iB", key, PARAM_TYPES.index(kind)) + data)
+
+    def system_stats(self):
+        uptime, busy, irq, count, algorithm = struct.unpack("<QQQBB", self.call(OP_STATS_SYSTEM))
+        return {"uptime_us": uptime, "busy_us": busy, "irq_us": irq, "tasks": count,
+                "algorithm": ALGORITHMS[algorithm]}
+
+    def task_stats(self, count=None):
+        """Statistics of all tasks, requested in one pipelined batch."""
+        if count is None:
+            count = self.system_stats()["tasks"]
+        rows = []
+        for payload in self.call_many([(OP_STATS_TASK, bytes([i])) for i in range(count)]):
+            fields = struct.unpack("<BiIIIIII", payload[:29])
+            rows.append({"name": payload[29:].decode(errors="replace"), "state": TASK_STATES[fields[0]],
+                         "priority": fields[1], "interval_us": fields[2], "runs": fields[3], "avg_us": fields[4],
+                         "max_us": fields[5], "max_jitter_us": fields[6], "misses": fields[7]})
+        return rows
+
+
+    def stream_start(self, hz, tasks, metrics=()):
+        mask = sum(1 << t for t in tasks)
+        self.records.clear()
+        self.call(OP_STREAM_START, struct.pack("<HI", hz, mask) + ",".join(metrics).encode())
+
+    def stream_stop(self):
+        self.call(OP_STREAM_STOP)
+
+    def stream_records(self):
+        """Yields decoded STREAM records until the caller stops iterating."""
+        decoder = StreamDecoder()
+        while True:
+            while not self.records:
+                self._receive(stream_only=True)
+            record = decoder.feed(*self.records.pop(0))
+            if record:
+                yield record
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", help="serial device")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--password", default="1234")
+    parser.add_argument("--window", type=int, default=8, help="requests in flight (default 8)")
+    sub = parser.add_subparsers(dest="command", required=True)
+    sub.add_parser("stats", help="system and task statistics")
+    get = sub.add_parser("get", help="read a parameter")
+    get.add_argument("key", type=int)
+    put = sub.add_parser("set", help="write a parameter")
+    put.add_argument("key", type=int)
+    put.add_argument("type", choices=PARAM_TYPES)
+    put.add_argument("value")
+    alg = sub.add_parser("alg", help="select the scheduling algorithm")
+    alg.add_argument("name", choices=ALGORITHMS)
+    bench = sub.add_parser("bench", help="measure pipelined operations per second")
+    bench.add_argument("--count", type=int, default=500)
+    stream = sub.add_parser("stream", help="print STREAM records")
+    stream.add_argument("--hz", type=int, default=10)
+    stream.add_argument("--tasks", default="0", help="task indices separated by ','")
+    stream.add_argument("--metrics", default="", help="metric names separated by ','")
+    args = parser.parse_args()
+
+    import serial  # pyserial, only needed on the command line
+    client = RpcClient(serial.Serial(args.port, args.baud, timeout=0.05), window=args.window)
+    client.login(args.password)
+
+    if args.command == "stats":
+        print(client.system_stats())
+        for row in client.task_stats():
+            print(row)
+    elif args.command == "get":
+        print(*client.get_param(args.key))
+    elif args.command == "set":
+        client.set_param(args.key, args.type, args.value)
+    elif args.command == "alg":
+        client.set_algorithm(args.name)
+    elif args.command == "bench":
+        start = time.monotonic()
+        client.call_many([(OP_STATS_TASK, bytes([0]))] * args.count)
+        elapsed = time.monotonic() - start
+        print(f"{args.count} requests in {elapsed:.3f} s: {args.count / elapsed:.0f} ops/s")
+    elif args.command == "stream":
+        client.stream_start(args.hz, [int(t) for t in args.tasks.split(",")], [m for m in args.metrics.split(",") if m])
+        try:
+            for record in client.stream_records():
+                print(record)
+        except KeyboardInterrupt:
+            client.stream_stop()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
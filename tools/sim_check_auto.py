@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+"""Checks that AUTO scheduling holds up against the fixed policies.
+
+Runs sched_sim with every algorithm on a taskset and fails if AUTO has a
+watchdog expiry or a supervisor fault, or does worse than the best
+interval-aware fixed policy (PRIORITY, ROUND_ROBIN, EARLIEST_DEADLINE_FIRST)
+beyond the tolerance left for its exploration windows.
+
+    tools/sim_check_auto.py build-host/sched_sim host/sim/tasksets/example.txt [-d 600]
+"""
+
+import argparse
+import subprocess
+import sys
+
+FIXED = ("PRIORITY", "ROUND_ROBIN", "EARLIEST_DEADLINE_FIRST")
+
+
+def run(sim, taskset, seconds, seed):
+    """Returns {algorithm: (misses, max_jitter, watchdog_expiries, fault)} of a sched_sim run."""
+    output = subprocess.run([sim, "-d", str(seconds), "-s", str(seed), "-a", "all", taskset],
+                            check=True, capture_output=True, text=True).stdout
+    rows = {}
+    summary = False
+    for line in output.splitlines():
+        if line.startswith("===== Summary"):
+            summary = True
+            continue
+        fields = line.split()
+        if not summary or len(fields) < 9 or fields[0] == "Algorithm":
+            continue
+        rows[fields[0]] = (int(fields[2]), int(fields[3]), int(fields[7]), "supervisor fault" in line)
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("sim")
+    parser.add_argument("taskset")
+    parser.add_argument("-d", "--duration", type=int, default=600, help="simulated seconds (default 600)")
+    parser.add_argument("-s", "--seed", type=int, default=1)
+    parser.add_argument("--tolerance", type=float, default=50.0,
+                        help="allowed excess over the best fixed policy in percent (default 50)")
+    args = parser.parse_args()
+
+    rows = run(args.sim, args.taskset, args.duration, args.seed)
+    missing = [name for name in FIXED + ("AUTO",) if name not in rows]
+    if missing:
+        print(f"Missing rows in the sched_sim summary: {', '.join(missing)}")
+        return 1
+
+    misses, max_jitter, expiries, fault = rows["AUTO"]
+    best_misses = min(rows[name][0] for name in FIXED)
+    best_jitter = min(rows[name][1] for name in FIXED)
+    limit = 1.0 + args.tolerance / 100.0
+
+    failures = []
+    if expiries != 0 or fault:
+        failures.append(f"watchdog expiries {expiries}{' (supervisor fault)' if fault else ''}")
+    if misses > best_misses * limit:
+        failures.append(f"misses {misses} > best fixed {best_misses} + {args.tolerance:.0f}%")
+    if max_jitter > best_jitter * limit:
+        failures.append(f"max jitter {max_jitter} us > best fixed {best_jitter} us + {args.tolerance:.0f}%")
+
+    print(f"AUTO: misses {misses} (best fixed {best_misses}), max jitter {max_jitter} us "
+          f"(best fixed {best_jitter} us), watchdog expiries {expiries}")
+    for failure in failures:
+        print(f"FAIL: {failure}")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Converts a TRACE DUMP capture to Chrome trace JSON (opens in ui.perfetto.dev or chrome://tracing).
+
+The input is a terminal log containing the output of TRACE DUMP; lines outside the
+TRACE BEGIN / TRACE END block are ignored.
+
+    tools/trace2perfetto.py capture.txt -o trace.json
+"""
+
+import argparse
+import json
+import sys
+
+TASK_RELEASE, TASK_START, TASK_END, IRQ_ENTER, IRQ_EXIT, MARKER, ALGO_SWITCH = range(1, 8)
+
+# RP2040 interrupt numbers
+IRQ_NAMES = {
+    0: "TIMER_IRQ_0", 1: "TIMER_IRQ_1", 2: "TIMER_IRQ_2", 3: "TIMER_IRQ_3",
+    4: "PWM_IRQ_WRAP", 5: "USBCTRL_IRQ", 6: "XIP_IRQ", 7: "PIO0_IRQ_0", 8: "PIO0_IRQ_1",
+    9: "PIO1_IRQ_0", 10: "PIO1_IRQ_1", 11: "DMA_IRQ_0", 12: "DMA_IRQ_1", 13: "IO_IRQ_BANK0",
+    14: "IO_IRQ_QSPI", 15: "SIO_IRQ_PROC0", 16: "SIO_IRQ_PROC1", 17: "CLOCKS_IRQ", 18: "SPI0_IRQ",
+    19: "SPI1_IRQ", 20: "UART0_IRQ", 21: "UART1_IRQ", 22: "ADC_IRQ_FIFO", 23: "I2C0_IRQ",
+    24: "I2C1_IRQ", 25: "RTC_IRQ",
+}
+
+SCHEDULER_TID = 0
+IRQ_TID_BASE = 1000
+MARKER_TID = 2000
+
+
+def parse(lines):
+    """Returns (tasks, algorithms, records) from the TRACE BEGIN/END block."""
+    tasks, algorithms, records = {}, {}, []
+    inside = False
+    for line in lines:
+        line = line.strip()
+        if "TRACE BEGIN" in line:
+            tasks, algorithms, records = {}, {}, []
+            inside = True
+            continue
+        if not inside:
+            continue
+        if line.startswith("TRACE END"):
+            return tasks, algorithms, records
+        fields = line.split(maxsplit=2)
+        if fields[0] == "TASK" and len(fields) == 3:
+            tasks[int(fields[1])] = fields[2]
+        elif fields[0] == "ALGO" and len(fields) == 3:
+            algorithms[int(fields[1])] = fields[2]
+        elif fields[0] == "R" and len(fields) >= 2:
+            data = "".join(fields[1:])
+            for i in range(0, len(data) - 15, 16):
+                rec = data[i:i + 16]
+                records.append((int(rec[0:8], 16), int(rec[8:10], 16), int(rec[10:12], 16), int(rec[12:16], 16)))
+    raise ValueError("no complete TRACE BEGIN ... TRACE END block found")
+
+
+def convert(tasks, algorithms, records):
+    """Builds the Chrome trace event list."""
+    events = [{"ph": "M", "name": "process_name", "pid": 1, "args": {"name": "Skeleton"}},
+              {"ph": "M", "name": "thread_name", "pid": 1, "tid": SCHEDULER_TID, "args": {"name": "Scheduler"}},
+              {"ph": "M", "name": "thread_name", "pid": 1, "tid": MARKER_TID, "args": {"name": "Markers"}}]
+    for index, name in tasks.items():
+        events.append({"ph": "M", "name": "thread_name", "pid": 1, "tid": index + 1, "args": {"name": f"{index} {name}"}})
+        events.append({"ph": "M", "name": "thread_sort_index", "pid": 1, "tid": index + 1, "args": {"sort_index": index + 1}})
+
+    irqs_seen = set()
+    open_slices = set()
+    last_raw, now = None, 0
+    for raw, kind, ident, arg in records:
+        # Unwrap the 32-bit microsecond timer, records are close in time
+        if last_raw is None:
+            now = raw
+        else:
+            delta = (raw - last_raw) & 0xFFFFFFFF
+            if delta >= 0x80000000:
+                delta -= 0x100000000
+            now += delta
+        last_raw = raw
+
+        task_name = tasks.get(ident, f"task {ident}")
+        if kind == TASK_RELEASE:
+            events.append({"ph": "i", "s": "t", "name": "release", "pid": 1, "tid": ident + 1, "ts": now})
+        elif kind == TASK_START:
+            open_slices.add(ident + 1)
+            events.append({"ph": "B", "name": task_name, "pid": 1, "tid": ident + 1, "ts": now,
+                           "args": {"algorithm": algorithms.get(arg, str(arg))}})
+        elif kind == TASK_END:
+            if ident + 1 in open_slices:
+                open_slices.discard(ident + 1)
+                events.append({"ph": "E", "pid": 1, "tid": ident + 1, "ts": now})
+        elif kind in (IRQ_ENTER, IRQ_EXIT):
+            tid = IRQ_TID_BASE + ident
+            if ident not in irqs_seen:
+                irqs_seen.add(ident)
+                events.append({"ph": "M", "name": "thread_name", "pid": 1, "tid": tid,
+                               "args": {"name": IRQ_NAMES.get(ident, f"IRQ {ident}")}})
+            if kind == IRQ_ENTER:
+                open_slices.add(tid)
+                events.append({"ph": "B", "name": IRQ_NAMES.get(ident, f"IRQ {ident}"), "pid": 1, "tid": tid, "ts": now})
+            elif tid in open_slices:
+                open_slices.discard(tid)
+                events.append({"ph": "E", "pid": 1, "tid": tid, "ts": now})
+        elif kind == MARKER:
+            events.append({"ph": "i", "s": "t", "name": f"marker {ident}", "pid": 1, "tid": MARKER_TID, "ts": now,
+                           "args": {"arg": arg}})
+        elif kind == ALGO_SWITCH:
+            events.append({"ph": "i", "s": "p", "name": f"algorithm {algorithms.get(ident, ident)}", "pid": 1,
+                           "tid": SCHEDULER_TID, "ts": now})
+    return events
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="terminal log with the TRACE DUMP output ('-' for stdin)")
+    parser.add_argument("-o", "--output", default="trace.json")
+    args = parser.parse_args()
+
+    source = sys.stdin if args.capture == "-" else open(args.capture, encoding="utf-8", errors="replace")
+    with source:
+        tasks, algorithms, records = parse(source)
+
+    events = convert(tasks, algorithms, records)
+    with open(args.output, "w", encoding="utf-8") as f:
+        json.dump({"traceEvents": events, "displayTimeUnit": "ms"}, f)
+    print(f"{len(records)} records, {len(events)} events written to {args.output}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())